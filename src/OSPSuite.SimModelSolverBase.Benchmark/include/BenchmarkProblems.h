@@ -0,0 +1,146 @@
+#ifndef _BenchmarkProblems_H_
+#define _BenchmarkProblems_H_
+
+#include <vector>
+#include <string>
+#include "SolverCallerInterface/SolverCaller.h"
+#include "SimModelSolverBase/SimModelSolverStaticBase.h"
+
+//-------------------------------------------------------------------------
+//Reference solver callers with standard stiff test problems.
+//
+//Sensitivity RHS is computed as J * s_i + df/dp_i, where df/dp_i is
+//approximated by forward differences. Either ODESensitivityRhsFunction
+//(one parameter per call) or ODESensitivityRhsFunctionAll is offered,
+//depending on SetUseSensitivityRhsAll.
+//-------------------------------------------------------------------------
+
+class BenchmarkProblem : public ISolverCaller
+{
+	protected:
+		int _problemSize;
+		int _numberOfSensitivityParameters;
+		bool _useSensitivityRhsAll;
+		long _numberOfRhsCalls;
+
+		std::vector < double > _defaultParameters;
+		std::vector < double > _currentParameters;
+		std::vector < double > _jacobianData;
+		std::vector < double * > _jacobianRows;
+		std::vector < double > _scratchP;
+		std::vector < double > _scratchF;
+
+		//RHS and Jacobian (Jacobian[i][j] = df_i/dy_j) of the problem
+		virtual void Rhs (double t, const double * y, const double * p, double * ydot) = 0;
+		virtual void Jacobian (double t, const double * y, const double * p, double ** jacobian) = 0;
+
+		//all parameters of the problem: sensitivity parameters from p (if passed), default values for the rest
+		const double * Parameters (const double * p);
+
+		//Jv = J * v for the Jacobian stored in _jacobianRows
+		void MultiplyJacobian (const double * v, double * Jv);
+
+		//df/dp_iS at (t, y) by forward differences, added to ySdot
+		void AddParameterDerivative (double t, const double * y, const double * ydot, int iS, double * ySdot);
+
+	public:
+		BenchmarkProblem (int problemSize, int numberOfSensitivityParameters, const std::vector < double > & defaultParameters);
+		virtual ~BenchmarkProblem ();
+
+		virtual std::string GetName () = 0;
+		virtual std::vector < double > GetInitialValues () = 0;
+		virtual double GetEndTime () = 0;
+
+		int GetProblemSize ();
+		int GetNumberOfSensitivityParameters ();
+		std::vector < double > GetSensitivityParametersValues ();
+
+		void SetUseSensitivityRhsAll (bool useSensitivityRhsAll);
+		long GetNumberOfRhsCalls ();
+		void ResetNumberOfRhsCalls ();
+
+		//ISolverCaller
+		virtual Rhs_Return_Value ODERhsFunction (double t, const double * y, const double * p, double * ydot, void * f_data);
+		virtual Jacobian_Return_Value ODEJacFunction (double t, const double * y, const double * p, const double * fy, double * * Jacobian, void * Jac_data);
+		virtual Rhs_Return_Value DDERhsFunction (double t, const double * y, const double * * yd, double * ydot, void * f_data);
+		virtual void DDEDelayFunction (double t, const double * y, double * delays, void * delays_data);
+		virtual Sensitivity_Rhs_Return_Value ODESensitivityRhsFunction (double t, const double * y, double * ydot,
+			                                                            int iS, const double * yS, double * ySdot, void * f_data);
+		virtual Sensitivity_Rhs_Return_Value ODESensitivityRhsFunctionAll (double t, const double * y, double * ydot,
+			                                                               const double * yS, double * ySdot, void * f_data);
+		virtual bool IsSet_ODERhsFunction ();
+		virtual bool IsSet_ODEJacFunction ();
+		virtual bool IsSet_ODESensitivityRhsFunction ();
+		virtual bool IsSet_ODESensitivityRhsFunctionAll ();
+		virtual bool IsSet_DDERhsFunction ();
+		virtual bool UseBandLinearSolver ();
+		virtual int GetLowerHalfBandWidth ();
+		virtual int GetUpperHalfBandWidth ();
+};
+
+//Robertson chemical kinetics (3 states; parameters k1, k2, k3)
+//(final: used with the statically dispatched solver base)
+class RobertsonProblem final : public BenchmarkProblem
+{
+	protected:
+		virtual void Rhs (double t, const double * y, const double * p, double * ydot);
+		virtual void Jacobian (double t, const double * y, const double * p, double ** jacobian);
+
+	public:
+		RobertsonProblem (int numberOfSensitivityParameters);
+		virtual std::string GetName ();
+		virtual std::vector < double > GetInitialValues ();
+		virtual double GetEndTime ();
+};
+
+//capabilities of the Robertson problem without sensitivity parameters (statically dispatched solvers)
+template <> struct SolverCallerTraits < RobertsonProblem >
+{
+	static constexpr bool HasODEJacFunction = true;
+	static constexpr bool HasODESparseJacFunction = false;
+	static constexpr bool HasODESensitivityRhsFunction = false;
+	static constexpr bool HasODESensitivityRhsFunctionAll = false;
+	static constexpr bool HasODERootFunction = false;
+	static constexpr bool UseBandLinearSolver = false;
+};
+
+//HIRES photomorphogenesis problem (8 states; parameters 1.71, 0.43, 280)
+class HiresProblem : public BenchmarkProblem
+{
+	protected:
+		virtual void Rhs (double t, const double * y, const double * p, double * ydot);
+		virtual void Jacobian (double t, const double * y, const double * p, double ** jacobian);
+
+	public:
+		HiresProblem (int numberOfSensitivityParameters);
+		virtual std::string GetName ();
+		virtual std::vector < double > GetInitialValues ();
+		virtual double GetEndTime ();
+};
+
+//-------------------------------------------------------------------------
+//PBPK-like chain of compartments with forward flows of very different
+//speed, back flows and saturable (Michaelis-Menten) elimination.
+//Tridiagonal Jacobian (band solver with lower/upper half band width 1).
+//Sensitivity parameter j scales the flows of all compartments i with i mod NS = j
+//-------------------------------------------------------------------------
+class CompartmentChainProblem : public BenchmarkProblem
+{
+	protected:
+		double FlowRate (int i, const double * p);
+
+		virtual void Rhs (double t, const double * y, const double * p, double * ydot);
+		virtual void Jacobian (double t, const double * y, const double * p, double ** jacobian);
+
+	public:
+		CompartmentChainProblem (int problemSize, int numberOfSensitivityParameters);
+		virtual std::string GetName ();
+		virtual std::vector < double > GetInitialValues ();
+		virtual double GetEndTime ();
+
+		virtual bool UseBandLinearSolver ();
+		virtual int GetLowerHalfBandWidth ();
+		virtual int GetUpperHalfBandWidth ();
+};
+
+#endif //_BenchmarkProblems_H_
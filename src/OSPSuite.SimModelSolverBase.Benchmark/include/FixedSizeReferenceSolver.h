@@ -0,0 +1,257 @@
+#ifndef _FixedSizeReferenceSolver_H_
+#define _FixedSizeReferenceSolver_H_
+
+#include <cmath>
+#include <cfloat>
+#include <vector>
+#include <string>
+#include "SimModelSolverBase/SimModelSolverFixedSizeBase.h"
+#include "ReferenceSolver.h"
+
+//-------------------------------------------------------------------------
+//Reference solver (linearly implicit Euler method with FIXED step size
+//hMax, see ReferenceSolver) for problems of compile-time size N without
+//sensitivities, built on SimModelSolverFixedSizeBase.
+//
+//Used to measure the fixed size path against ReferenceSolver: all work
+//storage is inline, RHS and Jacobian calls are statically dispatched and
+//ReInit(t0, const double *) + PerformSolverStep do not allocate.
+//Return values are those of ReferenceSolver.
+//-------------------------------------------------------------------------
+
+template < class TCaller, int N >
+class FixedSizeReferenceSolver : public SimModelSolverFixedSizeBase < TCaller, N, 0 >
+{
+	typedef SimModelSolverFixedSizeBase < TCaller, N, 0 > BaseType;
+	typedef typename BaseType::StateVector StateVector;
+
+	protected:
+		double _t;
+		StateVector _y;
+		StateVector _ydot;
+
+		//iteration matrix I - h*J and its LU factors (rows are swapped by swapping row pointers)
+		StateVector _matrix[N];
+		double * _jacobianRows[N];
+		int _pivots[N];
+
+		int Step (double h)
+		{
+			int i, j, k;
+
+			if (this->CallODERhsFunction(_t, _y.Values, NULL, _ydot.Values, NULL) != RHS_OK)
+				return ReferenceSolver::REF_RHS_FAILURE;
+
+			for (i = 0; i < N; i++)
+			{
+				_jacobianRows[i] = _matrix[i].Values;
+				for (j = 0; j < N; j++)
+					_jacobianRows[i][j] = 0.0;
+			}
+
+			if (this->CallODEJacFunction(_t, _y.Values, NULL, _ydot.Values, _jacobianRows, NULL) != JACOBIAN_OK)
+				return ReferenceSolver::REF_JACOBIAN_FAILURE;
+
+			this->_statistics.NumberOfLinearSolverSetups++;
+
+			//M = I - h * J, dense LU with partial pivoting
+			for (i = 0; i < N; i++)
+			{
+				for (j = 0; j < N; j++)
+					_jacobianRows[i][j] *= -h;
+				_jacobianRows[i][i] += 1.0;
+			}
+
+			for (k = 0; k < N; k++)
+			{
+				int pivotRow = k;
+				for (i = k + 1; i < N; i++)
+					if (fabs(_jacobianRows[i][k]) > fabs(_jacobianRows[pivotRow][k]))
+						pivotRow = i;
+
+				if (_jacobianRows[pivotRow][k] == 0.0)
+					return ReferenceSolver::REF_SINGULAR_MATRIX;
+
+				_pivots[k] = pivotRow;
+				if (pivotRow != k)
+				{
+					double * row = _jacobianRows[k];
+					_jacobianRows[k] = _jacobianRows[pivotRow];
+					_jacobianRows[pivotRow] = row;
+				}
+
+				for (i = k + 1; i < N; i++)
+				{
+					double l = _jacobianRows[i][k] / _jacobianRows[k][k];
+					_jacobianRows[i][k] = l;
+					for (j = k + 1; j < N; j++)
+						_jacobianRows[i][j] -= l * _jacobianRows[k][j];
+				}
+			}
+
+			//M * delta = h * f; rows of M were permuted, so b is permuted the same way
+			double * b = _ydot.Values;
+			BaseType::Scale(h, b);
+
+			for (i = 0; i < N; i++)
+			{
+				if (_pivots[i] != i)
+				{
+					double tmp = b[i];
+					b[i] = b[_pivots[i]];
+					b[_pivots[i]] = tmp;
+				}
+			}
+
+			for (i = 0; i < N; i++)
+				for (j = 0; j < i; j++)
+					b[i] -= _jacobianRows[i][j] * b[j];
+
+			for (i = N - 1; i >= 0; i--)
+			{
+				for (j = i + 1; j < N; j++)
+					b[i] -= _jacobianRows[i][j] * b[j];
+				b[i] /= _jacobianRows[i][i];
+			}
+
+			BaseType::Axpy(1.0, b, _y.Values);
+
+			_t += h;
+			this->ReportInternalStep(_t, h, 1);
+
+			return ReferenceSolver::REF_SUCCESS;
+		}
+
+	public:
+		//ReInit without heap allocation
+		using BaseType::ReInit;
+
+		FixedSizeReferenceSolver (TCaller * pSolverCaller)
+			: BaseType(pSolverCaller)
+		{
+			_t = 0.0;
+		}
+
+		virtual std::vector < OptionInfo > GetSolverOptionsInfo ()
+		{
+			//only the options handled by the base class
+			return this->GetBaseSolverOptionsInfo();
+		}
+
+		virtual void SetOption (const std::string & name, double value)
+		{
+			const char * ERROR_SOURCE = "FixedSizeReferenceSolver::SetOption";
+
+			if (this->SetBaseSolverOption(name, value))
+				return;
+
+			throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Unknown option: " + name);
+		}
+
+		virtual void Init ()
+		{
+			const char * ERROR_SOURCE = "FixedSizeReferenceSolver::Init";
+
+			BaseType::Init();
+
+			if (this->_hMax <= 0.0)
+				throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Max. step size (= fixed step size) must be > 0");
+
+			_t = this->_initialTime;
+			BaseType::Copy(this->_fixedInitialValues.Values, _y.Values);
+
+			this->_initialized = true;
+		}
+
+		virtual int ReInit (double t0, const std::vector < double > & y0)
+		{
+			int retVal = BaseType::ReInit(t0, y0);
+			if (retVal != 0)
+				return retVal;
+
+			_t = t0;
+			BaseType::Copy(this->_fixedInitialValues.Values, _y.Values);
+
+			return ReferenceSolver::REF_SUCCESS;
+		}
+
+		virtual void Terminate ()
+		{
+			this->_initialized = false;
+		}
+
+		virtual int PerformSolverStep (double tout, double * y, double **, double & tret)
+		{
+			const char * ERROR_SOURCE = "FixedSizeReferenceSolver::PerformSolverStep";
+
+			if (!this->_initialized)
+				throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Solver was not initialized");
+
+			this->StartSolverStepStatistics();
+
+			int retVal = ReferenceSolver::REF_SUCCESS;
+			double roundoff = 100.0 * DBL_EPSILON * (fabs(tout) > 1.0 ? fabs(tout) : 1.0);
+			long numberOfSteps = 0;
+
+			while (_t < tout - roundoff)
+			{
+				if (numberOfSteps >= this->_mxStep)
+				{
+					retVal = ReferenceSolver::REF_TOO_MUCH_WORK;
+					break;
+				}
+
+				double h = tout - _t < this->_hMax ? tout - _t : this->_hMax;
+
+				retVal = Step(h);
+				if (retVal != ReferenceSolver::REF_SUCCESS)
+					break;
+
+				numberOfSteps++;
+			}
+
+			if ((retVal == ReferenceSolver::REF_SUCCESS) && (_t >= tout - roundoff))
+				_t = tout;
+
+			BaseType::Copy(_y.Values, y);
+			tret = _t;
+
+			return retVal;
+		}
+
+		virtual std::string GetSolverErrMsg (int solverRetVal)
+		{
+			switch (solverRetVal)
+			{
+				case ReferenceSolver::REF_SUCCESS:
+					return "Success";
+				case ReferenceSolver::REF_TOO_MUCH_WORK:
+					return "Max. number of internal steps reached";
+				case ReferenceSolver::REF_RHS_FAILURE:
+					return "RHS function failed";
+				case ReferenceSolver::REF_JACOBIAN_FAILURE:
+					return "Jacobian function failed";
+				case ReferenceSolver::REF_SINGULAR_MATRIX:
+					return "Iteration matrix is singular";
+				default:
+					return "Unknown error";
+			}
+		}
+
+		virtual SimModelSolverErrorData::errNumber GetErrorNumberFromSolverReturnValue (int solverRetVal)
+		{
+			switch (solverRetVal)
+			{
+				case ReferenceSolver::REF_SUCCESS:
+					return SimModelSolverErrorData::err_OK;
+				case ReferenceSolver::REF_TOO_MUCH_WORK:
+					return SimModelSolverErrorData::err_TOO_MUCH_WORK;
+				case ReferenceSolver::REF_SINGULAR_MATRIX:
+					return SimModelSolverErrorData::err_CONV_FAILURE;
+				default:
+					return SimModelSolverErrorData::err_FAILURE;
+			}
+		}
+};
+
+#endif //_FixedSizeReferenceSolver_H_
@@ -0,0 +1,76 @@
+#ifndef _ReferenceSolver_H_
+#define _ReferenceSolver_H_
+
+#include <vector>
+#include <string>
+#include "SimModelSolverBase/SimModelSolverBase.h"
+
+//-------------------------------------------------------------------------
+//Trivial reference solver used to measure the overhead of the solver
+//interface: linearly implicit Euler method with FIXED step size hMax
+//(L-stable, first order, no error control).
+//
+//Sensitivities are integrated with the same method and iteration matrix.
+//Linear systems are solved by dense LU (partial pivoting) or, if the
+//solver caller requests a band solver, by band LU without pivoting
+//(O(n * ml * mu) memory and work; LU without pivoting keeps the factors
+//within the band).
+//-------------------------------------------------------------------------
+
+class ReferenceSolver : public SimModelSolverBase
+{
+	public:
+		enum ReturnValue
+		{
+			REF_SUCCESS = 0,
+			REF_TOO_MUCH_WORK = 1,
+			REF_RHS_FAILURE = -1,
+			REF_JACOBIAN_FAILURE = -2,
+			REF_SINGULAR_MATRIX = -3,
+			REF_SENSITIVITY_RHS_FAILURE = -4
+		};
+
+	protected:
+		double _t;
+		std::vector < double > _y;
+		std::vector < double > _ydot;
+		std::vector < double > _delta;
+
+		//sensitivities: column-major n x NS block
+		std::vector < double > _yS;
+		std::vector < double > _ySdot;
+
+		//iteration matrix I - h*J (dense row-major or band rows of length ml+mu+1) and its LU factors
+		bool _useBand;
+		int _ml, _mu;
+		std::vector < double > _matrix;
+		std::vector < double * > _jacobianRows;
+		std::vector < int > _pivots;
+
+		//checkSteadyState: stop (without taking the step) if the steady state criterion holds at the current point
+		int Step (double h, bool checkSteadyState = false);
+		int FactorizeIterationMatrix (double h);
+		void SolveLinearSystem (double * b);
+
+		//state snapshot: current time, y and yS (the method has no further history)
+		virtual void SaveSolverState (SimModelSolverState & state);
+		virtual void RestoreSolverState (const SimModelSolverState & state, size_t & position);
+
+	public:
+		ReferenceSolver (ISolverCaller * pSolverCaller, int problemSize, int numberOfSensitivityParameters);
+
+		virtual std::vector < OptionInfo > GetSolverOptionsInfo ();
+		virtual void Init ();
+		virtual int PerformSolverStep (double tout, double * y, double ** yS, double & tret);
+		virtual bool SupportsInternalSteps ();
+		virtual bool SupportsStateSnapshots ();
+		virtual int PerformInternalStep (double tstop, double * y, double ** yS, double & tret);
+		virtual int ReInit (double t0, const std::vector < double > & y0);
+		virtual void ResetForReuse ();
+		virtual void Terminate ();
+		virtual std::string GetSolverErrMsg (int solverRetVal);
+		virtual void SetOption (const std::string & name, double value);
+		virtual SimModelSolverErrorData::errNumber GetErrorNumberFromSolverReturnValue (int solverRetVal);
+};
+
+#endif //_ReferenceSolver_H_
@@ -0,0 +1,422 @@
+#include "BenchmarkProblems.h"
+#include <cmath>
+#include <cfloat>
+#include <sstream>
+
+//---- BenchmarkProblem ---------------------------------------------------
+
+BenchmarkProblem::BenchmarkProblem (int problemSize, int numberOfSensitivityParameters, const std::vector < double > & defaultParameters)
+{
+	_problemSize = problemSize;
+	_numberOfSensitivityParameters = numberOfSensitivityParameters;
+	_useSensitivityRhsAll = false;
+	_numberOfRhsCalls = 0;
+	_defaultParameters = defaultParameters;
+
+	_jacobianData.resize((size_t)problemSize * problemSize);
+	_jacobianRows.resize(problemSize);
+	for (int i = 0; i < problemSize; i++)
+		_jacobianRows[i] = &_jacobianData[(size_t)i * problemSize];
+
+	_currentParameters = defaultParameters;
+	_scratchP.resize(defaultParameters.size());
+	_scratchF.resize(problemSize);
+}
+
+BenchmarkProblem::~BenchmarkProblem ()
+{
+}
+
+const double * BenchmarkProblem::Parameters (const double * p)
+{
+	if (!p || (_numberOfSensitivityParameters == 0))
+		return &_defaultParameters[0];
+
+	//p contains only the (first NS) sensitivity parameters
+	for (int i = 0; i < _numberOfSensitivityParameters; i++)
+		_currentParameters[i] = p[i];
+
+	return &_currentParameters[0];
+}
+
+void BenchmarkProblem::AddParameterDerivative (double t, const double * y, const double * ydot, int iS, double * ySdot)
+{
+	_scratchP = _defaultParameters;
+
+	double delta = sqrt(DBL_EPSILON) * (fabs(_scratchP[iS]) > 1e-8 ? fabs(_scratchP[iS]) : 1e-8);
+	_scratchP[iS] += delta;
+
+	Rhs(t, y, &_scratchP[0], &_scratchF[0]);
+
+	for (int i = 0; i < _problemSize; i++)
+		ySdot[i] += (_scratchF[i] - ydot[i]) / delta;
+}
+
+void BenchmarkProblem::MultiplyJacobian (const double * v, double * Jv)
+{
+	//only the band of the Jacobian is nonzero
+	int ml = GetLowerHalfBandWidth(), mu = GetUpperHalfBandWidth();
+
+	for (int i = 0; i < _problemSize; i++)
+	{
+		int jmin = i - ml > 0 ? i - ml : 0;
+		int jmax = i + mu < _problemSize - 1 ? i + mu : _problemSize - 1;
+
+		double sum = 0.0;
+		for (int j = jmin; j <= jmax; j++)
+			sum += _jacobianRows[i][j] * v[j];
+		Jv[i] = sum;
+	}
+}
+
+int BenchmarkProblem::GetProblemSize ()
+{
+	return _problemSize;
+}
+
+int BenchmarkProblem::GetNumberOfSensitivityParameters ()
+{
+	return _numberOfSensitivityParameters;
+}
+
+std::vector < double > BenchmarkProblem::GetSensitivityParametersValues ()
+{
+	return std::vector < double > (_defaultParameters.begin(), _defaultParameters.begin() + _numberOfSensitivityParameters);
+}
+
+void BenchmarkProblem::SetUseSensitivityRhsAll (bool useSensitivityRhsAll)
+{
+	_useSensitivityRhsAll = useSensitivityRhsAll;
+}
+
+long BenchmarkProblem::GetNumberOfRhsCalls ()
+{
+	return _numberOfRhsCalls;
+}
+
+void BenchmarkProblem::ResetNumberOfRhsCalls ()
+{
+	_numberOfRhsCalls = 0;
+}
+
+Rhs_Return_Value BenchmarkProblem::ODERhsFunction (double t, const double * y, const double * p, double * ydot, void * /*f_data*/)
+{
+	_numberOfRhsCalls++;
+	Rhs(t, y, p, ydot);
+	return RHS_OK;
+}
+
+Jacobian_Return_Value BenchmarkProblem::ODEJacFunction (double t, const double * y, const double * p, const double * /*fy*/, double * * Jacobian, void * /*Jac_data*/)
+{
+	this->Jacobian(t, y, p, Jacobian);
+	return JACOBIAN_OK;
+}
+
+Rhs_Return_Value BenchmarkProblem::DDERhsFunction (double /*t*/, const double * /*y*/, const double * * /*yd*/, double * /*ydot*/, void * /*f_data*/)
+{
+	return RHS_FAILED;
+}
+
+void BenchmarkProblem::DDEDelayFunction (double /*t*/, const double * /*y*/, double * /*delays*/, void * /*delays_data*/)
+{
+}
+
+Sensitivity_Rhs_Return_Value BenchmarkProblem::ODESensitivityRhsFunction (double t, const double * y, double * ydot,
+	                                                                      int iS, const double * yS, double * ySdot, void * /*f_data*/)
+{
+	Jacobian(t, y, &_defaultParameters[0], &_jacobianRows[0]);
+
+	MultiplyJacobian(yS, ySdot);
+
+	AddParameterDerivative(t, y, ydot, iS, ySdot);
+
+	return SENSITIVITY_RHS_OK;
+}
+
+Sensitivity_Rhs_Return_Value BenchmarkProblem::ODESensitivityRhsFunctionAll (double t, const double * y, double * ydot,
+	                                                                         const double * yS, double * ySdot, void * /*f_data*/)
+{
+	//Jacobian is shared by all parameters
+	Jacobian(t, y, &_defaultParameters[0], &_jacobianRows[0]);
+
+	for (int iS = 0; iS < _numberOfSensitivityParameters; iS++)
+	{
+		const double * s = yS + (size_t)iS * _problemSize;
+		double * sdot = ySdot + (size_t)iS * _problemSize;
+
+		MultiplyJacobian(s, sdot);
+
+		AddParameterDerivative(t, y, ydot, iS, sdot);
+	}
+
+	return SENSITIVITY_RHS_OK;
+}
+
+bool BenchmarkProblem::IsSet_ODERhsFunction ()
+{
+	return true;
+}
+
+bool BenchmarkProblem::IsSet_ODEJacFunction ()
+{
+	return true;
+}
+
+bool BenchmarkProblem::IsSet_ODESensitivityRhsFunction ()
+{
+	return _numberOfSensitivityParameters > 0;
+}
+
+bool BenchmarkProblem::IsSet_ODESensitivityRhsFunctionAll ()
+{
+	return (_numberOfSensitivityParameters > 0) && _useSensitivityRhsAll;
+}
+
+bool BenchmarkProblem::IsSet_DDERhsFunction ()
+{
+	return false;
+}
+
+bool BenchmarkProblem::UseBandLinearSolver ()
+{
+	return false;
+}
+
+int BenchmarkProblem::GetLowerHalfBandWidth ()
+{
+	return _problemSize - 1;
+}
+
+int BenchmarkProblem::GetUpperHalfBandWidth ()
+{
+	return _problemSize - 1;
+}
+
+//---- RobertsonProblem ---------------------------------------------------
+
+static std::vector < double > RobertsonParameters ()
+{
+	std::vector < double > p;
+	p.push_back(0.04);
+	p.push_back(3.0e7);
+	p.push_back(1.0e4);
+	return p;
+}
+
+RobertsonProblem::RobertsonProblem (int numberOfSensitivityParameters)
+	: BenchmarkProblem(3, numberOfSensitivityParameters, RobertsonParameters())
+{
+}
+
+std::string RobertsonProblem::GetName ()
+{
+	return "Robertson";
+}
+
+std::vector < double > RobertsonProblem::GetInitialValues ()
+{
+	std::vector < double > y0(3, 0.0);
+	y0[0] = 1.0;
+	return y0;
+}
+
+double RobertsonProblem::GetEndTime ()
+{
+	return 40.0;
+}
+
+void RobertsonProblem::Rhs (double /*t*/, const double * y, const double * p, double * ydot)
+{
+	const double * k = Parameters(p);
+
+	ydot[0] = -k[0] * y[0] + k[2] * y[1] * y[2];
+	ydot[2] = k[1] * y[1] * y[1];
+	ydot[1] = -ydot[0] - ydot[2];
+}
+
+void RobertsonProblem::Jacobian (double /*t*/, const double * y, const double * p, double ** jacobian)
+{
+	const double * k = Parameters(p);
+
+	jacobian[0][0] = -k[0];
+	jacobian[0][1] = k[2] * y[2];
+	jacobian[0][2] = k[2] * y[1];
+
+	jacobian[2][0] = 0.0;
+	jacobian[2][1] = 2.0 * k[1] * y[1];
+	jacobian[2][2] = 0.0;
+
+	for (int j = 0; j < 3; j++)
+		jacobian[1][j] = -jacobian[0][j] - jacobian[2][j];
+}
+
+//---- HiresProblem -------------------------------------------------------
+
+static std::vector < double > HiresParameters ()
+{
+	std::vector < double > p;
+	p.push_back(1.71);
+	p.push_back(0.43);
+	p.push_back(280.0);
+	return p;
+}
+
+HiresProblem::HiresProblem (int numberOfSensitivityParameters)
+	: BenchmarkProblem(8, numberOfSensitivityParameters, HiresParameters())
+{
+}
+
+std::string HiresProblem::GetName ()
+{
+	return "HIRES";
+}
+
+std::vector < double > HiresProblem::GetInitialValues ()
+{
+	std::vector < double > y0(8, 0.0);
+	y0[0] = 1.0;
+	y0[7] = 0.0057;
+	return y0;
+}
+
+double HiresProblem::GetEndTime ()
+{
+	return 321.8122;
+}
+
+void HiresProblem::Rhs (double /*t*/, const double * y, const double * p, double * ydot)
+{
+	const double * k = Parameters(p);
+	double a = k[0], b = k[1], c = k[2];
+
+	ydot[0] = -a * y[0] + b * y[1] + 8.32 * y[2] + 0.0007;
+	ydot[1] = a * y[0] - 8.75 * y[1];
+	ydot[2] = -10.03 * y[2] + b * y[3] + 0.035 * y[4];
+	ydot[3] = 8.32 * y[1] + a * y[2] - 1.12 * y[3];
+	ydot[4] = -1.745 * y[4] + b * y[5] + b * y[6];
+	ydot[5] = -c * y[5] * y[7] + 0.69 * y[3] + a * y[4] - b * y[5] + 0.69 * y[6];
+	ydot[6] = c * y[5] * y[7] - 1.81 * y[6];
+	ydot[7] = -ydot[6];
+}
+
+void HiresProblem::Jacobian (double /*t*/, const double * y, const double * p, double ** jacobian)
+{
+	const double * k = Parameters(p);
+	double a = k[0], b = k[1], c = k[2];
+
+	for (int i = 0; i < 8; i++)
+		for (int j = 0; j < 8; j++)
+			jacobian[i][j] = 0.0;
+
+	jacobian[0][0] = -a;     jacobian[0][1] = b;      jacobian[0][2] = 8.32;
+	jacobian[1][0] = a;      jacobian[1][1] = -8.75;
+	jacobian[2][2] = -10.03; jacobian[2][3] = b;      jacobian[2][4] = 0.035;
+	jacobian[3][1] = 8.32;   jacobian[3][2] = a;      jacobian[3][3] = -1.12;
+	jacobian[4][4] = -1.745; jacobian[4][5] = b;      jacobian[4][6] = b;
+
+	jacobian[5][3] = 0.69;   jacobian[5][4] = a;      jacobian[5][5] = -c * y[7] - b;
+	jacobian[5][6] = 0.69;   jacobian[5][7] = -c * y[5];
+
+	jacobian[6][5] = c * y[7]; jacobian[6][6] = -1.81; jacobian[6][7] = c * y[5];
+
+	jacobian[7][5] = -c * y[7]; jacobian[7][6] = 1.81; jacobian[7][7] = -c * y[5];
+}
+
+//---- CompartmentChainProblem --------------------------------------------
+
+const double CHAIN_BACK_FLOW = 0.1;
+const double CHAIN_VMAX = 2.0;
+const double CHAIN_KM = 0.5;
+
+CompartmentChainProblem::CompartmentChainProblem (int problemSize, int numberOfSensitivityParameters)
+	: BenchmarkProblem(problemSize, numberOfSensitivityParameters,
+	                   std::vector < double > (numberOfSensitivityParameters > 0 ? numberOfSensitivityParameters : 1, 1.0))
+{
+}
+
+std::string CompartmentChainProblem::GetName ()
+{
+	std::ostringstream name;
+	name << "Chain" << _problemSize;
+	return name.str();
+}
+
+std::vector < double > CompartmentChainProblem::GetInitialValues ()
+{
+	std::vector < double > y0(_problemSize, 0.0);
+	y0[0] = 100.0;
+	return y0;
+}
+
+double CompartmentChainProblem::GetEndTime ()
+{
+	return 24.0;
+}
+
+double CompartmentChainProblem::FlowRate (int i, const double * p)
+{
+	//rates from 0.1 to 1000 (stiff)
+	static const double rates[5] = {0.1, 1.0, 10.0, 100.0, 1000.0};
+
+	int numberOfParameters = (int)_defaultParameters.size();
+	return rates[i % 5] * p[i % numberOfParameters];
+}
+
+void CompartmentChainProblem::Rhs (double /*t*/, const double * y, const double * p, double * ydot)
+{
+	const double * k = Parameters(p);
+	int n = _problemSize;
+
+	for (int i = 0; i < n; i++)
+	{
+		double f = -CHAIN_VMAX * y[i] / (CHAIN_KM + y[i]);
+
+		if (i > 0)
+			f += FlowRate(i - 1, k) * y[i - 1] - CHAIN_BACK_FLOW * y[i];
+		if (i < n - 1)
+			f += -FlowRate(i, k) * y[i] + CHAIN_BACK_FLOW * y[i + 1];
+
+		ydot[i] = f;
+	}
+}
+
+void CompartmentChainProblem::Jacobian (double /*t*/, const double * y, const double * p, double ** jacobian)
+{
+	const double * k = Parameters(p);
+	int n = _problemSize;
+
+	for (int i = 0; i < n; i++)
+	{
+		double denominator = CHAIN_KM + y[i];
+		double diagonal = -CHAIN_VMAX * CHAIN_KM / (denominator * denominator);
+
+		//only the band is set; entries outside the band are never changed (initialized with 0)
+		if (i > 0)
+		{
+			jacobian[i][i - 1] = FlowRate(i - 1, k);
+			diagonal -= CHAIN_BACK_FLOW;
+		}
+		if (i < n - 1)
+		{
+			jacobian[i][i + 1] = CHAIN_BACK_FLOW;
+			diagonal -= FlowRate(i, k);
+		}
+
+		jacobian[i][i] = diagonal;
+	}
+}
+
+bool CompartmentChainProblem::UseBandLinearSolver ()
+{
+	return true;
+}
+
+int CompartmentChainProblem::GetLowerHalfBandWidth ()
+{
+	return 1;
+}
+
+int CompartmentChainProblem::GetUpperHalfBandWidth ()
+{
+	return 1;
+}
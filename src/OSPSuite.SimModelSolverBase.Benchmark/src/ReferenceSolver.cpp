@@ -0,0 +1,431 @@
+#include "ReferenceSolver.h"
+#include "SimModelSolverBase/SimModelSolverVectorKernels.h"
+#include <cmath>
+#include <cfloat>
+#include <algorithm>
+
+ReferenceSolver::ReferenceSolver (ISolverCaller * pSolverCaller, int problemSize, int numberOfSensitivityParameters)
+	: SimModelSolverBase(pSolverCaller, problemSize, numberOfSensitivityParameters)
+{
+	_t = 0.0;
+	_useBand = false;
+	_ml = 0;
+	_mu = 0;
+}
+
+std::vector < OptionInfo > ReferenceSolver::GetSolverOptionsInfo ()
+{
+	//only the options handled by the base class
+	return GetBaseSolverOptionsInfo();
+}
+
+void ReferenceSolver::SetOption (const std::string & name, double value)
+{
+	const char * ERROR_SOURCE = "ReferenceSolver::SetOption";
+
+	if (SetBaseSolverOption(name, value))
+		return;
+
+	throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Unknown option: " + name);
+}
+
+void ReferenceSolver::Init ()
+{
+	const char * ERROR_SOURCE = "ReferenceSolver::Init";
+
+	SimModelSolverBase::Init();
+
+	if (_hMax <= 0.0)
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Max. step size (= fixed step size) must be > 0");
+
+	int n = _problemSize, ns = _numberOfSensitivityParameters;
+
+	_useBand = _solverCaller->UseBandLinearSolver();
+	_ml = _useBand ? _solverCaller->GetLowerHalfBandWidth() : n - 1;
+	_mu = _useBand ? _solverCaller->GetUpperHalfBandWidth() : n - 1;
+
+	if ((_ml < 0) || (_mu < 0))
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Invalid half band widths");
+
+	_t = _initialTime;
+	_y = _initialValues;
+	_ydot.resize(n);
+	_delta.resize(n);
+
+	_yS.assign((size_t)n * ns, 0.0);
+	_ySdot.resize((size_t)n * ns);
+
+	//Jacobian is passed as row pointers (interface of ISolverCaller). Band solver: only the band is stored,
+	//row i holds columns i-ml..i+mu, so that _jacobianRows[i][j] addresses entry (i, j) of the band
+	size_t rowLength = _useBand ? (size_t)_ml + _mu + 1 : (size_t)n;
+	_matrix.assign((size_t)n * rowLength, 0.0);
+	_jacobianRows.resize(n);
+	for (int i = 0; i < n; i++)
+		_jacobianRows[i] = _useBand ? &_matrix[0] + ((size_t)i * rowLength + _ml - i) : &_matrix[(size_t)i * n];
+	_pivots.resize(n);
+
+	_initialized = true;
+}
+
+int ReferenceSolver::ReInit (double t0, const std::vector < double > & y0)
+{
+	int retVal = SimModelSolverBase::ReInit(t0, y0);
+	if (retVal != 0)
+		return retVal;
+
+	//sensitivities are continued
+	_t = t0;
+	_y = y0;
+
+	return REF_SUCCESS;
+}
+
+void ReferenceSolver::ResetForReuse ()
+{
+	if (!_initialized)
+	{
+		Init();
+		return;
+	}
+
+	SimModelSolverBase::Init();
+
+	//work memory is kept
+	_t = _initialTime;
+	_y = _initialValues;
+	std::fill(_yS.begin(), _yS.end(), 0.0);
+}
+
+void ReferenceSolver::Terminate ()
+{
+	_y.clear();
+	_ydot.clear();
+	_delta.clear();
+	_yS.clear();
+	_ySdot.clear();
+	_matrix.clear();
+	_jacobianRows.clear();
+	_pivots.clear();
+
+	_initialized = false;
+}
+
+void ReferenceSolver::SaveSolverState (SimModelSolverState & state)
+{
+	state.WriteDouble(_t);
+	state.WriteVector(_y);
+	state.WriteVector(_yS);
+}
+
+void ReferenceSolver::RestoreSolverState (const SimModelSolverState & state, size_t & position)
+{
+	_t = state.ReadDouble(position);
+	state.ReadVector(position, _y);
+	state.ReadVector(position, _yS);
+}
+
+int ReferenceSolver::PerformSolverStep (double tout, double * y, double ** yS, double & tret)
+{
+	const char * ERROR_SOURCE = "ReferenceSolver::PerformSolverStep";
+
+	if (!_initialized)
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Solver was not initialized");
+
+	StartSolverStepStatistics();
+
+	int retVal = REF_SUCCESS;
+	double roundoff = 100.0 * DBL_EPSILON * (fabs(tout) > 1.0 ? fabs(tout) : 1.0);
+	long numberOfSteps = 0;
+
+	while (_t < tout - roundoff)
+	{
+		//solution does not change anymore
+		if (_steadyStateReached)
+		{
+			_t = tout;
+			break;
+		}
+
+		if (numberOfSteps >= _mxStep)
+		{
+			retVal = REF_TOO_MUCH_WORK;
+			break;
+		}
+
+		double h = tout - _t < _hMax ? tout - _t : _hMax;
+
+		retVal = Step(h, _steadyStateDetection);
+		if (retVal != REF_SUCCESS)
+			break;
+
+		numberOfSteps++;
+	}
+
+	if ((retVal == REF_SUCCESS) && (_t >= tout - roundoff))
+		_t = tout;
+
+	int n = _problemSize, ns = _numberOfSensitivityParameters;
+
+	for (int i = 0; i < n; i++)
+	{
+		y[i] = _y[i];
+		for (int j = 0; (yS != NULL) && (j < ns); j++)
+			yS[i][j] = _yS[(size_t)j * n + i];
+	}
+
+	tret = _t;
+
+	return retVal;
+}
+
+bool ReferenceSolver::SupportsInternalSteps ()
+{
+	return true;
+}
+
+bool ReferenceSolver::SupportsStateSnapshots ()
+{
+	return true;
+}
+
+int ReferenceSolver::PerformInternalStep (double tstop, double * y, double ** yS, double & tret)
+{
+	const char * ERROR_SOURCE = "ReferenceSolver::PerformInternalStep";
+
+	if (!_initialized)
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Solver was not initialized");
+
+	int retVal = REF_SUCCESS;
+	double roundoff = 100.0 * DBL_EPSILON * (fabs(tstop) > 1.0 ? fabs(tstop) : 1.0);
+
+	if (_t < tstop - roundoff)
+	{
+		double h = tstop - _t < _hMax ? tstop - _t : _hMax;
+
+		retVal = Step(h);
+		if ((retVal == REF_SUCCESS) && (_t >= tstop - roundoff))
+			_t = tstop;
+	}
+
+	int n = _problemSize, ns = _numberOfSensitivityParameters;
+
+	for (int i = 0; i < n; i++)
+	{
+		y[i] = _y[i];
+		for (int j = 0; (yS != NULL) && (j < ns); j++)
+			yS[i][j] = _yS[(size_t)j * n + i];
+	}
+
+	tret = _t;
+
+	return retVal;
+}
+
+int ReferenceSolver::Step (double h, bool checkSteadyState)
+{
+	int n = _problemSize, ns = _numberOfSensitivityParameters;
+	const double * p = ns > 0 ? &_sensitivityParametersInitialValues[0] : NULL;
+
+	if (CallODERhsFunction(_t, &_y[0], p, &_ydot[0], NULL) != RHS_OK)
+		return REF_RHS_FAILURE;
+
+	//steady state of the states only: check before the Jacobian is evaluated
+	if (checkSteadyState && (!_steadyStateSensitivities || (ns == 0)) &&
+		CheckSteadyState(_t, &_y[0], &_ydot[0], ns > 0 ? &_yS[0] : NULL, NULL, 1, n))
+		return REF_SUCCESS;
+
+	int retVal = FactorizeIterationMatrix(h);
+	if (retVal != REF_SUCCESS)
+		return retVal;
+
+	//sensitivities (must be evaluated at the old y)
+	if (ns > 0)
+	{
+		if (CallODESensitivityRhsFunction(_t, &_y[0], &_ydot[0], &_yS[0], &_ySdot[0], NULL) != SENSITIVITY_RHS_OK)
+			return REF_SENSITIVITY_RHS_FAILURE;
+
+		if (checkSteadyState && _steadyStateSensitivities &&
+			CheckSteadyState(_t, &_y[0], &_ydot[0], &_yS[0], &_ySdot[0], 1, n))
+			return REF_SUCCESS;
+
+		for (int iS = 0; iS < ns; iS++)
+		{
+			double * s = &_yS[(size_t)iS * n];
+			double * sdot = &_ySdot[(size_t)iS * n];
+
+			SimModelSolverVectorKernels::Scale(n, h, sdot, sdot);
+			SolveLinearSystem(sdot);
+			SimModelSolverVectorKernels::Axpy(n, 1.0, sdot, s);
+		}
+	}
+
+	SimModelSolverVectorKernels::Scale(n, h, &_ydot[0], &_delta[0]);
+	SolveLinearSystem(&_delta[0]);
+	SimModelSolverVectorKernels::Axpy(n, 1.0, &_delta[0], &_y[0]);
+
+	_t += h;
+	ReportInternalStep(_t, h, 1);
+
+	return REF_SUCCESS;
+}
+
+int ReferenceSolver::FactorizeIterationMatrix (double h)
+{
+	int n = _problemSize, i, j, k;
+	const double * p = _numberOfSensitivityParameters > 0 ? &_sensitivityParametersInitialValues[0] : NULL;
+
+	//Jacobian into the matrix (callers are allowed to set only the nonzero entries;
+	//band solver: callers must not set entries outside the band, they are not stored)
+	for (i = 0; i < n; i++)
+	{
+		int jmin = i - _ml > 0 ? i - _ml : 0;
+		int jmax = i + _mu < n - 1 ? i + _mu : n - 1;
+
+		for (j = jmin; j <= jmax; j++)
+			_jacobianRows[i][j] = 0.0;
+	}
+
+	//finite difference Jacobian (by the base class) if the caller provides none
+	if (CallODEJacFunction(_t, &_y[0], p, &_ydot[0], &_jacobianRows[0], NULL) != JACOBIAN_OK)
+		return REF_JACOBIAN_FAILURE;
+
+	//M = I - h * J, LU factorization in place
+	for (i = 0; i < n; i++)
+	{
+		int jmin = i - _ml > 0 ? i - _ml : 0;
+		int jmax = i + _mu < n - 1 ? i + _mu : n - 1;
+
+		for (j = jmin; j <= jmax; j++)
+			_jacobianRows[i][j] *= -h;
+		_jacobianRows[i][i] += 1.0;
+	}
+
+	_statistics.NumberOfLinearSolverSetups++;
+
+	if (_useBand)
+	{
+		//band LU without pivoting
+		for (k = 0; k < n; k++)
+		{
+			double pivot = _jacobianRows[k][k];
+			if (pivot == 0.0)
+				return REF_SINGULAR_MATRIX;
+
+			int imax = k + _ml < n - 1 ? k + _ml : n - 1;
+			int jmax = k + _mu < n - 1 ? k + _mu : n - 1;
+
+			for (i = k + 1; i <= imax; i++)
+			{
+				double l = _jacobianRows[i][k] / pivot;
+				_jacobianRows[i][k] = l;
+				for (j = k + 1; j <= jmax; j++)
+					_jacobianRows[i][j] -= l * _jacobianRows[k][j];
+			}
+		}
+
+		return REF_SUCCESS;
+	}
+
+	//dense LU with partial pivoting (rows are swapped by swapping row pointers)
+	for (k = 0; k < n; k++)
+	{
+		int pivotRow = k;
+		for (i = k + 1; i < n; i++)
+			if (fabs(_jacobianRows[i][k]) > fabs(_jacobianRows[pivotRow][k]))
+				pivotRow = i;
+
+		if (_jacobianRows[pivotRow][k] == 0.0)
+			return REF_SINGULAR_MATRIX;
+
+		_pivots[k] = pivotRow;
+		if (pivotRow != k)
+		{
+			double * row = _jacobianRows[k];
+			_jacobianRows[k] = _jacobianRows[pivotRow];
+			_jacobianRows[pivotRow] = row;
+		}
+
+		for (i = k + 1; i < n; i++)
+		{
+			double l = _jacobianRows[i][k] / _jacobianRows[k][k];
+			_jacobianRows[i][k] = l;
+			for (j = k + 1; j < n; j++)
+				_jacobianRows[i][j] -= l * _jacobianRows[k][j];
+		}
+	}
+
+	return REF_SUCCESS;
+}
+
+void ReferenceSolver::SolveLinearSystem (double * b)
+{
+	int n = _problemSize, i, j;
+
+	if (!_useBand)
+	{
+		//apply row permutation
+		for (i = 0; i < n; i++)
+		{
+			if (_pivots[i] != i)
+			{
+				double tmp = b[i];
+				b[i] = b[_pivots[i]];
+				b[_pivots[i]] = tmp;
+			}
+		}
+	}
+
+	for (i = 0; i < n; i++)
+	{
+		int jmin = i - _ml > 0 ? i - _ml : 0;
+		double sum = b[i];
+		for (j = jmin; j < i; j++)
+			sum -= _jacobianRows[i][j] * b[j];
+		b[i] = sum;
+	}
+
+	for (i = n - 1; i >= 0; i--)
+	{
+		int jmax = i + _mu < n - 1 ? i + _mu : n - 1;
+		double sum = b[i];
+		for (j = i + 1; j <= jmax; j++)
+			sum -= _jacobianRows[i][j] * b[j];
+		b[i] = sum / _jacobianRows[i][i];
+	}
+}
+
+std::string ReferenceSolver::GetSolverErrMsg (int solverRetVal)
+{
+	switch (solverRetVal)
+	{
+		case REF_SUCCESS:
+			return "Success";
+		case REF_TOO_MUCH_WORK:
+			return "Max. number of internal steps reached";
+		case REF_RHS_FAILURE:
+			return "RHS function failed";
+		case REF_JACOBIAN_FAILURE:
+			return "Jacobian function failed";
+		case REF_SINGULAR_MATRIX:
+			return "Iteration matrix is singular";
+		case REF_SENSITIVITY_RHS_FAILURE:
+			return "Sensitivity RHS function failed";
+		default:
+			return "Unknown error";
+	}
+}
+
+SimModelSolverErrorData::errNumber ReferenceSolver::GetErrorNumberFromSolverReturnValue (int solverRetVal)
+{
+	switch (solverRetVal)
+	{
+		case REF_SUCCESS:
+			return SimModelSolverErrorData::err_OK;
+		case REF_TOO_MUCH_WORK:
+			return SimModelSolverErrorData::err_TOO_MUCH_WORK;
+		case REF_SINGULAR_MATRIX:
+			return SimModelSolverErrorData::err_CONV_FAILURE;
+		default:
+			return SimModelSolverErrorData::err_FAILURE;
+	}
+}
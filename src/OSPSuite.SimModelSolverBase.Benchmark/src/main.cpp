@@ -0,0 +1,781 @@
+//-------------------------------------------------------------------------
+//Benchmark of the solver interface (ISolverCaller dispatch, ReInit,
+//sensitivity handling) using the reference solver, the auto switching
+//solver and standard stiff test problems, and of the drivers for many
+//runs (ensemble, solver pool, result cache).
+//
+//Usage: OSPSuite.SimModelSolverBase.Benchmark [--quick] [--csv]
+//                                             [--baseline <file> [--tolerance <fraction>]]
+//
+//  --quick      short runs (e.g. for CI)
+//  --csv        print results as CSV (can be used as baseline file)
+//  --baseline   compare throughput with a previously saved CSV output;
+//               exit code is 1 if any case is slower than
+//               baseline * (1 - tolerance) (default tolerance: 0.2)
+//-------------------------------------------------------------------------
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <new>
+#include <atomic>
+#include <map>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include "BenchmarkProblems.h"
+#include "ReferenceSolver.h"
+#include "FixedSizeReferenceSolver.h"
+#include "SimModelSolverBase/SimModelSolverAutoSwitch.h"
+#include "SimModelSolverBase/SimModelSolverStaticBase.h"
+#include "SimModelSolverBase/SimModelSolverEnsemble.h"
+#include "SimModelSolverBase/SimModelSolverPool.h"
+#include "SimModelSolverBase/SimModelSolverResultCache.h"
+
+//---- memory accounting --------------------------------------------------
+
+//atomic: the drivers allocate in their worker threads
+static std::atomic < long long > g_allocatedBytes(0);
+static std::atomic < long long > g_numberOfAllocations(0);
+
+//header keeps the allocation size and preserves max. alignment
+static const size_t ALLOCATION_HEADER_SIZE = 16;
+
+void * operator new (size_t size)
+{
+	char * memory = (char *)malloc(size + ALLOCATION_HEADER_SIZE);
+	if (!memory)
+		throw std::bad_alloc();
+
+	*(size_t *)memory = size;
+	g_allocatedBytes += size;
+	g_numberOfAllocations++;
+
+	return memory + ALLOCATION_HEADER_SIZE;
+}
+
+//GCC inlines the replaced operator delete at delete expressions and then reports free() of a pointer
+//returned by operator new; the pointer is actually the malloc block of the replaced operator new
+#if defined(__GNUC__) && !defined(__clang__) && (__GNUC__ >= 11)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void operator delete (void * pointer) noexcept
+{
+	if (!pointer)
+		return;
+
+	char * memory = (char *)pointer - ALLOCATION_HEADER_SIZE;
+	g_allocatedBytes -= *(size_t *)memory;
+	free(memory);
+}
+
+#if defined(__GNUC__) && !defined(__clang__) && (__GNUC__ >= 11)
+#pragma GCC diagnostic pop
+#endif
+
+void * operator new[] (size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete[] (void * pointer) noexcept
+{
+	operator delete(pointer);
+}
+
+//sized deallocation (called instead of the unsized versions when the compiler knows the size)
+void operator delete (void * pointer, size_t) noexcept
+{
+	operator delete(pointer);
+}
+
+void operator delete[] (void * pointer, size_t) noexcept
+{
+	operator delete(pointer);
+}
+
+#ifdef __cpp_aligned_new
+//over-aligned types: the header (size and start of the malloc block) is placed directly before the aligned pointer
+struct AlignedAllocationHeader
+{
+	size_t Size;
+	void * Memory;
+};
+
+void * operator new (size_t size, std::align_val_t alignment)
+{
+	size_t align = (size_t)alignment > ALLOCATION_HEADER_SIZE ? (size_t)alignment : ALLOCATION_HEADER_SIZE;
+
+	char * memory = (char *)malloc(size + align + ALLOCATION_HEADER_SIZE);
+	if (!memory)
+		throw std::bad_alloc();
+
+	uintptr_t pointer = ((uintptr_t)memory + ALLOCATION_HEADER_SIZE + align - 1) & ~(uintptr_t)(align - 1);
+
+	AlignedAllocationHeader * header = (AlignedAllocationHeader *)pointer - 1;
+	header->Size = size;
+	header->Memory = memory;
+	g_allocatedBytes += size;
+	g_numberOfAllocations++;
+
+	return (void *)pointer;
+}
+
+void operator delete (void * pointer, std::align_val_t) noexcept
+{
+	if (!pointer)
+		return;
+
+	AlignedAllocationHeader * header = (AlignedAllocationHeader *)pointer - 1;
+	g_allocatedBytes -= header->Size;
+	free(header->Memory);
+}
+
+void * operator new[] (size_t size, std::align_val_t alignment)
+{
+	return operator new(size, alignment);
+}
+
+void operator delete[] (void * pointer, std::align_val_t alignment) noexcept
+{
+	operator delete(pointer, alignment);
+}
+
+void operator delete (void * pointer, size_t, std::align_val_t alignment) noexcept
+{
+	operator delete(pointer, alignment);
+}
+
+void operator delete[] (void * pointer, size_t, std::align_val_t alignment) noexcept
+{
+	operator delete(pointer, alignment);
+}
+#endif
+
+//---- helpers ------------------------------------------------------------
+
+static double CurrentTimeInSeconds ()
+{
+	return std::chrono::duration < double > (std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct BenchmarkSettings
+{
+	bool Quick;
+	bool Csv;
+	std::string BaselineFile;
+	double Tolerance;
+
+	//number of (fixed) steps per run and min. measurement time per case
+	int StepsPerRun;
+	double MinTimePerCase;
+};
+
+struct BenchmarkResult
+{
+	std::string Key;
+	std::string Solver;
+	std::string Problem;
+	int ProblemSize;
+	int NumberOfSensitivityParameters;
+	std::string SensitivityMode;
+	double RunsPerSecond;
+	double RhsCallsPerSecond;
+	long StepsPerRun;
+	long long BytesPerInstance;
+};
+
+static BenchmarkProblem * CreateProblem (const std::string & name, int problemSize, int numberOfSensitivityParameters)
+{
+	if (name == "Robertson")
+		return new RobertsonProblem(numberOfSensitivityParameters);
+	if (name == "HIRES")
+		return new HiresProblem(numberOfSensitivityParameters);
+	return new CompartmentChainProblem(problemSize, numberOfSensitivityParameters);
+}
+
+static void ConfigureSolver (SimModelSolverBase & solver, BenchmarkProblem & problem, int stepsPerRun)
+{
+	solver.SetInitialTime(0.0);
+	solver.SetInitialValues(problem.GetInitialValues());
+	solver.SetSensitivityParametersInitialValues(problem.GetSensitivityParametersValues());
+	solver.SetAbsTol(std::vector < double > (problem.GetProblemSize(), 1e-10));
+	solver.SetRelTol(1e-6);
+	solver.SetHMax(problem.GetEndTime() / stepsPerRun);
+	solver.SetMxStep(stepsPerRun + 10);
+}
+
+//"Reference": fixed number of steps per run; "FixedSize": the same for Robertson without sensitivities
+//with compile-time problem size; "AutoSwitch": adaptive steps (no max. step size)
+static SimModelSolverBase * CreateSolver (const std::string & solverName, BenchmarkProblem & problem, int stepsPerRun)
+{
+	const char * ERROR_SOURCE = "CreateSolver";
+
+	int n = problem.GetProblemSize(), ns = problem.GetNumberOfSensitivityParameters();
+
+	if (solverName == "Reference")
+	{
+		ReferenceSolver * solver = new ReferenceSolver(&problem, n, ns);
+		ConfigureSolver(*solver, problem, stepsPerRun);
+		return solver;
+	}
+
+	if (solverName == "FixedSize")
+	{
+		RobertsonProblem * robertson = dynamic_cast < RobertsonProblem * > (&problem);
+		if (!robertson || (ns != 0))
+			throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Fixed size solver is only available for Robertson without sensitivities");
+
+		FixedSizeReferenceSolver < RobertsonProblem, 3 > * solver = new FixedSizeReferenceSolver < RobertsonProblem, 3 > (robertson);
+		ConfigureSolver(*solver, problem, stepsPerRun);
+		return solver;
+	}
+
+	SimModelSolverAutoSwitch * solver = new SimModelSolverAutoSwitch(&problem, n, ns);
+	ConfigureSolver(*solver, problem, stepsPerRun);
+	solver->SetHMax(0.0);
+	solver->SetMxStep(100000);
+	return solver;
+}
+
+//---- solver factory for the drivers -------------------------------------
+
+class BenchmarkSolverFactory : public ISimModelSolverFactory
+{
+	private:
+		std::string _solverName;
+		std::string _problemName;
+		int _problemSize;
+		int _numberOfSensitivityParameters;
+		int _stepsPerRun;
+
+	public:
+		BenchmarkSolverFactory (const std::string & solverName, const std::string & problemName,
+			                    int problemSize, int numberOfSensitivityParameters, int stepsPerRun)
+			: _solverName(solverName), _problemName(problemName), _problemSize(problemSize),
+			  _numberOfSensitivityParameters(numberOfSensitivityParameters), _stepsPerRun(stepsPerRun)
+		{}
+
+		virtual SimModelSolverBase * CreateSolver ()
+		{
+			BenchmarkProblem * problem = CreateProblem(_problemName, _problemSize, _numberOfSensitivityParameters);
+			return ::CreateSolver(_solverName, *problem, _stepsPerRun);
+		}
+
+		virtual void ReleaseSolver (SimModelSolverBase * solver)
+		{
+			//ISolverCaller has no virtual destructor
+			BenchmarkProblem * problem = static_cast < BenchmarkProblem * > (solver->GetSolverCaller());
+			delete solver;
+			delete problem;
+		}
+};
+
+//---- static vs. virtual dispatch ----------------------------------------
+
+//solver which only forwards RHS calls to its caller through the Call... routine of TBase
+//(SimModelSolverBase: virtual dispatch, SimModelSolverStaticBase: static dispatch)
+template < class TBase >
+class RhsDispatchSolver : public TBase
+{
+	public:
+		RhsDispatchSolver (RobertsonProblem * problem)
+			: TBase(problem, problem->GetProblemSize(), 0)
+		{}
+
+		Rhs_Return_Value EvaluateRhs (double t, const double * y, double * ydot)
+		{
+			return this->CallODERhsFunction(t, y, NULL, ydot, NULL);
+		}
+
+		virtual std::vector < OptionInfo > GetSolverOptionsInfo ()
+		{
+			return std::vector < OptionInfo > ();
+		}
+
+		virtual int PerformSolverStep (double, double *, double **, double &)
+		{
+			return -1;
+		}
+
+		virtual void Terminate ()
+		{}
+
+		virtual std::string GetSolverErrMsg (int)
+		{
+			return "RhsDispatchSolver does not integrate";
+		}
+
+		virtual void SetOption (const std::string &, double)
+		{}
+
+		virtual SimModelSolverErrorData::errNumber GetErrorNumberFromSolverReturnValue (int)
+		{
+			return SimModelSolverErrorData::err_FAILURE;
+		}
+};
+
+template < class TBase >
+static double MeasureRhsDispatch (RobertsonProblem & problem, int stepsPerRun, long numberOfCalls, double & checksum)
+{
+	RhsDispatchSolver < TBase > solver(&problem);
+	ConfigureSolver(solver, problem, stepsPerRun);
+	solver.Init();
+
+	std::vector < double > y = problem.GetInitialValues(), ydot(y.size());
+
+	double start = CurrentTimeInSeconds();
+	for (long i = 0; i < numberOfCalls; i++)
+	{
+		solver.EvaluateRhs(i * 1e-9, &y[0], &ydot[0]);
+		checksum += ydot[0];
+	}
+	double elapsed = CurrentTimeInSeconds() - start;
+
+	solver.Terminate();
+
+	return elapsed;
+}
+
+//---- microbenchmarks ----------------------------------------------------
+
+static void RunMicrobenchmarks (const BenchmarkSettings & settings)
+{
+	const char * ERROR_SOURCE = "RunMicrobenchmarks";
+
+	const long numberOfCalls = settings.Quick ? 200000 : 5000000;
+
+	RobertsonProblem problem(0);
+	ISolverCaller * caller = &problem;
+	std::vector < double > y = problem.GetInitialValues(), ydot(y.size());
+	double checksum = 0.0;
+
+	//cost of the virtual RHS dispatch (incl. trivial RHS)
+	double start = CurrentTimeInSeconds();
+	for (long i = 0; i < numberOfCalls; i++)
+	{
+		caller->ODERhsFunction(i * 1e-9, &y[0], NULL, &ydot[0], NULL);
+		checksum += ydot[0];
+	}
+	double rhsTime = CurrentTimeInSeconds() - start;
+
+	//the same through the solver base (incl. statistics update)
+	double virtualDispatchTime = MeasureRhsDispatch < SimModelSolverBase > (problem, settings.StepsPerRun, numberOfCalls, checksum);
+	double staticDispatchTime = MeasureRhsDispatch < SimModelSolverStaticBase < RobertsonProblem > > (problem, settings.StepsPerRun, numberOfCalls, checksum);
+
+	//cost of ReInit (no integration in between)
+	ReferenceSolver solver(&problem, problem.GetProblemSize(), 0);
+	ConfigureSolver(solver, problem, settings.StepsPerRun);
+	solver.Init();
+
+	const long numberOfReInits = numberOfCalls / 10;
+	start = CurrentTimeInSeconds();
+	for (long i = 0; i < numberOfReInits; i++)
+	{
+		if (solver.ReInit(0.0, y) != 0)
+			throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "ReInit failed");
+	}
+	double reInitTime = CurrentTimeInSeconds() - start;
+
+	//fixed size solver: complete runs (ReInit from a pointer + outputs) must not allocate
+	FixedSizeReferenceSolver < RobertsonProblem, 3 > fixedSizeSolver(&problem);
+	ConfigureSolver(fixedSizeSolver, problem, settings.StepsPerRun);
+	fixedSizeSolver.Init();
+
+	std::vector < double > yOut(y.size());
+	double tret;
+	const long numberOfFixedSizeRuns = numberOfCalls / 10000;
+	long long allocationsBefore = g_numberOfAllocations;
+
+	start = CurrentTimeInSeconds();
+	for (long i = 0; i < numberOfFixedSizeRuns; i++)
+	{
+		if (fixedSizeSolver.ReInit(0.0, &y[0]) != 0)
+			throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "ReInit failed");
+
+		for (int k = 1; k <= 10; k++)
+			if (fixedSizeSolver.PerformSolverStep(problem.GetEndTime() * k / 10, &yOut[0], NULL, tret) != 0)
+				throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Fixed size solver failed");
+	}
+	double fixedSizeRunTime = CurrentTimeInSeconds() - start;
+	long long fixedSizeAllocations = g_numberOfAllocations - allocationsBefore;
+	fixedSizeSolver.Terminate();
+
+	//new run with the same solver: Terminate + Init vs. ResetForReuse (chain with 100 compartments)
+	CompartmentChainProblem chain(100, 10);
+	ReferenceSolver chainSolver(&chain, chain.GetProblemSize(), chain.GetNumberOfSensitivityParameters());
+	ConfigureSolver(chainSolver, chain, settings.StepsPerRun);
+	chainSolver.Init();
+
+	const long numberOfRestarts = numberOfCalls / 1000;
+	start = CurrentTimeInSeconds();
+	for (long i = 0; i < numberOfRestarts; i++)
+	{
+		chainSolver.Terminate();
+		chainSolver.Init();
+	}
+	double restartTime = CurrentTimeInSeconds() - start;
+
+	start = CurrentTimeInSeconds();
+	for (long i = 0; i < numberOfRestarts; i++)
+		chainSolver.ResetForReuse();
+	double resetTime = CurrentTimeInSeconds() - start;
+
+	chainSolver.Terminate();
+	solver.Terminate();
+
+	if (settings.Csv)
+	{
+		printf("#micro,rhs_dispatch_ns,%.3f\n", 1e9 * rhsTime / numberOfCalls);
+		printf("#micro,rhs_virtual_base_ns,%.3f\n", 1e9 * virtualDispatchTime / numberOfCalls);
+		printf("#micro,rhs_static_base_ns,%.3f\n", 1e9 * staticDispatchTime / numberOfCalls);
+		printf("#micro,reinit_ns,%.3f\n", 1e9 * reInitTime / numberOfReInits);
+		printf("#micro,fixed_size_run_us,%.3f\n", 1e6 * fixedSizeRunTime / numberOfFixedSizeRuns);
+		printf("#micro,fixed_size_run_allocations,%lld\n", fixedSizeAllocations);
+		printf("#micro,terminate_init_ns,%.3f\n", 1e9 * restartTime / numberOfRestarts);
+		printf("#micro,reset_for_reuse_ns,%.3f\n", 1e9 * resetTime / numberOfRestarts);
+	}
+	else
+	{
+		printf("ISolverCaller::ODERhsFunction dispatch: %10.3f ns/call (checksum %g)\n", 1e9 * rhsTime / numberOfCalls, checksum);
+		printf("SimModelSolverBase RHS call:            %10.3f ns/call\n", 1e9 * virtualDispatchTime / numberOfCalls);
+		printf("SimModelSolverStaticBase RHS call:      %10.3f ns/call\n", 1e9 * staticDispatchTime / numberOfCalls);
+		printf("SimModelSolverBase::ReInit:             %10.3f ns/call\n", 1e9 * reInitTime / numberOfReInits);
+		printf("Fixed size run (Robertson, ReInit + 10 outputs): %10.3f us/run, %lld allocations\n",
+			   1e6 * fixedSizeRunTime / numberOfFixedSizeRuns, fixedSizeAllocations);
+		printf("Terminate + Init (chain n=100, ns=10):  %10.3f ns/call\n", 1e9 * restartTime / numberOfRestarts);
+		printf("ResetForReuse (chain n=100, ns=10):     %10.3f ns/call\n\n", 1e9 * resetTime / numberOfRestarts);
+	}
+}
+
+//---- drivers ------------------------------------------------------------
+
+//ensemble of runs of the chain (n=100) with perturbed initial values
+static void AddEnsembleRuns (SimModelSolverEnsemble & ensemble, int numberOfRuns, int numberOfSensitivityParameters)
+{
+	CompartmentChainProblem chain(100, numberOfSensitivityParameters);
+	std::vector < double > y0 = chain.GetInitialValues(), p = chain.GetSensitivityParametersValues();
+
+	for (int run = 0; run < numberOfRuns; run++)
+	{
+		y0[0] = 1.0 + 0.01 * run;
+		ensemble.AddRun(y0, p);
+	}
+}
+
+static void RunDriverBenchmarks (const BenchmarkSettings & settings)
+{
+	const char * ERROR_SOURCE = "RunDriverBenchmarks";
+
+	const int numberOfRuns = settings.Quick ? 16 : 128;
+	BenchmarkSolverFactory factory("AutoSwitch", "Chain", 100, 0, settings.StepsPerRun);
+
+	std::vector < double > outputTimes;
+	for (int k = 1; k <= 10; k++)
+		outputTimes.push_back(2.4 * k);
+
+	std::vector < double > solution((size_t)numberOfRuns * outputTimes.size() * 100);
+
+	//ensemble: one thread vs. all hardware threads
+	double ensembleTime[2];
+	for (int parallel = 0; parallel <= 1; parallel++)
+	{
+		SimModelSolverEnsemble ensemble(&factory, parallel ? 0 : 1);
+		ensemble.SetOutputTimes(outputTimes);
+		AddEnsembleRuns(ensemble, numberOfRuns, 0);
+
+		double start = CurrentTimeInSeconds();
+		if (ensemble.Run(&solution[0], NULL) != 0)
+			throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Ensemble run failed");
+		ensembleTime[parallel] = CurrentTimeInSeconds() - start;
+	}
+
+	//result cache: first run fills the cache, second run is served from the cache
+	SimModelSolverResultCache resultCache;
+	SimModelSolverEnsemble cachedEnsemble(&factory, 1);
+	cachedEnsemble.SetOutputTimes(outputTimes);
+	cachedEnsemble.SetResultCache(&resultCache, "Chain/100/AutoSwitch");
+	AddEnsembleRuns(cachedEnsemble, numberOfRuns, 0);
+
+	double cacheTime[2];
+	for (int pass = 0; pass <= 1; pass++)
+	{
+		double start = CurrentTimeInSeconds();
+		if (cachedEnsemble.Run(&solution[0], NULL) != 0)
+			throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Ensemble run with result cache failed");
+		cacheTime[pass] = CurrentTimeInSeconds() - start;
+	}
+
+	if (resultCache.GetNumberOfHits() != numberOfRuns)
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Unexpected number of result cache hits");
+
+	//new solver per run (CreateSolver + Init + ReleaseSolver) vs. pooled solver (Acquire + ResetForReuse + Release)
+	const long numberOfAcquires = settings.Quick ? 200 : 2000;
+	SimModelSolverPoolKey poolKey(100, 0, 1, 1);
+
+	double start = CurrentTimeInSeconds();
+	for (long i = 0; i < numberOfAcquires; i++)
+	{
+		SimModelSolverBase * solver = factory.CreateSolver();
+		solver->Init();
+		solver->Terminate();
+		factory.ReleaseSolver(solver);
+	}
+	double createTime = CurrentTimeInSeconds() - start;
+
+	SimModelSolverPool pool;
+	start = CurrentTimeInSeconds();
+	for (long i = 0; i < numberOfAcquires; i++)
+	{
+		SimModelSolverBase * solver = pool.Acquire(poolKey, &factory);
+		solver->ResetForReuse();
+		pool.Release(solver);
+	}
+	double poolTime = CurrentTimeInSeconds() - start;
+	pool.Clear();
+
+	if (settings.Csv)
+	{
+		printf("#driver,ensemble_1_thread_runs_per_s,%.6g\n", numberOfRuns / ensembleTime[0]);
+		printf("#driver,ensemble_all_threads_runs_per_s,%.6g\n", numberOfRuns / ensembleTime[1]);
+		printf("#driver,result_cache_miss_runs_per_s,%.6g\n", numberOfRuns / cacheTime[0]);
+		printf("#driver,result_cache_hit_runs_per_s,%.6g\n", numberOfRuns / cacheTime[1]);
+		printf("#driver,create_init_release_ns,%.3f\n", 1e9 * createTime / numberOfAcquires);
+		printf("#driver,pool_acquire_reset_release_ns,%.3f\n", 1e9 * poolTime / numberOfAcquires);
+	}
+	else
+	{
+		printf("Ensemble (AutoSwitch, chain n=100), 1 thread:        %12.6g runs/s\n", numberOfRuns / ensembleTime[0]);
+		printf("Ensemble (AutoSwitch, chain n=100), all threads:     %12.6g runs/s\n", numberOfRuns / ensembleTime[1]);
+		printf("Result cache, all misses (1 thread):                 %12.6g runs/s\n", numberOfRuns / cacheTime[0]);
+		printf("Result cache, all hits (1 thread):                   %12.6g runs/s\n", numberOfRuns / cacheTime[1]);
+		printf("CreateSolver + Init + ReleaseSolver (chain n=100):   %12.3f ns/call\n", 1e9 * createTime / numberOfAcquires);
+		printf("Pool Acquire + ResetForReuse + Release (chain n=100):%12.3f ns/call\n\n", 1e9 * poolTime / numberOfAcquires);
+	}
+}
+
+//---- throughput ---------------------------------------------------------
+
+static BenchmarkResult RunCase (const BenchmarkSettings & settings, const std::string & solverName, const std::string & problemName,
+	                            int problemSize, int numberOfSensitivityParameters, bool useSensitivityRhsAll)
+{
+	const char * ERROR_SOURCE = "RunCase";
+
+	BenchmarkProblem * problem = CreateProblem(problemName, problemSize, numberOfSensitivityParameters);
+	problem->SetUseSensitivityRhsAll(useSensitivityRhsAll);
+
+	int n = problem->GetProblemSize(), ns = numberOfSensitivityParameters;
+
+	//memory of one solver instance (incl. work storage allocated in Init)
+	long long bytesBefore = g_allocatedBytes;
+	SimModelSolverBase * solver = CreateSolver(solverName, *problem, settings.StepsPerRun);
+	solver->Init();
+	long long bytesPerInstance = g_allocatedBytes - bytesBefore;
+
+	std::vector < double > y(n), y0 = problem->GetInitialValues();
+	std::vector < double > ySData((size_t)n * (ns > 0 ? ns : 1));
+	std::vector < double * > yS(n);
+	for (int i = 0; i < n; i++)
+		yS[i] = &ySData[(size_t)i * (ns > 0 ? ns : 1)];
+
+	const int numberOfOutputs = 10;
+	double endTime = problem->GetEndTime(), tret;
+
+	long runs = 0, steps = 0;
+	problem->ResetNumberOfRhsCalls();
+
+	double start = CurrentTimeInSeconds(), elapsed = 0.0;
+	while ((runs < 3) || (elapsed < settings.MinTimePerCase))
+	{
+		if (runs > 0 && solver->ReInit(0.0, y0) != 0)
+			throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "ReInit failed");
+
+		for (int k = 1; k <= numberOfOutputs; k++)
+		{
+			int retVal = solver->PerformSolverStep(endTime * k / numberOfOutputs, &y[0], ns > 0 ? &yS[0] : NULL, tret);
+			if (retVal != 0)
+				throw SimModelSolverErrorData(solver->GetErrorNumberFromSolverReturnValue(retVal), ERROR_SOURCE,
+					                          problemName + ": " + solver->GetSolverErrMsg(retVal));
+		}
+
+		runs++;
+		elapsed = CurrentTimeInSeconds() - start;
+	}
+
+	steps = solver->GetSolverStatistics().NumberOfSteps / runs;
+
+	BenchmarkResult result;
+	result.Solver = solverName;
+	result.Problem = problemName;
+	result.ProblemSize = n;
+	result.NumberOfSensitivityParameters = ns;
+	result.SensitivityMode = ns == 0 ? "none" : (useSensitivityRhsAll ? "all" : "single");
+	result.RunsPerSecond = runs / elapsed;
+	result.RhsCallsPerSecond = problem->GetNumberOfRhsCalls() / elapsed;
+	result.StepsPerRun = steps;
+	result.BytesPerInstance = bytesPerInstance;
+
+	std::ostringstream key;
+	key << result.Solver << "/" << result.Problem << "/" << n << "/" << ns << "/" << result.SensitivityMode;
+	result.Key = key.str();
+
+	solver->Terminate();
+	delete solver;
+	delete problem;
+
+	return result;
+}
+
+static std::map < std::string, double > ReadBaseline (const std::string & fileName)
+{
+	const char * ERROR_SOURCE = "ReadBaseline";
+
+	std::ifstream file(fileName.c_str());
+	if (!file.good())
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Cannot open baseline file " + fileName);
+
+	std::map < std::string, double > baseline;
+	std::string line;
+
+	while (std::getline(file, line))
+	{
+		if (line.empty() || (line[0] == '#') || (line.compare(0, 6, "solver") == 0))
+			continue;
+
+		//solver,problem,n,ns,sensitivity,runs_per_s,...
+		std::vector < std::string > fields;
+		std::istringstream stream(line);
+		std::string field;
+		while (std::getline(stream, field, ','))
+			fields.push_back(field);
+
+		if (fields.size() < 6)
+			continue;
+
+		baseline[fields[0] + "/" + fields[1] + "/" + fields[2] + "/" + fields[3] + "/" + fields[4]] = atof(fields[5].c_str());
+	}
+
+	return baseline;
+}
+
+static void PrintUsage ()
+{
+	printf("Usage: OSPSuite.SimModelSolverBase.Benchmark [--quick] [--csv] [--baseline <file> [--tolerance <fraction>]]\n");
+}
+
+int main (int argc, char * argv[])
+{
+	BenchmarkSettings settings;
+	settings.Quick = false;
+	settings.Csv = false;
+	settings.Tolerance = 0.2;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--quick") == 0)
+			settings.Quick = true;
+		else if (strcmp(argv[i], "--csv") == 0)
+			settings.Csv = true;
+		else if ((strcmp(argv[i], "--baseline") == 0) && (i + 1 < argc))
+			settings.BaselineFile = argv[++i];
+		else if ((strcmp(argv[i], "--tolerance") == 0) && (i + 1 < argc))
+			settings.Tolerance = atof(argv[++i]);
+		else
+		{
+			PrintUsage();
+			return 2;
+		}
+	}
+
+	settings.StepsPerRun = settings.Quick ? 200 : 1000;
+	settings.MinTimePerCase = settings.Quick ? 0.05 : 0.5;
+
+	try
+	{
+		RunMicrobenchmarks(settings);
+		RunDriverBenchmarks(settings);
+
+		std::vector < BenchmarkResult > results;
+
+		for (int useAll = 0; useAll <= 1; useAll++)
+		{
+			for (int ns = 0; ns <= 3; ns += 3)
+			{
+				if ((ns == 0) && useAll)
+					continue;
+				results.push_back(RunCase(settings, "Reference", "Robertson", 3, ns, useAll == 1));
+				if (ns == 0)
+					results.push_back(RunCase(settings, "FixedSize", "Robertson", 3, ns, false));
+				results.push_back(RunCase(settings, "Reference", "HIRES", 8, ns, useAll == 1));
+			}
+		}
+
+		const int chainSizes[] = {10, 100, 1000};
+		const int chainSensitivities[] = {0, 1, 10};
+
+		for (int iN = 0; iN < 3; iN++)
+		{
+			for (int iS = 0; iS < 3; iS++)
+			{
+				int ns = chainSensitivities[iS];
+				results.push_back(RunCase(settings, "Reference", "Chain", chainSizes[iN], ns, false));
+				if (ns > 0)
+					results.push_back(RunCase(settings, "Reference", "Chain", chainSizes[iN], ns, true));
+			}
+		}
+
+		for (int ns = 0; ns <= 3; ns += 3)
+		{
+			results.push_back(RunCase(settings, "AutoSwitch", "Robertson", 3, ns, false));
+			results.push_back(RunCase(settings, "AutoSwitch", "HIRES", 8, ns, false));
+		}
+		results.push_back(RunCase(settings, "AutoSwitch", "Chain", 100, 0, false));
+		results.push_back(RunCase(settings, "AutoSwitch", "Chain", 100, 10, false));
+
+		if (settings.Csv)
+			printf("solver,problem,n,ns,sensitivity,runs_per_s,rhs_calls_per_s,steps_per_run,bytes_per_instance\n");
+		else
+			printf("%-10s %-10s %6s %4s %-7s %14s %16s %10s %14s\n", "solver", "problem", "n", "ns", "sens", "runs/s", "rhs calls/s", "steps/run", "bytes/inst");
+
+		for (size_t i = 0; i < results.size(); i++)
+		{
+			const BenchmarkResult & r = results[i];
+			const char * format = settings.Csv ? "%s,%s,%d,%d,%s,%.6g,%.6g,%ld,%lld\n"
+				                               : "%-10s %-10s %6d %4d %-7s %14.6g %16.6g %10ld %14lld\n";
+			printf(format, r.Solver.c_str(), r.Problem.c_str(), r.ProblemSize, r.NumberOfSensitivityParameters, r.SensitivityMode.c_str(),
+				   r.RunsPerSecond, r.RhsCallsPerSecond, r.StepsPerRun, r.BytesPerInstance);
+		}
+
+		if (settings.BaselineFile.empty())
+			return 0;
+
+		std::map < std::string, double > baseline = ReadBaseline(settings.BaselineFile);
+		int numberOfRegressions = 0;
+
+		for (size_t i = 0; i < results.size(); i++)
+		{
+			std::map < std::string, double >::const_iterator it = baseline.find(results[i].Key);
+			if (it == baseline.end())
+				continue;
+
+			if (results[i].RunsPerSecond < it->second * (1.0 - settings.Tolerance))
+			{
+				fprintf(stderr, "REGRESSION %s: %.6g runs/s (baseline %.6g runs/s)\n",
+					    results[i].Key.c_str(), results[i].RunsPerSecond, it->second);
+				numberOfRegressions++;
+			}
+		}
+
+		return numberOfRegressions > 0 ? 1 : 0;
+	}
+	catch (SimModelSolverErrorData & ED)
+	{
+		fprintf(stderr, "%s: %s\n", ED.GetSource().c_str(), ED.GetDescription().c_str());
+		return 2;
+	}
+}
@@ -0,0 +1,231 @@
+#ifndef _SimModelSolverAutoSwitch_H_
+#define _SimModelSolverAutoSwitch_H_
+
+#include <vector>
+#include <string>
+#include "SimModelSolverBase/SimModelSolverBase.h"
+
+//-------------------------------------------------------------------------
+//ODE solver switching automatically between an explicit and a linearly
+//implicit method, depending on the stiffness of the problem:
+//
+// - non-stiff: Bogacki-Shampine 3(2) explicit Runge-Kutta pair (FSAL).
+//   No Jacobian and no linear systems.
+// - stiff: modified Rosenbrock (W-) method 2(3) of Shampine & Reichelt
+//   (MATLAB ode23s), L-stable. Jacobian and LU factorization of
+//   I - h*d*J in every step (dense or, if the solver caller requests a
+//   band solver, band LU with partial pivoting).
+//
+//Stiffness is estimated at runtime: in explicit mode from the last two
+//stages (|f(y4) - f(y3)| / |y4 - y3|) and a matrix free power iteration
+//(one extra RHS evaluation every few steps), in implicit mode by power
+//iteration with the Jacobian of the step.
+//The method is switched after StiffnessSwitchSteps consecutive accepted
+//steps for which h * rho (rho = spectral radius estimate) is above resp.
+//far below the stability boundary of the explicit method.
+//
+//With a step size profile (warm start), the first step after Init/ReInit
+//uses step size and method of the reference run (reported order: 3 =
+//explicit, 2 = implicit).
+//
+//Sensitivities are integrated together with the states by the same method
+//(staggered Jacobian: J is used for every sensitivity block); only the
+//states take part in the error control.
+//Only the sensitivities of the active parameters are integrated: their
+//blocks are stored first, the system shrinks when parameters are deactivated.
+//DDE systems (without sensitivities) are integrated with the delayed values
+//taken from the solution history of the base class (cubic Hermite
+//interpolation of the accepted step points; delays shorter than the step
+//size are extrapolated from the last step).
+//Roots of the root functions of the solver caller are located within the
+//internal steps (see SimModelSolverBase::PerformSolverStepWithRoots).
+//Only the direct linear solver (LS_DIRECT) is supported.
+//-------------------------------------------------------------------------
+
+class SimModelSolverAutoSwitch : public SimModelSolverBase
+{
+	public:
+		enum ReturnValue
+		{
+			AS_SUCCESS = 0,
+			AS_TOO_MUCH_WORK = 1,
+			AS_RHS_FAILURE = -1,
+			AS_JACOBIAN_FAILURE = -2,
+			AS_SINGULAR_MATRIX = -3,
+			AS_SENSITIVITY_RHS_FAILURE = -4,
+			AS_STEP_SIZE_TOO_SMALL = -5
+		};
+
+		enum IntegrationMethod
+		{
+			METHOD_EXPLICIT = 0,
+			METHOD_IMPLICIT = 1,
+			METHOD_AUTOMATIC = 2
+		};
+
+	protected:
+		IntegrationMethod _integrationMethod;
+
+		//number of consecutive steps indicating (non-)stiffness before the method is switched
+		int _stiffnessSwitchSteps;
+
+		double _t;
+
+		//step size proposed for the next step (0 = to be estimated)
+		double _h;
+
+		//method of the next step
+		bool _stiff;
+		int _stiffnessCounter;
+
+		//last estimate of the spectral radius of the Jacobian
+		double _spectralRadius;
+
+		long _numberOfMethodSwitches;
+		long _numberOfExplicitSteps;
+		long _numberOfImplicitSteps;
+
+		//state of the ODE system and sensitivities: z = [y; yS] (yS column-major block of the 
+		//active sensitivity parameters, see _activeSensitivityParameters; vectors are allocated for all)
+		size_t _systemSize;
+		std::vector < double > _z;
+		std::vector < double > _zNew;
+		std::vector < double > _zStage;
+
+		//RHS at (_t, _z) (first stage of the next step)
+		std::vector < double > _f;
+		bool _fValid;
+
+		//RHS at the new point (last stage of the step, reused as first stage of the next step)
+		std::vector < double > _fNew;
+
+		//stages
+		std::vector < double > _k1;
+		std::vector < double > _k2;
+		std::vector < double > _k3;
+		std::vector < double > _fStage;
+
+		//Rosenbrock method: Jacobian and time derivative of the RHS at (_t, _z)
+		bool _jacobianValid;
+		std::vector < double > _jacobian;
+		std::vector < double * > _jacobianRows;
+		std::vector < double > _dfdt;
+
+		//iteration matrix I - h*d*J and its LU factors
+		bool _useBand;
+		int _ml, _mu;
+		std::vector < double > _matrix;
+		std::vector < double * > _matrixRows;
+		std::vector < int > _pivots;
+
+		//LU factors in _matrix are those of I - _factorizationScale*J for the step size _factorizationStepSize
+		bool _factorizationValid;
+		double _factorizationScale;
+		double _factorizationStepSize;
+
+		//Jacobian cache: the Jacobian in _jacobian was evaluated at _jacobianTime (if _jacobianAvailable)
+		bool _jacobianAvailable;
+		double _jacobianTime;
+
+		//restart (Init/ReInit): look up the first Jacobian in the cache, store the first one evaluated
+		bool _jacobianCacheLookup;
+		bool _jacobianCacheStore;
+
+		//Jacobian (and factorization) of the next step taken from the cache
+		bool _jacobianFromCache;
+
+		//power iteration for the spectral radius of the Jacobian
+		std::vector < double > _powerVector;
+		std::vector < double > _powerScratch;
+
+		//reset integration to the initial time and initial values
+		void ResetIntegrationState ();
+
+		//remove blocks of sensitivity parameters not needed anymore at the current time from z and f
+		void RemoveInactiveSensitivities ();
+
+		//RHS of the combined system (states and sensitivities)
+		int EvaluateRhs (double t, const double * z, double * f);
+
+		//one accepted step (not beyond tstop)
+		int TakeStep (double tstop);
+
+		//-----------------------------------------------------------------------------------------------------
+		//Attempt of one step of size h from (_t, _z) to _zNew (RHS at _zNew in _fNew)
+		// - [OUT] errorNorm: weighted RMS norm of the local error estimate (step accepted if <= 1)
+		// - [OUT] stiffnessRatio: h * estimated spectral radius (explicit step only)
+		//-----------------------------------------------------------------------------------------------------
+		int ExplicitStep (double h, double & errorNorm, double & stiffnessRatio);
+		int ImplicitStep (double h, double & errorNorm);
+
+		//Jacobian and dfdt at (_t, _z)
+		int EvaluateJacobian (double h);
+
+		//solver type and matrix layout (entries of the Jacobian cache are only used for the same structure)
+		std::string GetJacobianCacheStructure ();
+
+		//-----------------------------------------------------------------------------------------------------
+		//Take Jacobian (and factorization) of the first step after a restart from the cache
+		//Returns false if the cache has no valid entry
+		//-----------------------------------------------------------------------------------------------------
+		bool LoadJacobianFromCache ();
+		void StoreJacobianInCache ();
+		int FactorizeIterationMatrix (double hd);
+
+		//solve (I - h*d*J) x = b for the first numberOfBlocks n-blocks of b (states, sensitivities)
+		void SolveLinearSystem (double * b, size_t numberOfBlocks);
+
+		//weighted RMS norm of the state part of e
+		double ErrorNorm (const double * e, const double * zOld, const double * zNew);
+
+		//spectral radius estimate of the Jacobian (power iteration, warm started)
+		double EstimateSpectralRadius ();
+
+		//one power iteration with J*v from RHS differences at (_t, _z) (explicit method: no Jacobian available)
+		double EstimateSpectralRadiusMatrixFree ();
+
+		double InitialStepSize (double tstop);
+
+		//switch method if required (after an accepted step)
+		void UpdateIntegrationMethod (double stiffnessRatio);
+
+		void GetSolution (double * y, double ** yS);
+
+		virtual void SaveSolverState (SimModelSolverState & state);
+		virtual void RestoreSolverState (const SimModelSolverState & state, size_t & position);
+
+	public:
+		SIMMODELSOLVER_EXPORT SimModelSolverAutoSwitch (ISolverCaller * pSolverCaller, int problemSize, int numberOfSensitivityParameters);
+
+		SIMMODELSOLVER_EXPORT virtual std::vector < OptionInfo > GetSolverOptionsInfo ();
+		SIMMODELSOLVER_EXPORT virtual void SetOption (const std::string & name, double value);
+
+		SIMMODELSOLVER_EXPORT virtual void Init ();
+		SIMMODELSOLVER_EXPORT virtual int PerformSolverStep (double tout, double * y, double ** yS, double & tret);
+		SIMMODELSOLVER_EXPORT virtual bool SupportsInternalSteps ();
+		SIMMODELSOLVER_EXPORT virtual bool SupportsSensitivityActivation ();
+		SIMMODELSOLVER_EXPORT virtual bool SupportsStateSnapshots ();
+		SIMMODELSOLVER_EXPORT virtual bool SupportsLinearSolver (LinearSolverType linearSolver);
+		SIMMODELSOLVER_EXPORT virtual int PerformInternalStep (double tstop, double * y, double ** yS, double & tret);
+		SIMMODELSOLVER_EXPORT virtual int ReInit (double t0, const std::vector < double > & y0);
+		SIMMODELSOLVER_EXPORT virtual void ResetForReuse ();
+		SIMMODELSOLVER_EXPORT virtual void Terminate ();
+		SIMMODELSOLVER_EXPORT virtual std::string GetSolverErrMsg (int solverRetVal);
+		SIMMODELSOLVER_EXPORT virtual SimModelSolverErrorData::errNumber GetErrorNumberFromSolverReturnValue (int solverRetVal);
+
+		SIMMODELSOLVER_EXPORT IntegrationMethod GetIntegrationMethod ();
+		SIMMODELSOLVER_EXPORT void SetIntegrationMethod (IntegrationMethod integrationMethod);
+
+		SIMMODELSOLVER_EXPORT int GetStiffnessSwitchSteps ();
+		SIMMODELSOLVER_EXPORT void SetStiffnessSwitchSteps (int stiffnessSwitchSteps);
+
+		//true if the next step is taken by the implicit method
+		SIMMODELSOLVER_EXPORT bool IsStiff ();
+
+		//counters since Init
+		SIMMODELSOLVER_EXPORT long GetNumberOfMethodSwitches ();
+		SIMMODELSOLVER_EXPORT long GetNumberOfExplicitSteps ();
+		SIMMODELSOLVER_EXPORT long GetNumberOfImplicitSteps ();
+};
+
+#endif //_SimModelSolverAutoSwitch_H_
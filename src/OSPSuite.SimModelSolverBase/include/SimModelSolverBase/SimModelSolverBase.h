@@ -4,11 +4,32 @@
 #include <vector>
 #include <string>
 #include "SolverCallerInterface/SolverCaller.h"
+#include "SolverCallerInterface/SolverCallerBatch.h"
 #include "SimModelSolverBase/SimModelSolverErrorData.h"
 #include "SimModelSolverBase/OptionInfo.h"
+#include "SimModelSolverBase/SolverStatistics.h"
+#include "SimModelSolverBase/SimModelSolverState.h"
+#include "SimModelSolverBase/SimModelSolverDelayHistory.h"
+#include "SimModelSolverBase/SolverOutputSink.h"
+#include "SimModelSolverBase/SimModelSolverJacobianCache.h"
+#include "SimModelSolverBase/SimModelSolverStepSizeProfile.h"
 
 class SimModelSolverBase
 {	
+	public:
+		//Linear solver used by the Newton iteration of implicit solvers
+		// - LS_DIRECT: dense/band/sparse direct factorization (depending on solver caller)
+		// - LS_GMRES, LS_BICGSTAB: matrix-free iterative (Krylov) solvers using J*v products
+		//   and (optionally) the preconditioner of the solver caller.
+		//   Only accepted by solvers whose SupportsLinearSolver returns true for them
+		//   (none of the solvers of this library yet)
+		enum LinearSolverType
+		{
+			LS_DIRECT = 0,
+			LS_GMRES = 1,
+			LS_BICGSTAB = 2
+		};
+
 	protected:
 
 		//Pointer to the caller instance of the solver.
@@ -47,6 +68,401 @@ class SimModelSolverBase
 
 		//Delays size (Number of delays) for DDE system
 		int _delaysSize;
+
+		//-----------------------------------------------------------------------------------------------------
+		//DDE solution history (only used if the caller provides DDERhsFunction; set in Init).
+		//Init stores the initial state; solvers supporting DDEs MUST call AddDelayHistoryPoint after every
+		//accepted step. CallODERhsFunction evaluates the DDE RHS (CallDDERhsFunction) for DDE systems.
+		//Points older than _maxDelay are dropped (0 = keep all, up to _maxNumberOfDelayHistoryPoints)
+		//-----------------------------------------------------------------------------------------------------
+		bool _ddeSystem;
+		double _maxDelay;
+		int _maxNumberOfDelayHistoryPoints;
+		SimModelSolverDelayHistory _delayHistory;
+		std::vector < double > _ddeDelays;
+		std::vector < double > _ddeDelayedValues;
+		std::vector < double * > _ddeDelayedValuesRows;
+		std::vector < const double * > _ddeDelayedValuesConstRows;
+		std::vector < double > _ddeScratch;
+
+		//Reset DDE history to the initial state (called by Init/ReInit; keeps history before _initialTime on ReInit)
+		SIMMODELSOLVER_EXPORT void InitDelayHistory (bool keepPastHistory);
+
+		//-----------------------------------------------------------------------------------------------------
+		//Evaluate DDE RHS: delayed times from DDEDelayFunction (delays[j] is the time at which y is evaluated),
+		//yd from the solution history; updates statistics like CallODERhsFunction
+		//-----------------------------------------------------------------------------------------------------
+		SIMMODELSOLVER_EXPORT Rhs_Return_Value CallDDERhsFunction (double t, const double * y, double * ydot, void * f_data);
+
+		//Append accepted step point to the DDE history
+		SIMMODELSOLVER_EXPORT void AddDelayHistoryPoint (double t, const double * y, const double * ydot);
+
+		//Batch mode: number of problems of the same structure advanced together (1 = no batch mode)
+		int _batchSize;
+
+		//Batched solver caller (NULL if the caller does not implement ISolverCallerBatch)
+		ISolverCallerBatch * _batchSolverCaller;
+
+		//Initial values/sensitivity parameter values of all problems in the batch
+		//(structure-of-arrays: component i of problem k is stored at [i * _batchSize + k])
+		std::vector < double > _batchInitialValues;
+		std::vector < double > _batchSensitivityParametersInitialValues;
+
+		//-----------------------------------------------------------------------------------------------------
+		//Evaluates the sensitivity RHS for all sensitivity parameters 
+		//(yS, ySdot: contiguous n x NS blocks, see ISolverCaller::ODESensitivityRhsFunctionAll).
+		//Uses ODESensitivityRhsFunctionAll if available, otherwise calls ODESensitivityRhsFunction once per parameter
+		//Returns the "worst" return value of all parameters
+		//-----------------------------------------------------------------------------------------------------
+		SIMMODELSOLVER_EXPORT Sensitivity_Rhs_Return_Value CallODESensitivityRhsFunction(double t, const double * y, double * ydot,
+			                                                                             const double * yS, double * ySdot, void * f_data);
+
+		//-----------------------------------------------------------------------------------------------------
+		//As above for a subset of the sensitivity parameters: yS, ySdot are contiguous n x parameters.size() blocks,
+		//column k belongs to sensitivity parameter parameters[k] (ascending).
+		//With ODESensitivityRhsFunction only the sensitivity RHS of these parameters is evaluated
+		//-----------------------------------------------------------------------------------------------------
+		SIMMODELSOLVER_EXPORT Sensitivity_Rhs_Return_Value CallODESensitivityRhsFunction(double t, const double * y, double * ydot,
+			                                                                             const double * yS, double * ySdot, void * f_data,
+			                                                                             const std::vector < int > & parameters);
+
+		//-----------------------------------------------------------------------------------------------------
+		//Sensitivity subsets (solvers with SupportsSensitivityActivation):
+		// - _sensitivityParametersActive: parameters requested by the caller (empty = all)
+		// - _sensitivityWindowStartTimes/EndTimes: sensitivities are returned in these time windows only
+		//   (empty = whole run); they are integrated from the start up to the end of the last window
+		// - _activeSensitivityParameters: parameters integrated by the solver now (ascending).
+		//   Set by Init; solvers remove parameters which are not needed anymore with 
+		//   DeactivateSensitivityParameters (after accepted steps and at ReInit)
+		// - _sensitivityParametersActivationPending: parameters activated after Init which are not integrated;
+		//   reported inactive (outputs 0) until the next Init/ResetForReuse
+		//-----------------------------------------------------------------------------------------------------
+		std::vector < bool > _sensitivityParametersActive;
+		std::vector < bool > _sensitivityParametersActivationPending;
+		std::vector < double > _sensitivityWindowStartTimes;
+		std::vector < double > _sensitivityWindowEndTimes;
+		std::vector < int > _activeSensitivityParameters;
+
+		//full n x NS blocks for ODESensitivityRhsFunctionAll with a subset of the parameters
+		std::vector < double > _sensitivitySubsetScratchYS;
+		std::vector < double > _sensitivitySubsetScratchYSdot;
+
+		//true if sensitivity parameter is requested and its activation is not pending
+		bool IsSensitivityParameterActive (int sensitivityParameterIndex);
+
+		//true if sensitivity parameter is requested and still needed at time t
+		SIMMODELSOLVER_EXPORT bool IsSensitivityParameterNeeded (int sensitivityParameterIndex, double t);
+
+		//true if sensitivities are returned at time t (inside one of the time windows)
+		SIMMODELSOLVER_EXPORT bool IsInSensitivityTimeWindow (double t);
+
+		//Remove parameters not needed anymore at time t from _activeSensitivityParameters. Returns true if changed
+		SIMMODELSOLVER_EXPORT bool DeactivateSensitivityParameters (double t);
+
+		//Set sensitivities (rows yS[i][j]) of inactive parameters and outside the time windows to 0
+		SIMMODELSOLVER_EXPORT void ApplySensitivityActivation (double t, double * * yS);
+
+		//Structural sparsity pattern of the Jacobian (only filled if the caller provides a sparse Jacobian).
+		//Loaded ONCE in Init, so that solvers can reuse the symbolic analysis of the sparse factorization
+		Sparse_Matrix_Format _jacobianSparsityFormat;
+		std::vector < int > _jacobianSparsityIndexPointers;
+		std::vector < int > _jacobianSparsityIndexValues;
+
+		//Query and validate sparsity pattern of the Jacobian from the solver caller
+		SIMMODELSOLVER_EXPORT void LoadJacobianSparsityPattern ();
+
+		//-----------------------------------------------------------------------------------------------------
+		//Finite difference Jacobian, used by CallODEJacFunction if the caller provides no Jacobian.
+		//Columns of the Jacobian which have no nonzero row in common get the same color (Curtis-Powell-Reed)
+		//and are computed together with ONE RHS evaluation per color.
+		//Sparsity pattern (CSC) is taken from the sparse Jacobian pattern of the caller, the band 
+		//structure of the caller, by probing (if enabled) or assumed to be dense (in this order)
+		//-----------------------------------------------------------------------------------------------------
+		bool _jacobianSparsityProbing;
+		bool _fdJacobianPatternProbed;
+		std::vector < int > _fdJacobianColumnPointers;
+		std::vector < int > _fdJacobianRowIndices;
+		int _fdJacobianNumberOfColors;
+		std::vector < int > _fdJacobianColorPointers;
+		std::vector < int > _fdJacobianColorColumns;
+		std::vector < double > _fdJacobianYPerturbed;
+		std::vector < double > _fdJacobianFPerturbed;
+		std::vector < double > _fdJacobianFReference;
+		std::vector < double > _fdJacobianIncrements;
+
+		//Set up sparsity pattern and coloring (called in Init)
+		SIMMODELSOLVER_EXPORT void SetupFiniteDifferenceJacobian ();
+
+		//Determine sparsity pattern by perturbing every component once (n + 1 RHS evaluations near the initial values)
+		SIMMODELSOLVER_EXPORT void ProbeJacobianSparsityPattern ();
+
+		//Compute the nonzeros of the Jacobian (entries outside the sparsity pattern are not touched)
+		SIMMODELSOLVER_EXPORT Jacobian_Return_Value FiniteDifferenceJacobian (double t, const double * y, const double * p, const double * fy, 
+			                                                                  double * * Jacobian);
+
+		//Linear solver for implicit solvers
+		LinearSolverType _linearSolver;
+
+		//Max. dimension of the Krylov subspace (only relevant for iterative linear solvers)
+		int _krylovMaxDimension;
+
+		//-----------------------------------------------------------------------------------------------------
+		//Options handled by the base class (linear solver etc.)
+		//Inherited classes should append them in GetSolverOptionsInfo and pass every option
+		//to SetBaseSolverOption first in SetOption.
+		//SetBaseSolverOption returns true if the option was handled by the base class
+		//-----------------------------------------------------------------------------------------------------
+		SIMMODELSOLVER_EXPORT std::vector < OptionInfo > GetBaseSolverOptionsInfo ();
+		SIMMODELSOLVER_EXPORT bool SetBaseSolverOption (const std::string & name, double value);
+
+		//-----------------------------------------------------------------------------------------------------
+		//Dense output (see PerformSolverSteps): the last two internal step points of the solver.
+		//[0] = previous, [1] = last step point. yS stored row-major (yS_ij at [i * NS + j]).
+		//Derivatives f/fS are only computed on demand by the default InterpolateSolution
+		//-----------------------------------------------------------------------------------------------------
+		bool _denseOutputValid;
+		double _denseT[2];
+		std::vector < double > _denseY[2];
+		std::vector < double > _denseYS[2];
+		std::vector < double > _denseF[2];
+		std::vector < double > _denseFS[2];
+		bool _denseFValid[2];
+		std::vector < double * > _denseYSRows;
+		std::vector < double > _denseScratch;
+
+		//target of the next internal step (becomes step point [1] if the step succeeds)
+		std::vector < double > _denseYNext;
+		std::vector < double > _denseYSNext;
+
+		//column-major sensitivities passed to the sensitivity RHS by ComputeDenseOutputDerivatives
+		std::vector < double > _denseSensitivityScratch;
+
+		//Set internal step point [1] to the initial state of the solver
+		SIMMODELSOLVER_EXPORT void InitDenseOutput ();
+
+		//Compute RHS (and sensitivity RHS, if available) at internal step point [index] 
+		SIMMODELSOLVER_EXPORT int ComputeDenseOutputDerivatives (int index);
+
+		//-----------------------------------------------------------------------------------------------------
+		//Take ONE internal step of the solver in direction of tstop, without stepping past tstop.
+		//Required by PerformSolverSteps; only available if SupportsInternalSteps() returns true
+		// - [IN] tstop: the solver must not integrate beyond tstop
+		// - [OUT] y, yS, tret: solution at the end of the internal step (as for PerformSolverStep)
+		//Return value: as for PerformSolverStep
+		//-----------------------------------------------------------------------------------------------------
+		SIMMODELSOLVER_EXPORT virtual int PerformInternalStep (double tstop, double * y, double ** yS, double & tret);
+
+		//-----------------------------------------------------------------------------------------------------
+		//Steady state detection: integration stops if the weighted RMS norm of dy/dt 
+		//(weights 1/(relTol*|y_i| + absTol_i), optionally also of dyS/dt) is <= _steadyStateTolerance.
+		//The solution at the steady state is returned for all later output times
+		//-----------------------------------------------------------------------------------------------------
+		bool _steadyStateDetection;
+		double _steadyStateTolerance;
+		bool _steadyStateSensitivities;
+		bool _steadyStateReached;
+		double _steadyStateTime;
+		std::vector < double > _steadyStateValues;
+		std::vector < double > _steadyStateSensitivityValues;
+
+		//scratch memory of CheckSteadyStateAtOutput (RHS, column-major yS and sensitivity RHS)
+		std::vector < double > _steadyStateScratchF;
+		std::vector < double > _steadyStateScratchYS;
+		std::vector < double > _steadyStateScratchYSdot;
+
+		//-----------------------------------------------------------------------------------------------------
+		//Check steady state criterion at (t, y) and store the steady state if it is reached.
+		//Solvers should call it in PerformSolverStep with the RHS they have computed anyway
+		//and return the stored solution for the rest of the integration (if SteadyStateReached())
+		// - [IN] ydot: RHS at (t, y)
+		// - [IN, OPTIONAL] yS, ySdot: sensitivities and sensitivity RHS (may be NULL);
+		//                             dy_i/dp_j is stored at [i * ySRowStride + j * ySColumnStride]
+		// - [IN, OPTIONAL] parameters: if not NULL, yS and ySdot only contain the columns of these parameters
+		//                              (column j = parameter (*parameters)[j], e.g. _activeSensitivityParameters);
+		//                              the steady state sensitivities of all other parameters are 0
+		//Returns true if steady state detection is enabled and the criterion holds
+		//-----------------------------------------------------------------------------------------------------
+		SIMMODELSOLVER_EXPORT bool CheckSteadyState (double t, const double * y, const double * ydot, 
+			                                         const double * yS, const double * ySdot, int ySRowStride, int ySColumnStride,
+			                                         const std::vector < int > * parameters = NULL);
+
+		//Evaluate RHS (and sensitivity RHS) at an output of PerformSolverStep and check steady state criterion (yS row-major)
+		SIMMODELSOLVER_EXPORT int CheckSteadyStateAtOutput (double t, const double * y, const double * yS);
+
+		//Copy stored steady state into y (and yS, row-major, if not NULL)
+		SIMMODELSOLVER_EXPORT void GetSteadyStateSolution (double * y, double * yS);
+
+		//-----------------------------------------------------------------------------------------------------
+		//Adjoint sensitivities (see PerformAdjointForwardPass/ComputeAdjointSensitivities).
+		//The forward pass stores a state snapshot every _adjointCheckpointInterval internal steps;
+		//the backward pass recomputes the internal step points of one segment at a time from its
+		//checkpoint, so memory is O(number of checkpoints + checkpoint interval)
+		//-----------------------------------------------------------------------------------------------------
+		int _adjointCheckpointInterval;
+		bool _adjointForwardPassValid;
+		double _adjointFinalTime;
+		std::vector < SimModelSolverState > _adjointCheckpoints;
+		std::vector < double > _adjointCheckpointTimes;
+		std::vector < double > _adjointCheckpointValues;
+		std::vector < int > _adjointSegmentSteps;
+		SimModelSolverState _adjointFinalState;
+
+		//internal step points of the current segment
+		std::vector < double > _adjointSegmentTimes;
+		std::vector < double > _adjointSegmentValues;
+
+		//backward integration: Jacobian, iteration matrix and its LU factors
+		std::vector < double > _adjointJacobian;
+		std::vector < double * > _adjointJacobianRows;
+		std::vector < double > _adjointMatrix;
+		std::vector < double * > _adjointMatrixRows;
+		std::vector < int > _adjointPivots;
+
+		//Internal step points of the segment starting at checkpoint [segment] (by restoring the checkpoint)
+		SIMMODELSOLVER_EXPORT int RecomputeAdjointSegment (size_t segment);
+
+		//Evaluate adjoint RHS/quadrature of the solver caller and update statistics
+		//(CallODEAdjointRhsFunction uses the Jacobian in _adjointJacobianRows if the caller provides no adjoint RHS)
+		SIMMODELSOLVER_EXPORT Rhs_Return_Value CallODEAdjointRhsFunction (double t, const double * y, const double * lambda, double * lambdaDot);
+		SIMMODELSOLVER_EXPORT Rhs_Return_Value CallODEAdjointQuadratureFunction (double t, const double * y, const double * lambda, double * qDot);
+
+		//-----------------------------------------------------------------------------------------------------
+		//Interpolate solution within the last internal step [_denseT[0], _denseT[1]].
+		//Default implementation uses cubic Hermite interpolation for y (and for yS if the sensitivity 
+		//RHS is available, linear interpolation otherwise). 
+		//Solvers with own continuous extension (e.g. Nordsieck history of BDF solvers) should override it.
+		//Return value: as for PerformSolverStep
+		//-----------------------------------------------------------------------------------------------------
+		SIMMODELSOLVER_EXPORT virtual int InterpolateSolution (double t, double * y, double ** yS);
+
+		//-----------------------------------------------------------------------------------------------------
+		//Root finding (state dependent events)
+		//_rootsFound[k]: 0 if root function k has no root at _rootTime, 
+		//                +1/-1 if it crossed zero in increasing/decreasing direction
+		//-----------------------------------------------------------------------------------------------------
+		int _numberOfRootFunctions;
+		bool _rootFound;
+		double _rootTime;
+		std::vector < int > _rootsFound;
+		std::vector < double > _rootSolution;
+
+		//Root search of PerformSolverSteps: lower bound of the search interval and root function values there
+		bool _rootScanValid;
+		double _rootScanTime;
+		std::vector < double > _rootScanValues;
+		std::vector < double > _rootScratchG;
+		std::vector < double > _rootScratchGHigh;
+		std::vector < double > _rootScratchY;
+
+		//Evaluate all root functions at (t, y)
+		SIMMODELSOLVER_EXPORT int EvaluateRootFunctions (double t, const double * y, double * g);
+
+		//-----------------------------------------------------------------------------------------------------
+		//Locate the first root of the root functions in (tlo, thi] (one function changes its sign 
+		//between glo and ghi) by a safeguarded secant method on InterpolateSolution.
+		//tlo and thi must lie within the last internal step. Sets _rootFound, _rootTime, 
+		//_rootsFound, _rootSolution and returns 0 if successful
+		//-----------------------------------------------------------------------------------------------------
+		SIMMODELSOLVER_EXPORT int LocateRoot (double tlo, const double * glo, double thi, const double * ghi);
+
+		//Search the part of the last internal step not yet checked for roots (used by PerformSolverSteps)
+		SIMMODELSOLVER_EXPORT int CheckForRoots ();
+
+		//Report root found by the solver itself (for solvers with own root finding)
+		SIMMODELSOLVER_EXPORT void SetRootFound (double rootTime, const std::vector < int > & rootsFound, const double * y);
+
+		//-----------------------------------------------------------------------------------------------------
+		//PerformSolverStep with root finding for solvers supporting internal steps: integrates to tout by the 
+		//internal steps of PerformSolverSteps and stops at the first root (tret = root time, y/yS at the root).
+		//Solvers MUST call it from PerformSolverStep if GetNumberOfRootFunctions() > 0 
+		//(and have no own root finding); arguments and return value as for PerformSolverStep
+		//-----------------------------------------------------------------------------------------------------
+		SIMMODELSOLVER_EXPORT int PerformSolverStepWithRoots (double tout, double * y, double ** yS, double & tret);
+
+		//scratch memory of PerformSolverStepWithRoots
+		std::vector < double > _rootStepOutputTimes;
+		std::vector < double > _rootStepYS;
+
+		//-----------------------------------------------------------------------------------------------------
+		//Solver statistics (cumulative since Init) and statistics at the start of the last solver step.
+		//Callback counters/timings are filled by the Call... routines below; step related counters 
+		//(error test failures, nonlinear iterations, linear solver setups) must be updated by the solver
+		//-----------------------------------------------------------------------------------------------------
+		SolverStatistics _statistics;
+		SolverStatistics _statisticsAtSolverStepStart;
+		bool _collectCallbackTimings;
+		ISolverStepObserver * _stepObserver;
+
+		//Evaluate RHS/Jacobian of the solver caller and update statistics
+		//(CallODERhsFunction calls CallDDERhsFunction for DDE systems;
+		// CallODEJacFunction computes a finite difference Jacobian if the caller provides none)
+		SIMMODELSOLVER_EXPORT Rhs_Return_Value CallODERhsFunction (double t, const double * y, const double * p, double * ydot, void * f_data);
+		SIMMODELSOLVER_EXPORT Jacobian_Return_Value CallODEJacFunction (double t, const double * y, const double * p, const double * fy, 
+			                                                            double * * Jacobian, void * Jac_data);
+		SIMMODELSOLVER_EXPORT Jacobian_Return_Value CallODESparseJacFunction (double t, const double * y, const double * p, const double * fy, 
+			                                                                  double * values, void * Jac_data);
+
+		//-----------------------------------------------------------------------------------------------------
+		//Jacobian cache for restarts (not owned, see SimModelSolverJacobianCache).
+		//Solvers supporting it look up the Jacobian at their first Jacobian evaluation after Init/ReInit
+		//and store the Jacobians they have evaluated there and before ReInit
+		//-----------------------------------------------------------------------------------------------------
+		SimModelSolverJacobianCache * _jacobianCache;
+		std::vector < double > _jacobianCacheParameters;
+
+		//-----------------------------------------------------------------------------------------------------
+		//Step size profiles for the warm start (not owned, see SimModelSolverStepSizeProfile).
+		//Accepted steps are recorded in _stepSizeProfileRecording (cleared by Init, new segment at ReInit).
+		//Solvers supporting the warm start take step size and order of the first step after Init/ReInit 
+		//from _stepSizeProfile (GetWarmStartStep) and use GetMaxStepSize instead of _hMax
+		//-----------------------------------------------------------------------------------------------------
+		SimModelSolverStepSizeProfile * _stepSizeProfile;
+		SimModelSolverStepSizeProfile * _stepSizeProfileRecording;
+		double _stepSizeProfileMaxStepFactor;
+
+		//Step size and order of the first step after a restart at t0 (returns false if no profile is available)
+		SIMMODELSOLVER_EXPORT bool GetWarmStartStep (double t0, double & h, int & order);
+
+		//Max. step size at time t: _hMax (if > 0), limited to _stepSizeProfileMaxStepFactor * step size of the profile
+		//Returns 0 if there is no limit
+		SIMMODELSOLVER_EXPORT double GetMaxStepSize (double t);
+
+		//MUST be called by the solver at the start of PerformSolverStep (for GetLastSolverStepStatistics)
+		SIMMODELSOLVER_EXPORT void StartSolverStepStatistics ();
+
+		//MUST be called by the solver after every accepted internal step (updates statistics, calls step observer)
+		SIMMODELSOLVER_EXPORT void ReportInternalStep (double t, double h, int order);
+
+		//-----------------------------------------------------------------------------------------------------
+		//Solver specific part of SaveState/RestoreState. 
+		//SaveSolverState MUST append everything needed to continue the integration exactly as without 
+		//the snapshot (current time, y, yS, step size, order, history arrays...); RestoreSolverState 
+		//MUST read it back in the same order, starting at position.
+		//Default implementations throw (snapshots not supported by the solver)
+		//-----------------------------------------------------------------------------------------------------
+		SIMMODELSOLVER_EXPORT virtual void SaveSolverState (SimModelSolverState & state);
+		SIMMODELSOLVER_EXPORT virtual void RestoreSolverState (const SimModelSolverState & state, size_t & position);
+
+		//solver specific state saved by RestoreState before RestoreSolverState (restored again if the snapshot is invalid)
+		SimModelSolverState _solverStateBackup;
+
+		//scratch memory used by PerformSolverStepStrided if output buffers cannot be used directly
+		std::vector < double > _outputScratchY;
+		std::vector < double > _outputScratchYS;
+		std::vector < double * > _outputScratchYSRows;
+
+		//scratch vectors used if the caller provides no batched RHS function
+		std::vector < double > _batchScratchY;
+		std::vector < double > _batchScratchP;
+		std::vector < double > _batchScratchYdot;
+
+		//-----------------------------------------------------------------------------------------------------
+		//Evaluates the RHS function for all problems of the batch (SoA storage, see ISolverCallerBatch).
+		//Uses ODERhsFunctionBatch if available, otherwise calls ODERhsFunction once per problem
+		//Returns the "worst" return value of all problems
+		//-----------------------------------------------------------------------------------------------------
+		SIMMODELSOLVER_EXPORT Rhs_Return_Value CallODERhsFunctionBatch(const double * t, const double * Y, const double * P, 
+			                                                           double * Ydot, void * f_data);
 	
 	public:
 		SIMMODELSOLVER_EXPORT SimModelSolverBase (ISolverCaller * pSolverCaller, int problemSize, int numberOfSensitivityParameters);
@@ -81,11 +497,174 @@ class SimModelSolverBase
 		// - negative value if an unrecoverable error occurred (e.g. illegal input)
 		//-----------------------------------------------------------------------------------------------------
 		SIMMODELSOLVER_EXPORT virtual int PerformSolverStep (double tout, double * y, double ** yS, double & tret) = 0;
+
+		//-----------------------------------------------------------------------------------------------------
+		//Same as PerformSolverStep, but writes the solution directly into caller-supplied strided buffers
+		//(e.g. column k of the final results matrices), so no extra copy of y/yS is required by the caller
+		// - [IN] tout: next time at which a solution is required
+		// - [OUT] y: y_i is stored at y[i * yStride]
+		// - [IN] yStride: distance between two solution components (>= 1)
+		// - [OUT] yS: dy_i/dp_j is stored at yS[i * ySRowStride + j * ySColumnStride]
+		//             (may be NULL if there are no sensitivity parameters)
+		// - [IN] ySRowStride, ySColumnStride: distances between two rows/columns of the sensitivity matrix
+		// - [OUT] tret: time point reached by solver
+		//Return value: as for PerformSolverStep
+		//
+		//Default implementation maps the buffers to PerformSolverStep without copying if yStride = 1 and 
+		//ySColumnStride = 1 (row-major sensitivities); otherwise uses scratch memory. 
+		//Solvers can override it to write any layout directly.
+		//-----------------------------------------------------------------------------------------------------
+		SIMMODELSOLVER_EXPORT virtual int PerformSolverStepStrided (double tout, double * y, int yStride,
+			                                                        double * yS, int ySRowStride, int ySColumnStride, double & tret);
+
+		//-----------------------------------------------------------------------------------------------------
+		//Dense output: get solution at ALL output times in one call.
+		//If the solver supports internal steps (SupportsInternalSteps), it takes its natural steps 
+		//(the output times do not limit the step size) and solutions at the output times are 
+		//interpolated (see InterpolateSolution). Otherwise PerformSolverStep is called for every output time.
+		//
+		//MUST NOT be mixed with PerformSolverStep calls between two Init/ReInit calls.
+		//
+		// - [IN] outputTimes: increasing output times (> current time of the solver)
+		// - [OUT] y: y[k * n + i] = y_i(outputTimes[k]) (n = problem size)
+		// - [OUT] yS: yS[(k * n + i) * NS + j] = dy_i/dp_j(outputTimes[k]) (may be NULL if NS = 0)
+		// - [OUT] numberOfOutputsReached: number of output times for which the solution was computed
+		//Return value: as for PerformSolverStep
+		//-----------------------------------------------------------------------------------------------------
+		SIMMODELSOLVER_EXPORT virtual int PerformSolverSteps (const std::vector < double > & outputTimes, double * y, double * yS, 
+			                                                  int & numberOfOutputsReached);
+
+		//-----------------------------------------------------------------------------------------------------
+		//As PerformSolverSteps, but outputs are passed to the output sink (BeginRun, WriteOutput per output time,
+		//EndRun) as soon as they are computed. Only a chunk of output times is buffered, so memory does not
+		//grow with the number of output times.
+		// - [IN] outputTimes: increasing output times (> current time of the solver)
+		// - [IN] outputSink: receiver of the outputs (output index = index in outputTimes)
+		// - [IN] runIndex: run index passed to the sink
+		// - [OUT] numberOfOutputsReached: number of output times written
+		//Return value: as for PerformSolverStep
+		//-----------------------------------------------------------------------------------------------------
+		SIMMODELSOLVER_EXPORT int PerformSolverStepsToSink (const std::vector < double > & outputTimes, ISolverOutputSink * outputSink,
+			                                                int runIndex, int & numberOfOutputsReached);
+
+		//Returns true if solver implements PerformInternalStep (required for dense output)
+		SIMMODELSOLVER_EXPORT virtual bool SupportsInternalSteps ();
+
+		//-----------------------------------------------------------------------------------------------------
+		//Adjoint sensitivities dG/dp of an objective G(p) = phi(y(T)) + integral_t0^T g(t, y, p) dt
+		//(see ISolverCaller::ODEAdjointRhsFunction/ODEAdjointQuadratureFunction).
+		//Available if the solver supports internal steps and state snapshots and the caller 
+		//provides the adjoint quadrature
+		//-----------------------------------------------------------------------------------------------------
+		SIMMODELSOLVER_EXPORT bool SupportsAdjointSensitivities ();
+
+		//-----------------------------------------------------------------------------------------------------
+		//Integrate forward problem from the initial time to tFinal, storing checkpoints.
+		//MUST be called directly after Init/ReInit
+		// - [IN] tFinal: end time T of the objective
+		// - [OUT] y: y(T) (required by the caller for lambda(T) = (dphi/dy(T))^T)
+		//Return value: as for PerformSolverStep
+		//-----------------------------------------------------------------------------------------------------
+		SIMMODELSOLVER_EXPORT int PerformAdjointForwardPass (double tFinal, double * y);
+
+		//-----------------------------------------------------------------------------------------------------
+		//Integrate adjoint system backward from T to t0 along the internal steps of the forward pass
+		//(trapezoidal rule, A-stable, second order) and return the gradient.
+		//Can be called several times after one forward pass (e.g. for several objectives).
+		//Afterwards the solver is at the state of the end of the forward pass again
+		// - [IN] lambdaFinal: lambda(T) = (dphi/dy(T))^T (n values)
+		// - [OUT] dGdp: integral_t0^T qDot dt (NP values)
+		// - [OUT, OPTIONAL] lambdaInitial: lambda(t0) = dG/dy0 (n values); add lambda(t0)^T dy0/dp to dGdp
+		//                                 if initial values depend on the parameters
+		//Return value: as for PerformSolverStep
+		//-----------------------------------------------------------------------------------------------------
+		SIMMODELSOLVER_EXPORT int ComputeAdjointSensitivities (const double * lambdaFinal, double * dGdp, double * lambdaInitial);
+
+		//-----------------------------------------------------------------------------------------------------
+		//Steady state detection (see CheckSteadyState). Applied by PerformSolverSteps and by solvers
+		//supporting it in PerformSolverStep. Should only be used for autonomous systems without events
+		//(root functions disable the detection in PerformSolverSteps)
+		//-----------------------------------------------------------------------------------------------------
+		SIMMODELSOLVER_EXPORT bool GetSteadyStateDetection ();
+		SIMMODELSOLVER_EXPORT void SetSteadyStateDetection (bool steadyStateDetection);
+
+		//Threshold of the weighted RMS norm of dy/dt (default: 0.01, i.e. y changes by less than 1% of 
+		//its error tolerance per time unit; the criterion depends on the time unit of the model)
+		SIMMODELSOLVER_EXPORT double GetSteadyStateTolerance ();
+		SIMMODELSOLVER_EXPORT void SetSteadyStateTolerance (double steadyStateTolerance);
+
+		//If true, the sensitivities must be stationary as well
+		SIMMODELSOLVER_EXPORT bool GetSteadyStateSensitivities ();
+		SIMMODELSOLVER_EXPORT void SetSteadyStateSensitivities (bool steadyStateSensitivities);
+
+		//True if the steady state was reached since the last Init/ReInit (at GetSteadyStateTime())
+		SIMMODELSOLVER_EXPORT bool SteadyStateReached ();
+		SIMMODELSOLVER_EXPORT double GetSteadyStateTime ();
+
+		//Number of internal steps between two checkpoints of the adjoint forward pass
+		SIMMODELSOLVER_EXPORT int GetAdjointCheckpointInterval ();
+		SIMMODELSOLVER_EXPORT void SetAdjointCheckpointInterval (int adjointCheckpointInterval);
+
+		//-----------------------------------------------------------------------------------------------------
+		//Cubic Hermite interpolation of n-vectors between (t0, y0, f0) and (t1, y1, f1) at time t
+		//(f = dy/dt). Result is stored in y
+		//-----------------------------------------------------------------------------------------------------
+		SIMMODELSOLVER_EXPORT static void HermiteInterpolation (int n, double t0, const double * y0, const double * f0,
+			                                                    double t1, const double * y1, const double * f1, 
+			                                                    double t, double * y);
+
+		//-----------------------------------------------------------------------------------------------------
+		//Event reporting. If the solver caller provides root functions, PerformSolverStep/PerformSolverSteps
+		//stop at the first root found before tout: they return 0 with tret (resp. last output time reached) 
+		//< tout and RootFound() returns true. The solution at the root is available via GetRootSolution.
+		//PerformSolverStep of solvers supporting internal steps stops at the root itself (tret = root time,
+		//see PerformSolverStepWithRoots). For solvers without internal steps, roots are only checked by 
+		//PerformSolverSteps, located between two output times by interpolation of the outputs.
+		//Caller may then change the state and continue integration with ReInit (or just continue 
+		//integration if the event does not change the state).
+		//-----------------------------------------------------------------------------------------------------
+		SIMMODELSOLVER_EXPORT int GetNumberOfRootFunctions ();
+		SIMMODELSOLVER_EXPORT bool RootFound ();
+		SIMMODELSOLVER_EXPORT double GetRootTime ();
+		SIMMODELSOLVER_EXPORT const std::vector < int > & GetRootsFound () const;
+		SIMMODELSOLVER_EXPORT const std::vector < double > & GetRootSolution () const;
+
+		//Cumulative solver statistics since the last call of Init
+		SIMMODELSOLVER_EXPORT const SolverStatistics & GetSolverStatistics () const;
+
+		//Solver statistics of the last PerformSolverStep/PerformSolverSteps call
+		SIMMODELSOLVER_EXPORT SolverStatistics GetLastSolverStepStatistics () const;
+
+		//Measure time spent in the solver caller (default: false, because of the timer overhead)
+		SIMMODELSOLVER_EXPORT bool GetCollectCallbackTimings ();
+		SIMMODELSOLVER_EXPORT void SetCollectCallbackTimings (bool collectCallbackTimings);
+
+		//Set optional observer called after every accepted internal step (NULL = no observer)
+		SIMMODELSOLVER_EXPORT ISolverStepObserver * GetStepObserver ();
+		SIMMODELSOLVER_EXPORT void SetStepObserver (ISolverStepObserver * stepObserver);
+
+		//-----------------------------------------------------------------------------------------------------
+		//Batch mode: get solutions of all problems in the batch at the "next" timepoint.
+		//Only available if SupportsBatchMode() returns true and batch size > 1.
+		//The base class only provides the interface (batch storage, checks, CallODERhsFunctionBatch);
+		//none of the solvers of this library implements batch mode, so Init rejects batch size > 1 for them.
+		// - [IN] tout: next time at which a solution is required
+		// - [OUT] Y: Solution vectors at times tret. Y[i * batchSize + k] = y_i of problem k
+		// - [OUT] YS: Parameter sensitivities. YS[(i * NS + j) * batchSize + k] = dy_i/dp_j of problem k
+		//             (may be NULL if there are no sensitivity parameters)
+		// - [OUT] tret: time points reached by the solver (batchSize values)
+		//Return value: as for PerformSolverStep (the "worst" return value of all problems)
+		//-----------------------------------------------------------------------------------------------------
+		SIMMODELSOLVER_EXPORT virtual int PerformBatchSolverStep (double tout, double * Y, double * YS, double * tret);
+
+		//Returns true if solver can advance several problems together (see PerformBatchSolverStep)
+		SIMMODELSOLVER_EXPORT virtual bool SupportsBatchMode ();
 		
 		//-----------------------------------------------------------------------------------------------------
 		//Reinitialize DE system (e.g. in case of bigger discontinuities). New relative / absolute tolerance should be set by caller prior to ReInit (if required)
 		// - [IN] t0: continue integration from this time point
-		// - [IN] y0: new initial value at t0
+		// - [IN] y0: new initial value at t0 (batch mode: initial values of all problems, 
+		//           y0[i * batchSize + k] = y_i of problem k)
 		//Returns:
 		// - 0 if successful
 		// - positive value if a recoverable error occurred 
@@ -97,6 +676,38 @@ class SimModelSolverBase
 		//-----------------------------------------------------------------------------------------------------
 		SIMMODELSOLVER_EXPORT virtual int ReInit (double t0, const std::vector < double > & y0);
 		
+		//-----------------------------------------------------------------------------------------------------
+		//Snapshot of the complete integrator state (solver history, step size, order, y, yS, dense output 
+		//and root search state, statistics). Allows to integrate a common prefix once and to continue 
+		//from it several times (e.g. with changed parameters or after ReInit), or checkpointing.
+		//Solver properties (tolerances, options, parameter values) are NOT part of the snapshot.
+		//Solver must be initialized. RestoreState requires a snapshot of a solver of the same type 
+		//and with the same problem dimensions; if the snapshot cannot be restored, an exception is thrown
+		//and the solver keeps its state.
+		//-----------------------------------------------------------------------------------------------------
+		SIMMODELSOLVER_EXPORT SimModelSolverState SaveState ();
+
+		//Same as above, reusing the memory of state
+		SIMMODELSOLVER_EXPORT void SaveState (SimModelSolverState & state);
+		SIMMODELSOLVER_EXPORT void RestoreState (const SimModelSolverState & state);
+
+		//Returns true if solver implements SaveSolverState/RestoreSolverState (required for SaveState/RestoreState)
+		SIMMODELSOLVER_EXPORT virtual bool SupportsStateSnapshots ();
+
+		//-----------------------------------------------------------------------------------------------------
+		//Prepare the solver for a new run with the same problem dimensions (solver reuse, see SimModelSolverPool).
+		//Reloads initial time/values, sensitivity parameter values and tolerances set since the last 
+		//Init/ResetForReuse and restarts the integration, but keeps the work memory of the solver.
+		//Can be called instead of Init; if the solver is not initialized yet, it behaves like Init.
+		//
+		//Default implementation: Terminate (if initialized) + Init.
+		//Inherited classes should override it: call SimModelSolverBase::Init() (checks and resets the 
+		//base class state without reallocating) and reset their own state in place.
+		//-----------------------------------------------------------------------------------------------------
+		SIMMODELSOLVER_EXPORT virtual void ResetForReuse ();
+
+		SIMMODELSOLVER_EXPORT bool IsInitialized ();
+
 		//Solver dependent clean up routine (clear memory etc.)
 		SIMMODELSOLVER_EXPORT virtual void Terminate () = 0;
 
@@ -112,6 +723,16 @@ class SimModelSolverBase
 
 		SIMMODELSOLVER_EXPORT int GetDelaysSize ();
 		SIMMODELSOLVER_EXPORT void SetDelaysSize (int delaysSize);
+
+		//Max. delay of the DDE system (history older than that is dropped; 0 = unknown)
+		SIMMODELSOLVER_EXPORT double GetMaxDelay ();
+		SIMMODELSOLVER_EXPORT void SetMaxDelay (double maxDelay);
+
+		//Max. number of stored DDE history points (0 = unlimited; default: 10000)
+		SIMMODELSOLVER_EXPORT int GetMaxNumberOfDelayHistoryPoints ();
+		SIMMODELSOLVER_EXPORT void SetMaxNumberOfDelayHistoryPoints (int maxNumberOfDelayHistoryPoints);
+
+		SIMMODELSOLVER_EXPORT const SimModelSolverDelayHistory & GetDelayHistory () const;
 		SIMMODELSOLVER_EXPORT double GetInitialTime ();
 		SIMMODELSOLVER_EXPORT void SetInitialTime (double initialTime);
 		SIMMODELSOLVER_EXPORT std::vector < double > GetInitialValues ();
@@ -120,6 +741,69 @@ class SimModelSolverBase
 		SIMMODELSOLVER_EXPORT std::vector < double > GetSensitivityParametersInitialValues();
 		SIMMODELSOLVER_EXPORT void SetSensitivityParametersInitialValues(const std::vector < double > & initialValues);
 
+		//-----------------------------------------------------------------------------------------------------
+		//Sensitivity subsets: only the sensitivities of active parameters are integrated (all by default).
+		//Outputs of inactive parameters are 0.
+		//Activation takes effect at the next Init/ResetForReuse (no rebuild of the solver, unlike 
+		//SetNumberOfSensitivityParameters); deactivation also at ReInit and during the run 
+		//(an activated sensitivity must be integrated from the initial time). A parameter activated
+		//on an initialized solver which does not integrate it is reported inactive until then.
+		//Only available if SupportsSensitivityActivation() returns true
+		//-----------------------------------------------------------------------------------------------------
+		SIMMODELSOLVER_EXPORT bool GetSensitivityParameterActive (int sensitivityParameterIndex);
+		SIMMODELSOLVER_EXPORT void SetSensitivityParameterActive (int sensitivityParameterIndex, bool active);
+
+		//Parameters integrated by the solver now (ascending)
+		SIMMODELSOLVER_EXPORT std::vector < int > GetActiveSensitivityParameters ();
+
+		//-----------------------------------------------------------------------------------------------------
+		//Time windows [startTimes[k], endTimes[k]] in which sensitivities are required (empty = whole run).
+		//Outside the windows sensitivity outputs are 0. dy/dp at a time depends on the whole history, so
+		//sensitivities are integrated from the initial time up to the end of the last window and not after it
+		//-----------------------------------------------------------------------------------------------------
+		SIMMODELSOLVER_EXPORT std::vector < double > GetSensitivityTimeWindowStartTimes ();
+		SIMMODELSOLVER_EXPORT std::vector < double > GetSensitivityTimeWindowEndTimes ();
+		SIMMODELSOLVER_EXPORT void SetSensitivityTimeWindows (const std::vector < double > & startTimes, const std::vector < double > & endTimes);
+
+		//Returns true if solver integrates the sensitivities of active parameters only (see SetSensitivityParameterActive)
+		SIMMODELSOLVER_EXPORT virtual bool SupportsSensitivityActivation ();
+
+		//Returns true if the caller provides a sparse Jacobian (sparsity pattern is available after Init)
+		SIMMODELSOLVER_EXPORT bool UseSparseJacobian ();
+		SIMMODELSOLVER_EXPORT Sparse_Matrix_Format GetJacobianSparsityFormat ();
+		SIMMODELSOLVER_EXPORT const std::vector < int > & GetJacobianSparsityIndexPointers () const;
+		SIMMODELSOLVER_EXPORT const std::vector < int > & GetJacobianSparsityIndexValues () const;
+
+		//-----------------------------------------------------------------------------------------------------
+		//Greedy (largest first) coloring of the columns of a sparse n x n matrix in CSC format:
+		//two columns get different colors if they have a nonzero in the same row.
+		//Returns the number of colors; colors[j] = color of column j
+		//-----------------------------------------------------------------------------------------------------
+		SIMMODELSOLVER_EXPORT static int ColorJacobianColumns (int n, const std::vector < int > & columnPointers, 
+			                                                   const std::vector < int > & rowIndices, std::vector < int > & colors);
+
+		//Number of RHS evaluations per finite difference Jacobian (0 if the caller provides the Jacobian). Available after Init
+		SIMMODELSOLVER_EXPORT int GetNumberOfJacobianColors ();
+
+		//Determine sparsity pattern of the finite difference Jacobian by probing (if no sparse/band pattern is available)
+		SIMMODELSOLVER_EXPORT bool GetJacobianSparsityProbing ();
+		SIMMODELSOLVER_EXPORT void SetJacobianSparsityProbing (bool jacobianSparsityProbing);
+
+		SIMMODELSOLVER_EXPORT LinearSolverType GetLinearSolver ();
+		SIMMODELSOLVER_EXPORT void SetLinearSolver (LinearSolverType linearSolver);
+
+		//Returns true if solver implements the linear solver (default: LS_DIRECT only). Init rejects unsupported ones
+		SIMMODELSOLVER_EXPORT virtual bool SupportsLinearSolver (LinearSolverType linearSolver);
+		SIMMODELSOLVER_EXPORT int GetKrylovMaxDimension ();
+		SIMMODELSOLVER_EXPORT void SetKrylovMaxDimension (int krylovMaxDimension);
+
+		SIMMODELSOLVER_EXPORT int GetBatchSize ();
+		SIMMODELSOLVER_EXPORT void SetBatchSize (int batchSize);
+		SIMMODELSOLVER_EXPORT std::vector < double > GetBatchInitialValues ();
+		SIMMODELSOLVER_EXPORT void SetBatchInitialValues (const std::vector < double > & batchInitialValues);
+		SIMMODELSOLVER_EXPORT std::vector < double > GetBatchSensitivityParametersInitialValues ();
+		SIMMODELSOLVER_EXPORT void SetBatchSensitivityParametersInitialValues (const std::vector < double > & batchInitialValues);
+
 		SIMMODELSOLVER_EXPORT double GetRelTol ();
 		SIMMODELSOLVER_EXPORT void SetRelTol (double relTol);
 		SIMMODELSOLVER_EXPORT std::vector < double > GetAbsTol ();
@@ -134,6 +818,34 @@ class SimModelSolverBase
 		SIMMODELSOLVER_EXPORT double GetHMax ();
 		SIMMODELSOLVER_EXPORT void SetHMax (double hMax);
 
+		//Jacobian cache shared e.g. by the solvers of all population members (NULL = no cache)
+		SIMMODELSOLVER_EXPORT SimModelSolverJacobianCache * GetJacobianCache ();
+		SIMMODELSOLVER_EXPORT void SetJacobianCache (SimModelSolverJacobianCache * jacobianCache);
+
+		//-----------------------------------------------------------------------------------------------------
+		//Values of model parameters which change the Jacobian but are no sensitivity parameters
+		//(e.g. parameters of the individual). Parameters compared by the validity policy of the Jacobian
+		//cache are the sensitivity parameter values followed by these values
+		//-----------------------------------------------------------------------------------------------------
+		SIMMODELSOLVER_EXPORT std::vector < double > GetJacobianCacheParameters ();
+		SIMMODELSOLVER_EXPORT void SetJacobianCacheParameters (const std::vector < double > & parameters);
+
+		//-----------------------------------------------------------------------------------------------------
+		//Warm start from the step size profile of a reference run of the same model (NULL = no warm start):
+		//initial step size (and order) after Init/ReInit and max. step size schedule are taken from the profile.
+		//The profile is only read, so one profile can be used by many solvers at the same time
+		//-----------------------------------------------------------------------------------------------------
+		SIMMODELSOLVER_EXPORT SimModelSolverStepSizeProfile * GetStepSizeProfile ();
+		SIMMODELSOLVER_EXPORT void SetStepSizeProfile (SimModelSolverStepSizeProfile * stepSizeProfile);
+
+		//Record the accepted steps of the next runs (NULL = no recording); must differ from the warm start profile
+		SIMMODELSOLVER_EXPORT SimModelSolverStepSizeProfile * GetStepSizeProfileRecording ();
+		SIMMODELSOLVER_EXPORT void SetStepSizeProfileRecording (SimModelSolverStepSizeProfile * stepSizeProfile);
+
+		//Max. step size = factor * step size of the reference run (default 10; 0 = max. step size not limited by the profile)
+		SIMMODELSOLVER_EXPORT double GetStepSizeProfileMaxStepFactor ();
+		SIMMODELSOLVER_EXPORT void SetStepSizeProfileMaxStepFactor (double maxStepFactor);
+
 		SIMMODELSOLVER_EXPORT virtual SimModelSolverErrorData::errNumber GetErrorNumberFromSolverReturnValue(int solverRetVal)=0;
 };
 
@@ -0,0 +1,96 @@
+#ifndef _SimModelSolverDelayHistory_H_
+#define _SimModelSolverDelayHistory_H_
+
+#include <vector>
+#include "SimModelSolverBase/SimModelSolverErrorData.h"
+#include "SimModelSolverBase/SimModelSolverState.h"
+
+//-------------------------------------------------------------------------
+//Solution history of a DDE system (see SimModelSolverBase::CallDDERhsFunction).
+//
+//Stores (t, y, dy/dt) of the accepted step points in a ring buffer.
+//Points which are older than the max. delay are dropped when new points
+//are added, so memory stays bounded for long simulations (0 = keep all).
+//The buffer grows on demand up to the max. number of points.
+//
+//Delayed values are computed by cubic Hermite interpolation; the step
+//interval is found by checking the interval of the previous lookup first
+//and by binary search otherwise.
+//Before the first point, the solution is assumed to be constant (= initial
+//values). After the last point, the last interval is extrapolated.
+//-------------------------------------------------------------------------
+
+class SimModelSolverDelayHistory
+{
+	protected:
+		int _problemSize;
+
+		//max. delay (0 = unknown, all points are kept)
+		double _maxDelay;
+
+		//max. number of stored points (0 = unlimited)
+		int _maxNumberOfPoints;
+
+		//ring buffer: logical point k is stored at physical index (_first + k) % _capacity
+		int _capacity;
+		int _first;
+		int _numberOfPoints;
+		std::vector < double > _times;
+		std::vector < double > _values;
+		std::vector < double > _derivatives;
+
+		//true if points were dropped (history before the first point is not available anymore)
+		bool _truncated;
+
+		//logical index of the interval found by the previous lookup
+		int _lastInterval;
+
+		int PhysicalIndex (int k) const;
+		double TimeAt (int k) const;
+
+		//increase capacity (keeps stored points)
+		void Grow ();
+
+		//logical index k of the interval [t_k, t_k+1] containing t (-1 if t is before the first point)
+		int FindInterval (double t);
+
+		//y(t) = c[0] * y_idx0 + c[1] * f_idx0 + c[2] * y_idx1 + c[3] * f_idx1 (physical indices of the stored points)
+		void InterpolationCoefficients (double t, int & idx0, int & idx1, double * coefficients);
+
+	public:
+		SIMMODELSOLVER_EXPORT SimModelSolverDelayHistory ();
+
+		//Remove all points and set dimension and limits of the history
+		SIMMODELSOLVER_EXPORT void Init (int problemSize, double maxDelay, int maxNumberOfPoints);
+		SIMMODELSOLVER_EXPORT void Clear ();
+
+		//-----------------------------------------------------------------------------------------------------
+		//Append accepted step point (t must not be before the last point; a point at the same time replaces it).
+		//Drops all points which are not needed anymore for t - maxDelay.
+		//Throws an exception if the max. number of points would be exceeded
+		//-----------------------------------------------------------------------------------------------------
+		SIMMODELSOLVER_EXPORT void AddPoint (double t, const double * y, const double * ydot);
+
+		//Remove all points after t (e.g. if the solver restarts from an earlier time)
+		SIMMODELSOLVER_EXPORT void RemovePointsAfter (double t);
+
+		SIMMODELSOLVER_EXPORT int GetNumberOfPoints () const;
+		SIMMODELSOLVER_EXPORT int GetCapacity () const;
+		SIMMODELSOLVER_EXPORT double GetFirstTime () const;
+		SIMMODELSOLVER_EXPORT double GetLastTime () const;
+
+		//Solution at time t (n values)
+		SIMMODELSOLVER_EXPORT void Interpolate (double t, double * y);
+
+		//-----------------------------------------------------------------------------------------------------
+		//Solution at all delayed times in one pass: yd[i][j] = y_i(delayTimes[j])
+		//(one interval lookup per delay, layout as expected by ISolverCaller::DDERhsFunction)
+		//-----------------------------------------------------------------------------------------------------
+		SIMMODELSOLVER_EXPORT void InterpolateDelays (int numberOfDelays, const double * delayTimes, double * * yd);
+
+		//Append the history to/read it from a solver state snapshot
+		SIMMODELSOLVER_EXPORT void SaveState (SimModelSolverState & state) const;
+		SIMMODELSOLVER_EXPORT void RestoreState (const SimModelSolverState & state, size_t & position);
+};
+
+#endif //_SimModelSolverDelayHistory_H_
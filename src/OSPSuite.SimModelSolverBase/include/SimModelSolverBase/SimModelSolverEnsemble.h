@@ -0,0 +1,139 @@
+#ifndef _SimModelSolverEnsemble_H_
+#define _SimModelSolverEnsemble_H_
+
+#include <vector>
+#include <string>
+#include "SimModelSolverBase/SimModelSolverBase.h"
+#include "SimModelSolverBase/SimModelSolverFactory.h"
+#include "SimModelSolverBase/SimModelSolverErrorData.h"
+#include "SimModelSolverBase/SolverOutputSink.h"
+#include "SimModelSolverBase/SimModelSolverResultCache.h"
+
+//queue of run indices processed by one worker thread (defined in SimModelSolverEnsemble.cpp)
+class EnsembleWorkQueue;
+
+//-------------------------------------------------------------------------
+//Runs an ensemble of simulations (population, parameter scan, ...)
+//on a pool of worker threads.
+//
+//Every worker gets ONE solver created by the factory and reuses it for all runs
+//it processes (SetInitialValues/SetSensitivityParametersInitialValues, ResetForReuse,
+//PerformSolverStep for all output times). Solvers are terminated after a failed
+//run and before they are released.
+//Runs are distributed in contiguous blocks to the workers; idle workers
+//steal runs from the back of the queues of other workers.
+//
+//Errors are captured per run and do not stop the remaining runs.
+//-------------------------------------------------------------------------
+
+class SimModelSolverEnsemble
+{
+	private:
+		ISimModelSolverFactory * _solverFactory;
+
+		//number of worker threads (0 = number of hardware threads)
+		int _numberOfThreads;
+
+		std::vector < double > _outputTimes;
+
+		std::vector < std::vector < double > > _initialValues;
+		std::vector < std::vector < double > > _sensitivityParametersValues;
+
+		//error of every run (err_OK if run was successful)
+		std::vector < SimModelSolverErrorData > _runErrors;
+
+		int _problemSize;
+		int _numberOfSensitivityParameters;
+
+		//optional cache of run results (not owned)
+		SimModelSolverResultCache * _resultCache;
+		std::string _resultCacheModelIdentifier;
+
+		//optional Jacobian cache passed to all solvers (not owned)
+		SimModelSolverJacobianCache * _jacobianCache;
+
+		//optional step size profile for the warm start of all solvers (not owned)
+		SimModelSolverStepSizeProfile * _stepSizeProfile;
+
+		//write result of a run taken from the result cache to the output buffers or to the output sink
+		void WriteCachedResult (int runIndex, const std::vector < double > & cachedSolution, const std::vector < double > & cachedSensitivities,
+			                    double * solution, double * sensitivities, ISolverOutputSink * outputSink);
+
+		//outputs are written either to the buffers (solution, sensitivities) or to the output sink
+		int RunAll (double * solution, double * sensitivities, ISolverOutputSink * outputSink);
+
+		void RunSingle (SimModelSolverBase * solver, int runIndex, double * solution, double * sensitivities, ISolverOutputSink * outputSink);
+
+		void WorkerThread (SimModelSolverBase * solver, int workerIndex, std::vector < EnsembleWorkQueue * > & workQueues, 
+			               double * solution, double * sensitivities, ISolverOutputSink * outputSink);
+
+	public:
+		SIMMODELSOLVER_EXPORT SimModelSolverEnsemble (ISimModelSolverFactory * solverFactory, int numberOfThreads = 0);
+		SIMMODELSOLVER_EXPORT virtual ~SimModelSolverEnsemble ();
+
+		SIMMODELSOLVER_EXPORT int GetNumberOfThreads ();
+		SIMMODELSOLVER_EXPORT void SetNumberOfThreads (int numberOfThreads);
+
+		SIMMODELSOLVER_EXPORT std::vector < double > GetOutputTimes ();
+		SIMMODELSOLVER_EXPORT void SetOutputTimes (const std::vector < double > & outputTimes);
+
+		//Add new run; returns the index of the run
+		SIMMODELSOLVER_EXPORT int AddRun (const std::vector < double > & initialValues,
+			                              const std::vector < double > & sensitivityParametersValues);
+		SIMMODELSOLVER_EXPORT int GetNumberOfRuns ();
+		SIMMODELSOLVER_EXPORT void ClearRuns ();
+
+		//-----------------------------------------------------------------------------------------------------
+		//Query problem dimensions from the factory (creates and releases one solver instance).
+		//Required to preallocate the output buffers passed to Run
+		//-----------------------------------------------------------------------------------------------------
+		SIMMODELSOLVER_EXPORT void GetProblemDimensions (int & problemSize, int & numberOfSensitivityParameters);
+
+		//-----------------------------------------------------------------------------------------------------
+		//Perform all runs.
+		// - [OUT] solution: preallocated buffer of size NumberOfRuns * NumberOfOutputTimes * ProblemSize
+		//                   solution[(run * NumberOfOutputTimes + k) * ProblemSize + i] = y_i(t_k) of run
+		// - [OUT] sensitivities: preallocated buffer of size NumberOfRuns * NumberOfOutputTimes * ProblemSize * NS
+		//                   sensitivities[((run * NumberOfOutputTimes + k) * ProblemSize + i) * NS + j] = dy_i/dp_j(t_k)
+		//                   (may be NULL if there are no sensitivity parameters)
+		//Outputs of failed runs are set to NaN from the first failed output time on
+		//Returns the number of failed runs (see GetRunError)
+		//-----------------------------------------------------------------------------------------------------
+		SIMMODELSOLVER_EXPORT int Run (double * solution, double * sensitivities);
+
+		//-----------------------------------------------------------------------------------------------------
+		//Perform all runs and stream the outputs to the output sink as soon as they are computed
+		//(e.g. SimModelSolverMappedFileSink), so the results of all runs need not fit into memory.
+		//The sink is called concurrently by the worker threads (for different runs).
+		//Outputs of a failed run are written up to the last successful output time; EndRun is called with success = false
+		//Returns the number of failed runs (see GetRunError)
+		//-----------------------------------------------------------------------------------------------------
+		SIMMODELSOLVER_EXPORT int Run (ISolverOutputSink * outputSink);
+
+		SIMMODELSOLVER_EXPORT const SimModelSolverErrorData & GetRunError (int runIndex) const;
+
+		//-----------------------------------------------------------------------------------------------------
+		//Use result cache (NULL = no cache): runs whose inputs equal those of a cached result are not
+		//integrated; results of successful runs are stored.
+		// - [IN] modelIdentifier: identifies the model and all solver options which are not part of the
+		//                         cache key (see SimModelSolverResultCacheKey)
+		//-----------------------------------------------------------------------------------------------------
+		SIMMODELSOLVER_EXPORT void SetResultCache (SimModelSolverResultCache * resultCache, const std::string & modelIdentifier);
+		SIMMODELSOLVER_EXPORT SimModelSolverResultCache * GetResultCache ();
+
+		//-----------------------------------------------------------------------------------------------------
+		//Use Jacobian cache in all solvers (NULL = caches set by the solver factory are kept):
+		//runs start with the Jacobian of a previous run with similar parameters
+		//-----------------------------------------------------------------------------------------------------
+		SIMMODELSOLVER_EXPORT void SetJacobianCache (SimModelSolverJacobianCache * jacobianCache);
+		SIMMODELSOLVER_EXPORT SimModelSolverJacobianCache * GetJacobianCache ();
+
+		//-----------------------------------------------------------------------------------------------------
+		//Warm start all solvers from the step size profile of a reference run (NULL = profiles set by the
+		//solver factory are kept). The profile must be recorded before Run, e.g. by a single solver
+		//-----------------------------------------------------------------------------------------------------
+		SIMMODELSOLVER_EXPORT void SetStepSizeProfile (SimModelSolverStepSizeProfile * stepSizeProfile);
+		SIMMODELSOLVER_EXPORT SimModelSolverStepSizeProfile * GetStepSizeProfile ();
+};
+
+#endif //_SimModelSolverEnsemble_H_
@@ -0,0 +1,30 @@
+#ifndef _SimModelSolverFactory_H_
+#define _SimModelSolverFactory_H_
+
+#include "SimModelSolverBase/SimModelSolverBase.h"
+
+//-------------------------------------------------------------------------
+//Factory for solver instances used by drivers which run more than one
+//simulation (e.g. SimModelSolverEnsemble).
+//Every solver created must come with its own solver caller instance,
+//because solvers created by the same factory may run concurrently.
+//-------------------------------------------------------------------------
+
+class ISimModelSolverFactory
+{
+	public:
+		virtual ~ISimModelSolverFactory () {}
+
+		//-----------------------------------------------------------------------------------------------------
+		//Create new solver instance together with its solver caller.
+		//All solvers created by one factory must have the same problem size and number of sensitivity parameters
+		//Solver tolerances and options must be set by the factory; initial values and
+		//sensitivity parameter values are set by the driver for every run
+		//-----------------------------------------------------------------------------------------------------
+		virtual SimModelSolverBase * CreateSolver () = 0;
+
+		//Release solver instance (and its solver caller) created by CreateSolver
+		virtual void ReleaseSolver (SimModelSolverBase * solver) = 0;
+};
+
+#endif //_SimModelSolverFactory_H_
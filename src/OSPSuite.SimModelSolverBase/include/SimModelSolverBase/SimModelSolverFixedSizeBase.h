@@ -0,0 +1,211 @@
+#ifndef _SimModelSolverFixedSizeBase_H_
+#define _SimModelSolverFixedSizeBase_H_
+
+#include <cmath>
+#include <cstddef>
+#include <algorithm>
+#include "SimModelSolverBase/SimModelSolverStaticBase.h"
+
+//-------------------------------------------------------------------------
+//Vector of compile-time size, stored inline and aligned for SIMD
+//(64 bytes: AVX-512 register / cache line)
+//-------------------------------------------------------------------------
+template < int N >
+struct alignas(64) FixedSizeVector
+{
+	double Values[N];
+
+	double & operator[] (int i)
+	{
+		return Values[i];
+	}
+
+	const double & operator[] (int i) const
+	{
+		return Values[i];
+	}
+
+	double * Data ()
+	{
+		return Values;
+	}
+
+	const double * Data () const
+	{
+		return Values;
+	}
+};
+
+//-------------------------------------------------------------------------
+//Solver base for small problems whose problem size N and number of
+//sensitivity parameters NS are known at compile time.
+//
+//Initial values, absolute tolerances and sensitivity parameter values are
+//mirrored into aligned inline storage in Init/ReInit (so tolerances and
+//parameter values set between runs take effect with the next ReInit), and the fixed size
+//vector kernels below have compile-time trip counts (fully unrolled/vectorized
+//by the compiler). Solvers should keep their own work vectors as
+//FixedSizeVector members, so that no heap allocation happens after Init
+//(ReInit with a pointer to the new initial values does not allocate).
+//
+//Instances created with new are aligned by the aligned operator new of C++17.
+//-------------------------------------------------------------------------
+template < class TCaller, int N, int NS >
+class SimModelSolverFixedSizeBase : public SimModelSolverStaticBase < TCaller >
+{
+	static_assert(N > 0, "Problem size must be > 0");
+	static_assert(NS >= 0, "Number of sensitivity parameters must be >= 0");
+
+	typedef SimModelSolverStaticBase < TCaller > BaseType;
+
+	public:
+		enum
+		{
+			ProblemSize = N,
+			NumberOfSensitivityParameters = NS
+		};
+
+		typedef FixedSizeVector < N > StateVector;
+
+		//(at least one element, so that the type is valid for NS = 0)
+		typedef FixedSizeVector < (NS > 0 ? NS : 1) > ParameterVector;
+
+	protected:
+		StateVector _fixedInitialValues;
+		StateVector _fixedAbsTol;
+		ParameterVector _fixedSensitivityParametersInitialValues;
+
+		void CopyToFixedStorage ()
+		{
+			const char * ERROR_SOURCE = "SimModelSolverFixedSizeBase::CopyToFixedStorage";
+
+			//tolerances and parameter values can be set again after Init
+			if ((this->_absTol.size() != (size_t)N) || (this->_sensitivityParametersInitialValues.size() != (size_t)NS))
+				throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE,
+				                              "Absolute tolerance or sensitivity parameter values have invalid number of components");
+
+			std::copy(this->_initialValues.begin(), this->_initialValues.end(), _fixedInitialValues.Values);
+			std::copy(this->_absTol.begin(), this->_absTol.end(), _fixedAbsTol.Values);
+			std::copy(this->_sensitivityParametersInitialValues.begin(), this->_sensitivityParametersInitialValues.end(),
+				      _fixedSensitivityParametersInitialValues.Values);
+		}
+
+	public:
+		SimModelSolverFixedSizeBase (TCaller * pSolverCaller)
+			: BaseType(pSolverCaller, N, NS)
+		{
+		}
+
+		//-----------------------------------------------------------------------------------------------------
+		//Checks the problem dimensions and fills the inline storage.
+		//Inherited classes must call it first in their Init (as for SimModelSolverBase::Init)
+		//-----------------------------------------------------------------------------------------------------
+		virtual void Init ()
+		{
+			const char * ERROR_SOURCE = "SimModelSolverFixedSizeBase::Init";
+
+			if ((this->_problemSize != N) || (this->_numberOfSensitivityParameters != NS))
+				throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE,
+				                              "Problem size or number of sensitivity parameters differs from the template arguments");
+
+			if (this->_batchSize > 1)
+				throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Batch mode is not supported by fixed size solvers");
+
+			BaseType::Init();
+
+			CopyToFixedStorage();
+		}
+
+		virtual int ReInit (double t0, const std::vector < double > & y0)
+		{
+			int retVal = BaseType::ReInit(t0, y0);
+			if (retVal != SimModelSolverErrorData::err_OK)
+				return retVal;
+
+			//tolerances and parameter values may have been changed since Init
+			CopyToFixedStorage();
+
+			return retVal;
+		}
+
+		//-----------------------------------------------------------------------------------------------------
+		//ReInit without heap allocation (y0: N values).
+		//Calls the (virtual) ReInit of the solver with the internally stored initial values.
+		//Solvers overriding ReInit must make this overload visible again (using ...::ReInit)
+		//-----------------------------------------------------------------------------------------------------
+		int ReInit (double t0, const double * y0)
+		{
+			const char * ERROR_SOURCE = "SimModelSolverFixedSizeBase::ReInit";
+
+			if (!this->_initialized)
+				throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Solver was not initialized");
+
+			std::copy(y0, y0 + N, this->_initialValues.begin());
+
+			return this->ReInit(t0, this->_initialValues);
+		}
+
+		const StateVector & GetFixedInitialValues () const
+		{
+			return _fixedInitialValues;
+		}
+
+		const StateVector & GetFixedAbsTol () const
+		{
+			return _fixedAbsTol;
+		}
+
+		const ParameterVector & GetFixedSensitivityParametersInitialValues () const
+		{
+			return _fixedSensitivityParametersInitialValues;
+		}
+
+		//---- vector kernels with compile-time size N ----
+
+		//y = x
+		static inline void Copy (const double * x, double * y)
+		{
+			for (int i = 0; i < N; i++)
+				y[i] = x[i];
+		}
+
+		//y = a * x + y
+		static inline void Axpy (double a, const double * x, double * y)
+		{
+			for (int i = 0; i < N; i++)
+				y[i] += a * x[i];
+		}
+
+		//z = a * x + b * y
+		static inline void LinearSum (double a, const double * x, double b, const double * y, double * z)
+		{
+			for (int i = 0; i < N; i++)
+				z[i] = a * x[i] + b * y[i];
+		}
+
+		//x = a * x
+		static inline void Scale (double a, double * x)
+		{
+			for (int i = 0; i < N; i++)
+				x[i] *= a;
+		}
+
+		//error weights w_i = 1 / (relTol * |y_i| + absTol_i)
+		inline void ErrorWeights (const double * y, double * w) const
+		{
+			for (int i = 0; i < N; i++)
+				w[i] = 1.0 / (this->_relTol * fabs(y[i]) + _fixedAbsTol.Values[i]);
+		}
+
+		//weighted root mean square norm sqrt(sum (v_i * w_i)^2 / N)
+		static inline double WeightedRmsNorm (const double * v, const double * w)
+		{
+			double sum = 0.0;
+			for (int i = 0; i < N; i++)
+				sum += (v[i] * w[i]) * (v[i] * w[i]);
+
+			return sqrt(sum / N);
+		}
+};
+
+#endif //_SimModelSolverFixedSizeBase_H_
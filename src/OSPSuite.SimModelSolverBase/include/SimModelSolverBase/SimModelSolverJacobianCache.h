@@ -0,0 +1,117 @@
+#ifndef _SimModelSolverJacobianCache_H_
+#define _SimModelSolverJacobianCache_H_
+
+#include <list>
+#include <vector>
+#include <string>
+#include <mutex>
+#include "SimModelSolverBase/SimModelSolverErrorData.h"
+
+//-------------------------------------------------------------------------
+//Jacobian (and factorization of the iteration matrix) of a solver at one
+//point of time, as stored in SimModelSolverJacobianCache.
+//
+//Layout of Jacobian and Factorization is defined by the solver which
+//stored the entry; Structure identifies solver type and layout, so entries
+//are only used by solvers with the same structure.
+//-------------------------------------------------------------------------
+
+class SimModelSolverJacobianCacheEntry
+{
+	public:
+		std::string Structure;
+
+		double Time;
+
+		//parameters the Jacobian was evaluated with (see SimModelSolverBase::GetJacobianCacheParameters)
+		std::vector < double > Parameters;
+
+		std::vector < double > Jacobian;
+
+		//factorization of I - FactorizationScale * J (empty if not available)
+		double FactorizationScale;
+		std::vector < double > Factorization;
+		std::vector < int > Pivots;
+
+		//step size the factorization was computed for
+		double StepSize;
+
+		SIMMODELSOLVER_EXPORT SimModelSolverJacobianCacheEntry ();
+};
+
+//-------------------------------------------------------------------------
+//Cache of Jacobians for restarts of the integration: after ReInit (e.g. at
+//dose events) and at the start of further population members, solvers take
+//the Jacobian (and, if the step size matches, the factorization) from the
+//cache instead of evaluating it again.
+//
+//A cached Jacobian is only an approximation at the new point; it is used for
+//the first step(s) after the restart only, so its validity is limited by
+//  - time distance:               |t - t_entry| <= MaxTimeDistance
+//  - relative parameter distance: max_j |p_j - p_entry_j| / max(|p_j|, |p_entry_j|) <= MaxParameterDistance
+//Of all valid entries the one nearest in time is used.
+//
+//Can be shared by several solvers with the same structure (thread safe).
+//Oldest entries are dropped when the memory limit is exceeded.
+//-------------------------------------------------------------------------
+
+class SimModelSolverJacobianCache
+{
+	private:
+		struct CacheEntry
+		{
+			SimModelSolverJacobianCacheEntry Data;
+			size_t MemorySize;
+		};
+
+		//most recently stored or used entry first
+		std::list < CacheEntry > _entries;
+
+		double _maxTimeDistance;
+		double _maxParameterDistance;
+
+		size_t _maxMemorySize;
+		size_t _memorySize;
+
+		long _numberOfHits;
+		long _numberOfMisses;
+
+		std::mutex _mutex;
+
+		bool IsValid (const SimModelSolverJacobianCacheEntry & entry, const std::string & structure, double t,
+			          const std::vector < double > & parameters, double & timeDistance);
+		void EvictEntries ();
+
+	public:
+		SIMMODELSOLVER_EXPORT SimModelSolverJacobianCache (size_t maxMemorySize = 64 * 1024 * 1024);
+
+		//-----------------------------------------------------------------------------------------------------
+		//Get valid entry nearest to time t
+		//Returns false if there is no valid entry
+		//-----------------------------------------------------------------------------------------------------
+		SIMMODELSOLVER_EXPORT bool Lookup (const std::string & structure, double t, const std::vector < double > & parameters,
+			                               SimModelSolverJacobianCacheEntry & entry);
+
+		//-----------------------------------------------------------------------------------------------------
+		//Store entry (replaces an entry of the same structure with the same time and parameters)
+		//-----------------------------------------------------------------------------------------------------
+		SIMMODELSOLVER_EXPORT void Store (const SimModelSolverJacobianCacheEntry & entry);
+
+		SIMMODELSOLVER_EXPORT void Clear ();
+
+		//validity policy (default: no time limit, 10% parameter distance)
+		SIMMODELSOLVER_EXPORT double GetMaxTimeDistance ();
+		SIMMODELSOLVER_EXPORT void SetMaxTimeDistance (double maxTimeDistance);
+		SIMMODELSOLVER_EXPORT double GetMaxParameterDistance ();
+		SIMMODELSOLVER_EXPORT void SetMaxParameterDistance (double maxParameterDistance);
+
+		SIMMODELSOLVER_EXPORT size_t GetMaxMemorySize ();
+		SIMMODELSOLVER_EXPORT void SetMaxMemorySize (size_t maxMemorySize);
+		SIMMODELSOLVER_EXPORT size_t GetMemorySize ();
+		SIMMODELSOLVER_EXPORT int GetNumberOfEntries ();
+
+		SIMMODELSOLVER_EXPORT long GetNumberOfHits ();
+		SIMMODELSOLVER_EXPORT long GetNumberOfMisses ();
+};
+
+#endif //_SimModelSolverJacobianCache_H_
@@ -0,0 +1,133 @@
+#ifndef _SimModelSolverMappedFileSink_H_
+#define _SimModelSolverMappedFileSink_H_
+
+#include <vector>
+#include <string>
+#include <mutex>
+#include "SimModelSolverBase/SimModelSolverErrorData.h"
+#include "SimModelSolverBase/SolverOutputSink.h"
+
+//-------------------------------------------------------------------------
+//Output sink writing all runs into ONE binary file through memory mapping.
+//Only the blocks of the runs currently written are mapped, so memory stays
+//bounded independent of the number of runs. The file is preallocated for all
+//runs when it is opened and cut to the blocks written when it is closed.
+//
+//File layout (native byte order, all offsets in bytes from the file start):
+//  Header (64 bytes):
+//    char[8]  magic "OSPTRAJ1"
+//    int32    format version (1)
+//    int32    sensitivity storage (0 = double, 1 = float)
+//    int64    number of runs R
+//    int64    number of output times K
+//    int64    problem size n
+//    int64    number of sensitivity parameters NS
+//    int64    offset of the output times (K doubles)
+//    int64    offset of the run table (R entries)
+//  Run table entry (16 bytes):
+//    int64    offset of the run block (-1 if the run was not written)
+//    int32    status (0 = not written, 1 = running, 2 = finished, 3 = failed)
+//    int32    number of outputs written
+//  Run blocks (appended in the order the runs were started, 8 byte aligned):
+//    K x n doubles         y_i(t_k) at [k * n + i]
+//    K x n x NS values     dy_i/dp_j(t_k) at [(k * n + i) * NS + j] (double or float)
+//-------------------------------------------------------------------------
+
+class SimModelSolverMappedFileSink : public ISolverOutputSink
+{
+	public:
+		enum SensitivityStorage
+		{
+			SENSITIVITIES_DOUBLE = 0,
+			SENSITIVITIES_FLOAT = 1
+		};
+
+		enum RunStatus
+		{
+			RUN_NOT_WRITTEN = 0,
+			RUN_RUNNING = 1,
+			RUN_FINISHED = 2,
+			RUN_FAILED = 3
+		};
+
+	protected:
+		//mapped part of the file
+		struct MappedRegion
+		{
+			void * MappingStart;
+			size_t MappingSize;
+			unsigned char * Data;
+		};
+
+		std::string _fileName;
+		bool _isOpen;
+
+		int _numberOfRuns;
+		int _numberOfOutputTimes;
+		int _problemSize;
+		int _numberOfSensitivityParameters;
+		SensitivityStorage _sensitivityStorage;
+
+		long long _runTableOffset;
+		long long _dataOffset;
+		long long _runBlockSize;
+
+		//number of run blocks appended
+		long long _numberOfRunBlocks;
+
+		//file size (blocks of all runs are preallocated by Open: on Windows, a file cannot be 
+		//resized while views of it are mapped)
+		long long _fileSize;
+
+		//header, output times and run table (mapped while the file is open)
+		MappedRegion _headerRegion;
+
+		//block of every run (mapped between BeginRun and EndRun)
+		std::vector < MappedRegion > _runRegions;
+
+#ifdef _WINDOWS
+		void * _fileHandle;
+#else
+		int _fileDescriptor;
+#endif
+
+		std::mutex _mutex;
+
+		//map [offset, offset + size) of the file (must be within _fileSize)
+		void MapRegion (long long offset, long long size, MappedRegion & region);
+		void UnmapRegion (MappedRegion & region);
+
+		void SetRunTableEntry (int runIndex, long long offset, int status, int numberOfOutputsWritten);
+		void CheckRunIndex (int runIndex, const char * errorSource);
+
+	public:
+		SIMMODELSOLVER_EXPORT SimModelSolverMappedFileSink ();
+
+		//closes the file
+		SIMMODELSOLVER_EXPORT virtual ~SimModelSolverMappedFileSink ();
+
+		//-----------------------------------------------------------------------------------------------------
+		//Create (or overwrite) the result file
+		// - [IN] sensitivityStorage: SENSITIVITIES_FLOAT halves the size of the sensitivities
+		//                            (relative precision approx. 1e-7, values beyond +-3.4e38 become +-inf)
+		//-----------------------------------------------------------------------------------------------------
+		SIMMODELSOLVER_EXPORT void Open (const std::string & fileName, int numberOfRuns, const std::vector < double > & outputTimes,
+			                             int problemSize, int numberOfSensitivityParameters,
+			                             SensitivityStorage sensitivityStorage = SENSITIVITIES_DOUBLE);
+
+		//Flush and close the file (all runs must have been ended)
+		SIMMODELSOLVER_EXPORT void Close ();
+
+		SIMMODELSOLVER_EXPORT bool IsOpen ();
+		SIMMODELSOLVER_EXPORT const std::string & GetFileName () const;
+
+		//Size of the file written so far [bytes]
+		SIMMODELSOLVER_EXPORT long long GetFileSize ();
+
+		//ISolverOutputSink
+		SIMMODELSOLVER_EXPORT virtual void BeginRun (int runIndex);
+		SIMMODELSOLVER_EXPORT virtual void WriteOutput (int runIndex, int outputIndex, double t, const double * y, const double * yS);
+		SIMMODELSOLVER_EXPORT virtual void EndRun (int runIndex, bool success);
+};
+
+#endif //_SimModelSolverMappedFileSink_H_
@@ -0,0 +1,103 @@
+#ifndef _SimModelSolverPool_H_
+#define _SimModelSolverPool_H_
+
+#include <map>
+#include <vector>
+#include <utility>
+#include <mutex>
+#include "SimModelSolverBase/SimModelSolverBase.h"
+#include "SimModelSolverBase/SimModelSolverFactory.h"
+
+//-------------------------------------------------------------------------
+//Structure of the problems a pooled solver can be reused for
+//(half band widths are -1 if the solver caller does not use a band solver)
+//-------------------------------------------------------------------------
+
+class SimModelSolverPoolKey
+{
+	public:
+		int ProblemSize;
+		int NumberOfSensitivityParameters;
+		int LowerHalfBandWidth;
+		int UpperHalfBandWidth;
+
+		SIMMODELSOLVER_EXPORT SimModelSolverPoolKey ();
+		SIMMODELSOLVER_EXPORT SimModelSolverPoolKey (int problemSize, int numberOfSensitivityParameters,
+			                                         int lowerHalfBandWidth = -1, int upperHalfBandWidth = -1);
+
+		//key of an existing solver (band widths are queried from its solver caller)
+		SIMMODELSOLVER_EXPORT static SimModelSolverPoolKey FromSolver (SimModelSolverBase * solver);
+
+		SIMMODELSOLVER_EXPORT bool operator < (const SimModelSolverPoolKey & other) const;
+		SIMMODELSOLVER_EXPORT bool operator == (const SimModelSolverPoolKey & other) const;
+};
+
+//-------------------------------------------------------------------------
+//Pool of solver instances for long running processes which run many
+//simulations of a few model structures (e.g. population simulations).
+//
+//Released solvers are kept (together with their work memory) and handed
+//out again for problems with the same key and the same factory (the factory
+//determines the model, i.e. the solver caller, and the solver type; the
+//key alone does not). The caller sets initial values,
+//parameter values and tolerances and calls ResetForReuse (instead of Init)
+//on every solver obtained by Acquire.
+//
+//Solvers are created and finally released by the factory passed to Acquire;
+//the factory must stay valid until the solver was released by the pool.
+//Thread safe.
+//-------------------------------------------------------------------------
+
+class SimModelSolverPool
+{
+	private:
+		struct PooledSolver
+		{
+			SimModelSolverBase * Solver;
+			ISimModelSolverFactory * Factory;
+		};
+
+		//idle solvers per factory and key
+		typedef std::pair < ISimModelSolverFactory *, SimModelSolverPoolKey > IdleSolversKey;
+		std::map < IdleSolversKey, std::vector < PooledSolver > > _idleSolvers;
+
+		//factory of every solver handed out by Acquire
+		std::map < SimModelSolverBase *, ISimModelSolverFactory * > _acquiredSolvers;
+
+		//max. number of idle solvers kept per factory and key (0 = unlimited)
+		int _maxIdleSolversPerKey;
+
+		long _numberOfCreatedSolvers;
+		long _numberOfReusedSolvers;
+
+		std::mutex _mutex;
+
+		static void DestroySolver (const PooledSolver & pooledSolver);
+
+	public:
+		SIMMODELSOLVER_EXPORT SimModelSolverPool (int maxIdleSolversPerKey = 0);
+
+		//releases all idle solvers (acquired solvers must have been released before)
+		SIMMODELSOLVER_EXPORT virtual ~SimModelSolverPool ();
+
+		//-----------------------------------------------------------------------------------------------------
+		//Get a solver for problems with the given key: an idle solver created by the same factory if available,
+		//otherwise a new solver created by the factory (which must match the key)
+		//-----------------------------------------------------------------------------------------------------
+		SIMMODELSOLVER_EXPORT SimModelSolverBase * Acquire (const SimModelSolverPoolKey & key, ISimModelSolverFactory * factory);
+
+		//Return solver obtained by Acquire to the pool (solver is kept initialized for reuse)
+		SIMMODELSOLVER_EXPORT void Release (SimModelSolverBase * solver);
+
+		//Release all idle solvers by their factories
+		SIMMODELSOLVER_EXPORT void Clear ();
+
+		SIMMODELSOLVER_EXPORT int GetMaxIdleSolversPerKey ();
+		SIMMODELSOLVER_EXPORT void SetMaxIdleSolversPerKey (int maxIdleSolversPerKey);
+
+		SIMMODELSOLVER_EXPORT int GetNumberOfIdleSolvers ();
+		SIMMODELSOLVER_EXPORT long GetNumberOfCreatedSolvers ();
+		SIMMODELSOLVER_EXPORT long GetNumberOfReusedSolvers ();
+};
+
+#endif //_SimModelSolverPool_H_
@@ -0,0 +1,140 @@
+#ifndef _SimModelSolverResultCache_H_
+#define _SimModelSolverResultCache_H_
+
+#include <list>
+#include <vector>
+#include <string>
+#include <mutex>
+#include <unordered_map>
+#include "SimModelSolverBase/SimModelSolverBase.h"
+#include "SimModelSolverBase/SimModelSolverState.h"
+
+//-------------------------------------------------------------------------
+//Complete input of a simulation run (see SimModelSolverResultCache).
+//
+//Stored as plain bytes: keys are equal only if ALL inputs are bitwise equal.
+//The solver cannot see the model itself nor the options of derived solvers,
+//so the caller must pass an identifier which changes whenever the model
+//(structure, non-sensitivity parameters) or solver specific options change.
+//-------------------------------------------------------------------------
+
+class SimModelSolverResultCacheKey
+{
+	protected:
+		SimModelSolverState _data;
+		unsigned long long _hash;
+
+	public:
+		SIMMODELSOLVER_EXPORT SimModelSolverResultCacheKey ();
+
+		//-----------------------------------------------------------------------------------------------------
+		//Key of the next run of the solver (solver type, problem dimensions, tolerances, step size settings,
+		//initial time, initial values, sensitivity parameter values, base solver options incl. Jacobian 
+		//sparsity probing, warm start profile and its max. step factor, sensitivity subsets)
+		//and the output times
+		//-----------------------------------------------------------------------------------------------------
+		SIMMODELSOLVER_EXPORT static SimModelSolverResultCacheKey FromSolver (SimModelSolverBase * solver,
+			                                                                  const std::vector < double > & outputTimes,
+			                                                                  const std::string & modelIdentifier);
+
+		//Set key from raw bytes (e.g. read from a file)
+		SIMMODELSOLVER_EXPORT void SetData (const unsigned char * data, size_t size);
+
+		SIMMODELSOLVER_EXPORT size_t GetSize () const;
+		SIMMODELSOLVER_EXPORT const unsigned char * GetData () const;
+
+		//64 bit FNV-1a hash of the key bytes
+		SIMMODELSOLVER_EXPORT unsigned long long GetHash () const;
+
+		SIMMODELSOLVER_EXPORT bool operator == (const SimModelSolverResultCacheKey & other) const;
+};
+
+//-------------------------------------------------------------------------
+//Cache of simulation results for repeated runs (optimizers, samplers, ...).
+//
+//Results are returned only for an exact key match (hash collisions are
+//resolved by comparing the complete keys).
+//Memory tier: least recently used results are dropped when the memory limit
+//is exceeded. Optional disk tier: every stored result is also written to
+//one file in the cache directory; results found there are moved to memory.
+//Files are read and written without holding the lock of the cache.
+//
+//Result layout (as SimModelSolverEnsemble::Run for one run):
+//solution[k * n + i] = y_i(t_k), sensitivities[(k * n + i) * NS + j] = dy_i/dp_j(t_k)
+//
+//Thread safe.
+//-------------------------------------------------------------------------
+
+class SimModelSolverResultCache
+{
+	private:
+		struct CacheEntry
+		{
+			SimModelSolverResultCacheKey Key;
+			std::vector < double > Solution;
+			std::vector < double > Sensitivities;
+			size_t MemorySize;
+		};
+
+		//most recently used entry first
+		std::list < CacheEntry > _entries;
+		std::unordered_multimap < unsigned long long, std::list < CacheEntry >::iterator > _entriesByHash;
+
+		//max. memory used by cached results [bytes] (0 = memory tier disabled)
+		size_t _maxMemorySize;
+		size_t _memorySize;
+
+		//directory of the disk tier ("" = disk tier disabled)
+		std::string _diskDirectory;
+
+		long _numberOfHits;
+		long _numberOfDiskHits;
+		long _numberOfMisses;
+
+		std::mutex _mutex;
+
+		std::list < CacheEntry >::iterator FindEntry (const SimModelSolverResultCacheKey & key);
+		void InsertEntry (const SimModelSolverResultCacheKey & key, const std::vector < double > & solution,
+			              const std::vector < double > & sensitivities);
+		void EvictEntries ();
+
+		//disk tier (called without holding _mutex)
+		static std::string DiskFileName (const std::string & diskDirectory, const SimModelSolverResultCacheKey & key);
+		static bool ReadFromDisk (const std::string & diskDirectory, const SimModelSolverResultCacheKey & key,
+			                      std::vector < double > & solution, std::vector < double > & sensitivities);
+		static void WriteToDisk (const std::string & diskDirectory, const SimModelSolverResultCacheKey & key,
+			                     const std::vector < double > & solution, const std::vector < double > & sensitivities);
+
+	public:
+		SIMMODELSOLVER_EXPORT SimModelSolverResultCache (size_t maxMemorySize = 256 * 1024 * 1024);
+
+		//-----------------------------------------------------------------------------------------------------
+		//Get stored result of the key (memory first, then disk)
+		//Returns false if there is no result for the key
+		//-----------------------------------------------------------------------------------------------------
+		SIMMODELSOLVER_EXPORT bool Lookup (const SimModelSolverResultCacheKey & key, std::vector < double > & solution,
+			                               std::vector < double > & sensitivities);
+
+		//Store result of a SUCCESSFUL run (replaces an existing result of the key)
+		SIMMODELSOLVER_EXPORT void Store (const SimModelSolverResultCacheKey & key, const std::vector < double > & solution,
+			                              const std::vector < double > & sensitivities);
+
+		//Remove all results from memory (files of the disk tier are kept)
+		SIMMODELSOLVER_EXPORT void Clear ();
+
+		SIMMODELSOLVER_EXPORT size_t GetMaxMemorySize ();
+		SIMMODELSOLVER_EXPORT void SetMaxMemorySize (size_t maxMemorySize);
+		SIMMODELSOLVER_EXPORT size_t GetMemorySize ();
+		SIMMODELSOLVER_EXPORT int GetNumberOfEntries ();
+
+		//Directory must exist ("" disables the disk tier)
+		SIMMODELSOLVER_EXPORT std::string GetDiskDirectory ();
+		SIMMODELSOLVER_EXPORT void SetDiskDirectory (const std::string & diskDirectory);
+
+		//Lookup statistics (disk hits are included in the number of hits)
+		SIMMODELSOLVER_EXPORT long GetNumberOfHits ();
+		SIMMODELSOLVER_EXPORT long GetNumberOfDiskHits ();
+		SIMMODELSOLVER_EXPORT long GetNumberOfMisses ();
+};
+
+#endif //_SimModelSolverResultCache_H_
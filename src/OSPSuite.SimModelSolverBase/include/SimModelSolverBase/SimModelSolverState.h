@@ -0,0 +1,61 @@
+#ifndef _SimModelSolverState_H_
+#define _SimModelSolverState_H_
+
+#include <vector>
+#include <cstddef>
+#include "SimModelSolverBase/SimModelSolverErrorData.h"
+
+//-------------------------------------------------------------------------
+//Snapshot of the complete integrator state of a solver (see
+//SimModelSolverBase::SaveState/RestoreState).
+//
+//Plain byte buffer: can be copied freely and written to/read from a file
+//(GetData/SetData), e.g. for checkpointing. A snapshot can only be restored
+//into an initialized solver of the same type and with the same problem
+//dimensions on the same platform.
+//
+//Values are appended sequentially with Write...; they must be read in the
+//same order with Read..., passing the current read position.
+//-------------------------------------------------------------------------
+
+class SimModelSolverState
+{
+	protected:
+		std::vector < unsigned char > _data;
+
+	public:
+		SIMMODELSOLVER_EXPORT SimModelSolverState ();
+
+		SIMMODELSOLVER_EXPORT bool IsEmpty () const;
+		SIMMODELSOLVER_EXPORT void Clear ();
+
+		//raw content of the snapshot
+		SIMMODELSOLVER_EXPORT size_t GetSize () const;
+		SIMMODELSOLVER_EXPORT const unsigned char * GetData () const;
+		SIMMODELSOLVER_EXPORT void SetData (const unsigned char * data, size_t size);
+
+		SIMMODELSOLVER_EXPORT void WriteBytes (const void * data, size_t size);
+		SIMMODELSOLVER_EXPORT void WriteBool (bool value);
+		SIMMODELSOLVER_EXPORT void WriteInt (int value);
+		SIMMODELSOLVER_EXPORT void WriteLong (long value);
+		SIMMODELSOLVER_EXPORT void WriteDouble (double value);
+
+		//n values (n is not stored)
+		SIMMODELSOLVER_EXPORT void WriteDoubles (const double * values, size_t n);
+
+		//vectors are stored with their size
+		SIMMODELSOLVER_EXPORT void WriteVector (const std::vector < double > & values);
+		SIMMODELSOLVER_EXPORT void WriteVector (const std::vector < int > & values);
+
+		//Read... throw an exception if the snapshot ends before the requested value
+		SIMMODELSOLVER_EXPORT void ReadBytes (size_t & position, void * data, size_t size) const;
+		SIMMODELSOLVER_EXPORT bool ReadBool (size_t & position) const;
+		SIMMODELSOLVER_EXPORT int ReadInt (size_t & position) const;
+		SIMMODELSOLVER_EXPORT long ReadLong (size_t & position) const;
+		SIMMODELSOLVER_EXPORT double ReadDouble (size_t & position) const;
+		SIMMODELSOLVER_EXPORT void ReadDoubles (size_t & position, double * values, size_t n) const;
+		SIMMODELSOLVER_EXPORT void ReadVector (size_t & position, std::vector < double > & values) const;
+		SIMMODELSOLVER_EXPORT void ReadVector (size_t & position, std::vector < int > & values) const;
+};
+
+#endif //_SimModelSolverState_H_
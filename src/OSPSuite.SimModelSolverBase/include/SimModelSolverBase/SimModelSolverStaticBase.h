@@ -0,0 +1,218 @@
+#ifndef _SimModelSolverStaticBase_H_
+#define _SimModelSolverStaticBase_H_
+
+#include <chrono>
+#include <type_traits>
+#include "SimModelSolverBase/SimModelSolverBase.h"
+
+//-------------------------------------------------------------------------
+//Compile-time capabilities of a solver caller class used with
+//SimModelSolverStaticBase. Specialize for the concrete caller class, e.g.
+//
+//   template <> struct SolverCallerTraits < MyCaller >
+//   {
+//      static constexpr bool HasODEJacFunction = true;
+//      ...
+//   };
+//
+//All flags must be specified and must match the corresponding run time
+//queries of the caller (IsSet_..., UseBandLinearSolver); this is checked in Init.
+//The primary template describes a caller which provides only the RHS function.
+//-------------------------------------------------------------------------
+template < class TCaller >
+struct SolverCallerTraits
+{
+	static constexpr bool HasODEJacFunction = false;
+	static constexpr bool HasODESparseJacFunction = false;
+	static constexpr bool HasODESensitivityRhsFunction = false;
+	static constexpr bool HasODESensitivityRhsFunctionAll = false;
+	static constexpr bool HasODERootFunction = false;
+	static constexpr bool UseBandLinearSolver = false;
+};
+
+//-------------------------------------------------------------------------
+//Counterpart of SimModelSolverBase for solvers which know the type of the
+//solver caller at compile time.
+//
+//The Call... routines hide the ones of SimModelSolverBase and call the
+//caller functions with qualified names (TCaller::ODERhsFunction etc.), so
+//no virtual dispatch takes place and the RHS can be inlined into the
+//integrator. Capability queries are constexpr (SolverCallerTraits).
+//Best results are obtained if the caller class is declared final.
+//Requires C++17 (if constexpr on the caller traits).
+//
+//Everything else (options, dense output, root finding, statistics...) is
+//inherited from SimModelSolverBase; routines implemented there still use
+//the virtual ISolverCaller interface, which keeps working unchanged.
+//-------------------------------------------------------------------------
+template < class TCaller >
+class SimModelSolverStaticBase : public SimModelSolverBase
+{
+	static_assert(std::is_base_of < ISolverCaller, TCaller >::value, "Solver caller must be derived from ISolverCaller");
+
+	public:
+		typedef TCaller CallerType;
+		typedef SolverCallerTraits < TCaller > CallerTraits;
+
+	protected:
+		//same object as _solverCaller, with its concrete type
+		TCaller * _caller;
+
+		static double CallbackTimeInSeconds ()
+		{
+			return std::chrono::duration < double > (std::chrono::steady_clock::now().time_since_epoch()).count();
+		}
+
+		//Evaluate RHS/Jacobian of the solver caller (statically dispatched) and update statistics
+		inline Rhs_Return_Value CallODERhsFunction (double t, const double * y, const double * p, double * ydot, void * f_data)
+		{
+			_statistics.NumberOfRhsEvaluations++;
+
+			if (!_collectCallbackTimings)
+				return _caller->TCaller::ODERhsFunction(t, y, p, ydot, f_data);
+
+			double startTime = CallbackTimeInSeconds();
+			Rhs_Return_Value retVal = _caller->TCaller::ODERhsFunction(t, y, p, ydot, f_data);
+			_statistics.RhsTime += CallbackTimeInSeconds() - startTime;
+
+			return retVal;
+		}
+
+		//Callers without Jacobian: finite difference Jacobian of the base class
+		inline Jacobian_Return_Value CallODEJacFunction (double t, const double * y, const double * p, const double * fy,
+			                                             double * * Jacobian, void * Jac_data)
+		{
+			if constexpr (CallerTraits::HasODEJacFunction)
+			{
+				double startTime = _collectCallbackTimings ? CallbackTimeInSeconds() : 0.0;
+
+				Jacobian_Return_Value retVal = _caller->TCaller::ODEJacFunction(t, y, p, fy, Jacobian, Jac_data);
+
+				_statistics.NumberOfJacobianEvaluations++;
+				if (_collectCallbackTimings)
+					_statistics.JacobianTime += CallbackTimeInSeconds() - startTime;
+
+				return retVal;
+			}
+			else
+				return SimModelSolverBase::CallODEJacFunction(t, y, p, fy, Jacobian, Jac_data);
+		}
+
+		inline Jacobian_Return_Value CallODESparseJacFunction (double t, const double * y, const double * p, const double * fy,
+			                                                   double * values, void * Jac_data)
+		{
+			double startTime = _collectCallbackTimings ? CallbackTimeInSeconds() : 0.0;
+
+			Jacobian_Return_Value retVal = _caller->TCaller::ODESparseJacFunction(t, y, p, fy, values, Jac_data);
+
+			_statistics.NumberOfJacobianEvaluations++;
+			if (_collectCallbackTimings)
+				_statistics.JacobianTime += CallbackTimeInSeconds() - startTime;
+
+			return retVal;
+		}
+
+		//Sensitivity RHS for all sensitivity parameters (see SimModelSolverBase::CallODESensitivityRhsFunction)
+		inline Sensitivity_Rhs_Return_Value CallODESensitivityRhsFunction (double t, const double * y, double * ydot,
+			                                                               const double * yS, double * ySdot, void * f_data)
+		{
+			double startTime = _collectCallbackTimings ? CallbackTimeInSeconds() : 0.0;
+			Sensitivity_Rhs_Return_Value retVal = SENSITIVITY_RHS_OK;
+
+			if constexpr (CallerTraits::HasODESensitivityRhsFunctionAll)
+			{
+				retVal = _caller->TCaller::ODESensitivityRhsFunctionAll(t, y, ydot, yS, ySdot, f_data);
+				_statistics.NumberOfSensitivityRhsEvaluations++;
+			}
+			else
+			{
+				for (int iS = 0; iS < _numberOfSensitivityParameters; iS++)
+				{
+					Sensitivity_Rhs_Return_Value sensRetVal =
+						_caller->TCaller::ODESensitivityRhsFunction(t, y, ydot, iS, yS + iS * _problemSize, ySdot + iS * _problemSize, f_data);
+					_statistics.NumberOfSensitivityRhsEvaluations++;
+
+					if (sensRetVal == SENSITIVITY_RHS_FAILED)
+					{
+						retVal = SENSITIVITY_RHS_FAILED;
+						break;
+					}
+
+					if (sensRetVal == SENSITIVITY_RHS_RECOVERABLE_ERROR)
+						retVal = SENSITIVITY_RHS_RECOVERABLE_ERROR;
+				}
+			}
+
+			if (_collectCallbackTimings)
+				_statistics.SensitivityRhsTime += CallbackTimeInSeconds() - startTime;
+
+			return retVal;
+		}
+
+	public:
+		SimModelSolverStaticBase (TCaller * pSolverCaller, int problemSize, int numberOfSensitivityParameters)
+			: SimModelSolverBase(pSolverCaller, problemSize, numberOfSensitivityParameters)
+		{
+			_caller = pSolverCaller;
+		}
+
+		TCaller * GetTypedSolverCaller ()
+		{
+			return _caller;
+		}
+
+		//compile time capabilities of the solver caller
+		static constexpr bool HasODEJacFunction ()
+		{
+			return CallerTraits::HasODEJacFunction;
+		}
+
+		static constexpr bool HasODESparseJacFunction ()
+		{
+			return CallerTraits::HasODESparseJacFunction;
+		}
+
+		static constexpr bool HasODESensitivityRhsFunction ()
+		{
+			return CallerTraits::HasODESensitivityRhsFunction || CallerTraits::HasODESensitivityRhsFunctionAll;
+		}
+
+		static constexpr bool HasODERootFunction ()
+		{
+			return CallerTraits::HasODERootFunction;
+		}
+
+		static constexpr bool UseBandLinearSolver ()
+		{
+			return CallerTraits::UseBandLinearSolver;
+		}
+
+		//-----------------------------------------------------------------------------------------------------
+		//Checks that SolverCallerTraits < TCaller > matches the run time capabilities of the caller.
+		//Inherited classes must call it first in their Init (as for SimModelSolverBase::Init)
+		//-----------------------------------------------------------------------------------------------------
+		virtual void Init ()
+		{
+			const char * ERROR_SOURCE = "SimModelSolverStaticBase::Init";
+
+			SimModelSolverBase::Init();
+
+			if (_caller == NULL)
+				throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Solver caller is not set");
+
+			//the statically dispatched RHS is the ODE RHS
+			if (_ddeSystem)
+				throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "DDE systems are not supported by statically dispatched solvers");
+
+			if ((CallerTraits::HasODEJacFunction != _caller->IsSet_ODEJacFunction()) ||
+				(CallerTraits::HasODESparseJacFunction != _caller->IsSet_ODESparseJacFunction()) ||
+				(CallerTraits::HasODESensitivityRhsFunction != _caller->IsSet_ODESensitivityRhsFunction()) ||
+				(CallerTraits::HasODESensitivityRhsFunctionAll != _caller->IsSet_ODESensitivityRhsFunctionAll()) ||
+				(CallerTraits::HasODERootFunction != _caller->IsSet_ODERootFunction()) ||
+				(CallerTraits::UseBandLinearSolver != _caller->UseBandLinearSolver()))
+				throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE,
+				                              "SolverCallerTraits of the solver caller do not match its capabilities");
+		}
+};
+
+#endif //_SimModelSolverStaticBase_H_
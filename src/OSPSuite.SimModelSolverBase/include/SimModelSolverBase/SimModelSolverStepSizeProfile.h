@@ -0,0 +1,89 @@
+#ifndef _SimModelSolverStepSizeProfile_H_
+#define _SimModelSolverStepSizeProfile_H_
+
+#include <vector>
+#include "SimModelSolverBase/SimModelSolverErrorData.h"
+#include "SimModelSolverBase/SimModelSolverState.h"
+
+//-------------------------------------------------------------------------
+//Accepted internal steps (time, step size, order) of a reference run,
+//used to warm start later runs of the same model (population members,
+//optimizer iterations) instead of ramping up from the default initial
+//step size after Init and after every ReInit.
+//
+//The profile consists of one segment per restart of the reference run
+//(Init/ReInit at the segment start time). Steps within a segment are in
+//ascending time order.
+//
+//The start-up phase of every segment (step sizes growing as fast as the
+//step size control allows, starting from a small initial step) is not used:
+//the warm start begins with the first step size limited by the error.
+//
+//Order values are those reported by the solver (solver specific), so a
+//profile should only be used by solvers of the type which recorded it.
+//
+//Recording is not synchronized; a recorded profile can be read by any
+//number of solvers at the same time (e.g. by all ensemble workers).
+//-------------------------------------------------------------------------
+
+class SimModelSolverStepSizeProfile
+{
+	private:
+		class Segment
+		{
+			public:
+				double StartTime;
+
+				//index of the first step of the segment
+				size_t FirstStep;
+		};
+
+		std::vector < Segment > _segments;
+
+		//end time, step size and order of every accepted step
+		std::vector < double > _stepTimes;
+		std::vector < double > _stepSizes;
+		std::vector < int > _stepOrders;
+
+		//segment which contains time t (-1 if none); segment start times are compared with tolerance
+		int FindSegment (double t) const;
+
+		//first step of segment ending at or after t (end of segment if none)
+		size_t FindStep (int segmentIndex, double t) const;
+		size_t SegmentEnd (int segmentIndex) const;
+
+		//first step of the segment after the start-up phase
+		size_t FindStartUpEnd (int segmentIndex) const;
+
+	public:
+		SIMMODELSOLVER_EXPORT SimModelSolverStepSizeProfile ();
+
+		//-----------------------------------------------------------------------------------------------------
+		//Recording (called by SimModelSolverBase for the profile set with SetStepSizeProfileRecording)
+		//-----------------------------------------------------------------------------------------------------
+		SIMMODELSOLVER_EXPORT void StartSegment (double t0);
+		SIMMODELSOLVER_EXPORT void AddStep (double t, double h, int order);
+		SIMMODELSOLVER_EXPORT void Clear ();
+
+		SIMMODELSOLVER_EXPORT int GetNumberOfSegments () const;
+		SIMMODELSOLVER_EXPORT size_t GetNumberOfSteps () const;
+
+		//Append segments and steps to state (e.g. for the key of SimModelSolverResultCache)
+		SIMMODELSOLVER_EXPORT void SaveState (SimModelSolverState & state) const;
+
+		//-----------------------------------------------------------------------------------------------------
+		//Step size and order of the reference run after its start-up phase following a restart at t0.
+		//If the reference run was not restarted at t0: step size and order of the step over t0.
+		//Returns false if the reference run did not reach t0
+		//-----------------------------------------------------------------------------------------------------
+		SIMMODELSOLVER_EXPORT bool GetInitialStep (double t0, double & h, int & order) const;
+
+		//-----------------------------------------------------------------------------------------------------
+		//Largest step size of the reference run around time t (the step over t and its neighbours;
+		//first step after the start-up phase for t within the start-up phase).
+		//Returns 0 if the reference run did not reach t
+		//-----------------------------------------------------------------------------------------------------
+		SIMMODELSOLVER_EXPORT double GetStepSize (double t) const;
+};
+
+#endif //_SimModelSolverStepSizeProfile_H_
@@ -0,0 +1,88 @@
+#ifndef _SimModelSolverVectorKernels_H_
+#define _SimModelSolverVectorKernels_H_
+
+#include <cstddef>
+#include "SimModelSolverBase/SimModelSolverErrorData.h"
+
+//-------------------------------------------------------------------------
+//Vector operations used in every internal step of the solver back-ends
+//(states y and sensitivity blocks), vectorized with AVX2 or AVX-512.
+//
+//The instruction set is selected at runtime (first call) from the CPU
+//and the operating system support; the scalar implementation is used on
+//other CPUs and on non-x86 builds.
+//Several vectors are combined in ONE pass where possible (LinearCombination,
+//ScaleAddMulti), because for large sensitivity blocks the operations are
+//limited by memory bandwidth, not by arithmetic.
+//
+//Sensitivity blocks are stored column-major: column j (dy/dp_j) starts at
+//X + j * columnStride.
+//
+//Sums are evaluated in a different order by each instruction set, so
+//norms may differ in the last bits between CPUs.
+//-------------------------------------------------------------------------
+
+class SimModelSolverVectorKernels
+{
+	public:
+		enum InstructionSet
+		{
+			INSTRUCTION_SET_SCALAR = 0,
+			INSTRUCTION_SET_AVX2 = 1,
+			INSTRUCTION_SET_AVX512 = 2
+		};
+
+		//best instruction set supported by the CPU and operating system
+		SIMMODELSOLVER_EXPORT static InstructionSet GetSupportedInstructionSet ();
+
+		//instruction set used by the kernels
+		SIMMODELSOLVER_EXPORT static InstructionSet GetInstructionSet ();
+
+		//-----------------------------------------------------------------------------------------------------
+		//Use another (supported) instruction set, e.g. to compare results with the scalar implementation.
+		//Not synchronized with running solvers: to be called before the solvers are started.
+		//-----------------------------------------------------------------------------------------------------
+		SIMMODELSOLVER_EXPORT static void SetInstructionSet (InstructionSet instructionSet);
+
+		SIMMODELSOLVER_EXPORT static const char * GetInstructionSetName (InstructionSet instructionSet);
+
+		//z = c * x (z may be x)
+		SIMMODELSOLVER_EXPORT static void Scale (size_t n, double c, const double * x, double * z);
+
+		//y = a * x + y
+		SIMMODELSOLVER_EXPORT static void Axpy (size_t n, double a, const double * x, double * y);
+
+		//z = a * x + b * y (z may be x or y)
+		SIMMODELSOLVER_EXPORT static void LinearSum (size_t n, double a, const double * x, double b, const double * y, double * z);
+
+		//-----------------------------------------------------------------------------------------------------
+		//z = sum(c[k] * X[k], k = 0..numberOfVectors-1) in one pass (z may be one of the X[k])
+		//-----------------------------------------------------------------------------------------------------
+		SIMMODELSOLVER_EXPORT static void LinearCombination (size_t n, int numberOfVectors, const double * c,
+			                                                 const double * const * X, double * z);
+
+		//-----------------------------------------------------------------------------------------------------
+		//Z[k] = a[k] * x + Y[k], k = 0..numberOfVectors-1 in one pass over x (Z[k] may be Y[k])
+		//-----------------------------------------------------------------------------------------------------
+		SIMMODELSOLVER_EXPORT static void ScaleAddMulti (size_t n, int numberOfVectors, const double * a, const double * x,
+			                                             const double * const * Y, double * const * Z);
+
+		//-----------------------------------------------------------------------------------------------------
+		//Weighted RMS norm sqrt(1/n * sum((x_i * w_i)^2)) with w_i = 1 / (absTol_i + relTol * |y_i|)
+		//-----------------------------------------------------------------------------------------------------
+		SIMMODELSOLVER_EXPORT static double WeightedRmsNorm (size_t n, const double * x, const double * y,
+			                                                 double relTol, const double * absTol);
+
+		//as above with w_i = 1 / (absTol_i + relTol * max(|yOld_i|, |yNew_i|)) (error test of a step)
+		SIMMODELSOLVER_EXPORT static double WeightedRmsNorm (size_t n, const double * x, const double * yOld, const double * yNew,
+			                                                 double relTol, const double * absTol);
+
+		//-----------------------------------------------------------------------------------------------------
+		//Max. of the weighted RMS norms of the columns of the sensitivity block X (n x numberOfColumns),
+		//weights of column j from column j of Y
+		//-----------------------------------------------------------------------------------------------------
+		SIMMODELSOLVER_EXPORT static double WeightedRmsNormBlock (size_t n, int numberOfColumns, const double * X, const double * Y,
+			                                                      size_t columnStride, double relTol, const double * absTol);
+};
+
+#endif //_SimModelSolverVectorKernels_H_
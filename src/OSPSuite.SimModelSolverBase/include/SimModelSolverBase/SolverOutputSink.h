@@ -0,0 +1,34 @@
+#ifndef _SolverOutputSink_H_
+#define _SolverOutputSink_H_
+
+//-------------------------------------------------------------------------
+//Receiver of simulation results, written while the integration proceeds
+//(see SimModelSolverBase::PerformSolverStepsToSink, SimModelSolverEnsemble::Run),
+//so that the results of large simulations need not be kept in memory.
+//
+//A run (e.g. one individual of a population) is written as:
+//BeginRun, WriteOutput for every output time reached (in increasing order), EndRun.
+//Different runs may be written concurrently from different threads.
+//-------------------------------------------------------------------------
+
+class ISolverOutputSink
+{
+	public:
+		virtual ~ISolverOutputSink () {}
+
+		virtual void BeginRun (int runIndex) = 0;
+
+		//-----------------------------------------------------------------------------------------------------
+		// - [IN] runIndex: run as passed to BeginRun
+		// - [IN] outputIndex: index of the output time
+		// - [IN] t: output time
+		// - [IN] y: solution (n values)
+		// - [IN] yS: sensitivities, yS[i * NS + j] = dy_i/dp_j (NULL if there are no sensitivity parameters)
+		//-----------------------------------------------------------------------------------------------------
+		virtual void WriteOutput (int runIndex, int outputIndex, double t, const double * y, const double * yS) = 0;
+
+		//success = false if the run failed (outputs written so far are kept)
+		virtual void EndRun (int runIndex, bool success) = 0;
+};
+
+#endif //_SolverOutputSink_H_
@@ -0,0 +1,77 @@
+#ifndef _SolverStatistics_H_
+#define _SolverStatistics_H_
+
+#include "SimModelSolverBase/SimModelSolverErrorData.h"
+
+//-------------------------------------------------------------------------
+//Performance counters of a solver.
+//Callback counters and timings are filled by SimModelSolverBase (if the
+//solver calls the caller through the Call... routines of the base class),
+//step related counters are filled by the solver.
+//Timings are in seconds and only collected if enabled (SetCollectCallbackTimings)
+//-------------------------------------------------------------------------
+
+class SolverStatistics
+{
+	public:
+		//accepted internal steps
+		long NumberOfSteps;
+
+		//internal steps rejected by the error test
+		long NumberOfErrorTestFailures;
+
+		//nonlinear (Newton) iterations and convergence failures
+		long NumberOfNonlinearIterations;
+		long NumberOfNonlinearConvergenceFailures;
+
+		//setups (e.g. factorizations) of the linear solver
+		long NumberOfLinearSolverSetups;
+
+		//calls of the solver caller (sensitivity RHS: one per ODESensitivityRhsFunctionAll call resp. 
+		//one per parameter if the caller provides ODESensitivityRhsFunction only)
+		long NumberOfRhsEvaluations;
+		long NumberOfJacobianEvaluations;
+		long NumberOfSensitivityRhsEvaluations;
+		long NumberOfRootFunctionEvaluations;
+
+		//calls of ODEAdjointRhsFunction and ODEAdjointQuadratureFunction of the solver caller
+		long NumberOfAdjointRhsEvaluations;
+		long NumberOfAdjointQuadratureEvaluations;
+
+		//time spent in the solver caller [s]
+		double RhsTime;
+		double JacobianTime;
+		double SensitivityRhsTime;
+		double AdjointTime;
+
+		//step size and order of the last accepted internal step
+		double LastStepSize;
+		int LastOrder;
+
+		SIMMODELSOLVER_EXPORT SolverStatistics ();
+		SIMMODELSOLVER_EXPORT void Clear ();
+
+		//Counters/timings of this minus counters/timings of other (step size and order of this)
+		SIMMODELSOLVER_EXPORT SolverStatistics Difference (const SolverStatistics & other) const;
+};
+
+//-------------------------------------------------------------------------
+//Optional hook for tracing every accepted internal step of a solver.
+//Called synchronously from the solver: implementations must be cheap
+//-------------------------------------------------------------------------
+
+class ISolverStepObserver
+{
+	public:
+		virtual ~ISolverStepObserver () {}
+
+		//-----------------------------------------------------------------------------------------------------
+		// - [IN] t: time reached by the internal step
+		// - [IN] h: size of the internal step
+		// - [IN] order: method order used for the step (0 if not applicable)
+		// - [IN] statistics: cumulative statistics of the solver (since Init)
+		//-----------------------------------------------------------------------------------------------------
+		virtual void OnInternalStep (double t, double h, int order, const SolverStatistics & statistics) = 0;
+};
+
+#endif //_SolverStatistics_H_
@@ -22,6 +22,29 @@ enum Sensitivity_Rhs_Return_Value
 	SENSITIVITY_RHS_RECOVERABLE_ERROR = 1
 };
 
+enum Preconditioner_Return_Value
+{
+	PRECONDITIONER_FAILED = -1,
+	PRECONDITIONER_OK = 0,
+	PRECONDITIONER_RECOVERABLE_ERROR = 1
+};
+
+enum Root_Return_Value
+{
+	ROOT_FAILED = -1,
+	ROOT_OK = 0,
+	ROOT_RECOVERABLE_ERROR = 1
+};
+
+//Storage format of a sparse Jacobian matrix
+// - SPARSE_CSC: compressed sparse column (index pointers per column, row indices)
+// - SPARSE_CSR: compressed sparse row (index pointers per row, column indices)
+enum Sparse_Matrix_Format
+{
+	SPARSE_CSC = 0,
+	SPARSE_CSR = 1
+};
+
 //-------------------------------------------------------------------------
 //Common ODE/DDE Solver Caller Interface.
 //Will be passed to every Solver instance to  provide function calls to 
@@ -51,7 +74,121 @@ class ISolverCaller
 		// - [IN, OPTIONAL] Jac_data: data passed to the function
 		//-----------------------------------------------------------------------------------------------------
 		virtual Jacobian_Return_Value ODEJacFunction(double t, const double * y, const double * p, const double * fy, double * * Jacobian, void * Jac_data) = 0;
+
+		//-----------------------------------------------------------------------------------------------------
+		//Sparse Jacobian function of the ODE system dy/dt = f(t, y(t))
+		//Fills ONLY the nonzero values of the Jacobian, in the order defined by the 
+		//sparsity pattern returned by GetSparseJacobianPattern
+		// - [IN] t: current time
+		// - [IN] y: Solution vector at time t
+		// - [IN] p: parameter values for sensitivity parameters
+		// - [IN] fy: RHS function value at (t, y) 
+		// - [OUT] values: nonzero values of the Jacobian (GetSparseJacobianNumberOfNonZeros() values)
+		// - [IN, OPTIONAL] Jac_data: data passed to the function
+		//-----------------------------------------------------------------------------------------------------
+		virtual Jacobian_Return_Value ODESparseJacFunction(double /*t*/, const double * /*y*/, const double * /*p*/, const double * /*fy*/, double * /*values*/, void * /*Jac_data*/)
+		{
+			return JACOBIAN_FAILED;
+		}
+
+		//Returns number of structural nonzeros of the Jacobian (only relevant if IsSet_ODESparseJacFunction is true)
+		virtual int GetSparseJacobianNumberOfNonZeros()
+		{
+			return 0;
+		}
+
+		//Returns storage format of the sparse Jacobian (only relevant if IsSet_ODESparseJacFunction is true)
+		virtual Sparse_Matrix_Format GetSparseJacobianFormat()
+		{
+			return SPARSE_CSC;
+		}
+
+		//-----------------------------------------------------------------------------------------------------
+		//Structural sparsity pattern of the Jacobian. Called ONCE before the integration starts
+		//(only relevant if IsSet_ODESparseJacFunction is true)
+		// - [OUT] indexPointers: (problem size + 1) values. Nonzeros of column (CSC) or row (CSR) k are stored
+		//                        at positions indexPointers[k] .. indexPointers[k+1]-1 of the values array
+		// - [OUT] indexValues: row (CSC) or column (CSR) index of every nonzero (GetSparseJacobianNumberOfNonZeros() values)
+		//-----------------------------------------------------------------------------------------------------
+		virtual void GetSparseJacobianPattern(int * /*indexPointers*/, int * /*indexValues*/)
+		{
+		}
 		
+		//-----------------------------------------------------------------------------------------------------
+		//Jacobian-vector product of the ODE system dy/dt = f(t, y(t)) (for matrix-free iterative linear solvers)
+		// - [IN] t: current time
+		// - [IN] y: Solution vector at time t
+		// - [IN] p: parameter values for sensitivity parameters
+		// - [IN] fy: RHS function value at (t, y) 
+		// - [IN] v: vector to be multiplied with the Jacobian
+		// - [OUT] Jv: product J(t, y) * v
+		// - [IN, OPTIONAL] Jac_data: data passed to the function
+		//-----------------------------------------------------------------------------------------------------
+		virtual Jacobian_Return_Value ODEJacTimesVecFunction(double /*t*/, const double * /*y*/, const double * /*p*/, const double * /*fy*/, 
+			                                                 const double * /*v*/, double * /*Jv*/, void * /*Jac_data*/)
+		{
+			return JACOBIAN_FAILED;
+		}
+
+		//-----------------------------------------------------------------------------------------------------
+		//Preconditioner setup for iterative linear solvers. 
+		//Prepares (e.g. evaluates and factorizes) a preconditioner P approximating I - gamma * J(t, y)
+		// - [IN] t: current time
+		// - [IN] y: Solution vector at time t
+		// - [IN] p: parameter values for sensitivity parameters
+		// - [IN] fy: RHS function value at (t, y) 
+		// - [IN] jacobianOk: false if Jacobian related data must be recomputed;
+		//                    true if Jacobian data saved from a previous call may be reused (with the new gamma)
+		// - [OUT] jacobianCurrent: must be set to true if Jacobian data was recomputed, false otherwise
+		// - [IN] gamma: scalar in I - gamma * J
+		// - [IN, OPTIONAL] P_data: data passed to the function
+		//-----------------------------------------------------------------------------------------------------
+		virtual Preconditioner_Return_Value ODEPreconditionerSetupFunction(double /*t*/, const double * /*y*/, const double * /*p*/, const double * /*fy*/,
+			                                                               bool /*jacobianOk*/, bool & /*jacobianCurrent*/, double /*gamma*/, void * /*P_data*/)
+		{
+			return PRECONDITIONER_FAILED;
+		}
+
+		//-----------------------------------------------------------------------------------------------------
+		//Preconditioner solve for iterative linear solvers: solves P z = r
+		// - [IN] t: current time
+		// - [IN] y: Solution vector at time t
+		// - [IN] p: parameter values for sensitivity parameters
+		// - [IN] fy: RHS function value at (t, y) 
+		// - [IN] r: right-hand side vector
+		// - [OUT] z: solution vector
+		// - [IN] gamma: scalar in I - gamma * J
+		// - [IN] delta: tolerance for an iterative preconditioner solve (may be ignored)
+		// - [IN] leftPreconditioner: true for left, false for right preconditioning
+		// - [IN, OPTIONAL] P_data: data passed to the function
+		//-----------------------------------------------------------------------------------------------------
+		virtual Preconditioner_Return_Value ODEPreconditionerSolveFunction(double /*t*/, const double * /*y*/, const double * /*p*/, const double * /*fy*/,
+			                                                               const double * /*r*/, double * /*z*/, double /*gamma*/, double /*delta*/,
+			                                                               bool /*leftPreconditioner*/, void * /*P_data*/)
+		{
+			return PRECONDITIONER_FAILED;
+		}
+
+		//-----------------------------------------------------------------------------------------------------
+		//Root functions of the ODE system dy/dt = f(t, y(t)) for state dependent events (switches etc.)
+		//An event occurs when one of the root functions g_k(t, y) changes its sign during integration
+		// - [IN] t: current time
+		// - [IN] y: Solution vector at time t
+		// - [IN] p: parameter values for sensitivity parameters
+		// - [OUT] gout: values of the root functions (GetNumberOfRootFunctions() values)
+		// - [IN, OPTIONAL] g_data: data passed to the function
+		//-----------------------------------------------------------------------------------------------------
+		virtual Root_Return_Value ODERootFunction(double /*t*/, const double * /*y*/, const double * /*p*/, double * /*gout*/, void * /*g_data*/)
+		{
+			return ROOT_FAILED;
+		}
+
+		//Returns number of root functions (only relevant if IsSet_ODERootFunction is true)
+		virtual int GetNumberOfRootFunctions ()
+		{
+			return 0;
+		}
+
 		//-----------------------------------------------------------------------------------------------------
 		//RHS Function of the DDE system dy/dt = f(t, y(t), yd)
 		// - [IN] t: current time
@@ -88,15 +225,118 @@ class ISolverCaller
 		virtual Sensitivity_Rhs_Return_Value ODESensitivityRhsFunction(double t, const double * y, double * ydot,
 			                                                           int iS, const double * yS, double * ySdot, void * f_data) = 0;
 
+		//-----------------------------------------------------------------------------------------------------
+		//Sensitivity RHS Function for the ODE system dy/dt = f(t, y(t), p)
+		//
+		//This function computes the sensitivity right-hand sides for ALL sensitivity equations in one call,
+		//so that intermediates shared by all parameters (e.g. df/dy) are computed only once.
+		//It must compute the vectors (df/dy)s_i(t) + (df/dp_i) for i = 0..NS-1 (where s_i(t)= dy(t)/dp_i)
+		//
+		//Sensitivity vectors are stored contiguously (column-major n x NS block, n = problem size):
+		//s_i is stored at yS[i * n] .. yS[i * n + n - 1]
+		//
+		// - [IN] t: current time
+		// - [IN] y: Solution vector at time t
+		// - [IN] ydot: RHS function value of ODE System at (t, y)
+		// - [IN] yS: current sensitivities (n x NS block)
+		// - [OUT] ySdot: sensitivity RHS vectors (n x NS block)
+		// - [IN, OPTIONAL] f_data: data passed to the RHS function
+		//-----------------------------------------------------------------------------------------------------
+		virtual Sensitivity_Rhs_Return_Value ODESensitivityRhsFunctionAll(double /*t*/, const double * /*y*/, double * /*ydot*/,
+			                                                              const double * /*yS*/, double * /*ySdot*/, void * /*f_data*/)
+		{
+			return SENSITIVITY_RHS_FAILED;
+		}
+
+		//-----------------------------------------------------------------------------------------------------
+		//Adjoint sensitivities of an objective G(p) = phi(y(T)) + integral_t0^T g(t, y(t), p) dt
+		//with respect to NP parameters (see SimModelSolverBase::ComputeAdjointSensitivities).
+		//Cost is independent of NP: the adjoint system is integrated backward ONCE
+		//
+		//Adjoint RHS: must compute lambdaDot = -(df/dy)^T lambda - (dg/dy)^T
+		// - [IN] t: current time
+		// - [IN] y: Solution vector at time t (of the forward problem)
+		// - [IN] lambda: adjoint vector at time t (n values)
+		// - [OUT] lambdaDot: adjoint RHS (n values)
+		// - [IN, OPTIONAL] f_data: data passed to the RHS function
+		//Optional: if not set, lambdaDot = -(df/dy)^T lambda is computed from the Jacobian (objective without integral part)
+		//-----------------------------------------------------------------------------------------------------
+		virtual Rhs_Return_Value ODEAdjointRhsFunction (double /*t*/, const double * /*y*/, const double * /*lambda*/, double * /*lambdaDot*/, void * /*f_data*/)
+		{
+			return RHS_FAILED;
+		}
+
+		//-----------------------------------------------------------------------------------------------------
+		//Adjoint quadrature: must compute qDot_j = lambda^T (df/dp_j) + dg/dp_j for j = 0..NP-1
+		//(dG/dp_j = integral_t0^T qDot_j dt + lambda(t0)^T dy0/dp_j)
+		// - [IN] t, y, lambda: as for ODEAdjointRhsFunction
+		// - [OUT] qDot: quadrature RHS (NP values)
+		// - [IN, OPTIONAL] f_data: data passed to the RHS function
+		//-----------------------------------------------------------------------------------------------------
+		virtual Rhs_Return_Value ODEAdjointQuadratureFunction (double /*t*/, const double * /*y*/, const double * /*lambda*/, double * /*qDot*/, void * /*f_data*/)
+		{
+			return RHS_FAILED;
+		}
+
+		//Returns number of parameters NP of the adjoint quadrature (only relevant if IsSet_ODEAdjointQuadratureFunction is true)
+		virtual int GetNumberOfAdjointParameters ()
+		{
+			return 0;
+		}
+
 		//Returns true, if ODE RHS function is set (we have an ODE system)
 		virtual bool IsSet_ODERhsFunction () = 0;
 
 		//Returns true, if ODE Jacobian function is set (we have an ODE system AND Jacobian function of the ODE system is available)
 		virtual bool IsSet_ODEJacFunction () = 0;
 
+		//Returns true, if sparse ODE Jacobian function and the sparsity pattern of the Jacobian are available
+		virtual bool IsSet_ODESparseJacFunction ()
+		{
+			return false;
+		}
+
+		//Returns true, if Jacobian-vector product function is available
+		//(if not set, iterative linear solvers approximate J*v by difference quotients)
+		virtual bool IsSet_ODEJacTimesVecFunction ()
+		{
+			return false;
+		}
+
+		//Returns true, if preconditioner setup AND solve functions are available
+		virtual bool IsSet_ODEPreconditionerFunctions ()
+		{
+			return false;
+		}
+
 		//Returns true, if ODE Sensitivity RHS function is set (we have an ODE system and SENSITIVITY RHS calculation is available)
 		virtual bool IsSet_ODESensitivityRhsFunction() = 0;
 
+		//Returns true, if sensitivity RHS function for ALL sensitivity parameters is available.
+		//Solvers should prefer it over ODESensitivityRhsFunction if set
+		virtual bool IsSet_ODESensitivityRhsFunctionAll ()
+		{
+			return false;
+		}
+
+		//Returns true, if root functions for state dependent events are available
+		virtual bool IsSet_ODERootFunction ()
+		{
+			return false;
+		}
+
+		//Returns true, if adjoint RHS function is available
+		virtual bool IsSet_ODEAdjointRhsFunction ()
+		{
+			return false;
+		}
+
+		//Returns true, if adjoint quadrature function is available (required for adjoint sensitivities)
+		virtual bool IsSet_ODEAdjointQuadratureFunction ()
+		{
+			return false;
+		}
+
 		//Returns true, if DDE RHS function is set (we have a DDE system)
 		virtual bool IsSet_DDERhsFunction () = 0;
 
@@ -0,0 +1,39 @@
+#ifndef _SolverCallerBatch_H_
+#define _SolverCallerBatch_H_
+
+#include "SolverCallerInterface/SolverCaller.h"
+
+//-------------------------------------------------------------------------
+//Batched ODE Solver Caller Interface.
+//Extends ISolverCaller for solvers which advance N problems of the SAME
+//structure (problem size, number of sensitivity parameters, band widths)
+//together, e.g. the individuals of a population simulation.
+//
+//All batched vectors use structure-of-arrays storage: component i of
+//problem k is stored at [i * batchSize + k]. Thus one component of
+//the RHS can be evaluated for all problems of the batch in a single
+//(vectorizable) loop.
+//-------------------------------------------------------------------------
+
+class ISolverCallerBatch : public ISolverCaller
+{
+	public:
+		//-----------------------------------------------------------------------------------------------------
+		//Batched RHS Function of the ODE systems dy_k/dt = f(t_k, y_k(t), p_k), k=0..batchSize-1
+		// - [IN] t: current times (batchSize values, one per problem)
+		// - [IN] Y: Solution vectors at times t. Y[i * batchSize + k] = y_i of problem k
+		// - [IN] P: Parameter values for sensitivity parameters. P[j * batchSize + k] = p_j of problem k
+		// - [OUT] Ydot: RHS function values. Ydot[i * batchSize + k] = ydot_i of problem k
+		// - [IN] batchSize: number of problems in the batch
+		// - [IN, OPTIONAL] f_data: data passed to the RHS function
+		//
+		//Returns the "worst" return value of all problems in the batch
+		//-----------------------------------------------------------------------------------------------------
+		virtual Rhs_Return_Value ODERhsFunctionBatch(const double * t, const double * Y, const double * P, double * Ydot,
+			                                         int batchSize, void * f_data) = 0;
+
+		//Returns true, if batched ODE RHS function is available
+		virtual bool IsSet_ODERhsFunctionBatch() = 0;
+};
+
+#endif //_SolverCallerBatch_H_
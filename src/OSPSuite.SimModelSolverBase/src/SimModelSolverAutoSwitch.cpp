@@ -0,0 +1,1218 @@
+#include "SimModelSolverBase/SimModelSolverAutoSwitch.h"
+#include "SimModelSolverBase/SimModelSolverVectorKernels.h"
+#include <cmath>
+#include <cfloat>
+#include <algorithm>
+#include <typeinfo>
+
+const char * const OPTION_INTEGRATION_METHOD = "IntegrationMethod";
+const char * const OPTION_STIFFNESS_SWITCH_STEPS = "StiffnessSwitchSteps";
+
+//internal return value of EvaluateRhs: step is retried with a smaller step size
+const int AS_RECOVERABLE_RHS_FAILURE = 2;
+
+//step size control (both methods have local error estimates of order 3)
+const double STEP_SAFETY_FACTOR = 0.9;
+const double STEP_MIN_FACTOR = 0.2;
+const double STEP_MAX_FACTOR = 5.0;
+const double STEP_RECOVERABLE_FAILURE_FACTOR = 0.25;
+const int MAX_FAILED_ATTEMPTS_PER_STEP = 50;
+
+//order reported for accepted steps (identifies the method in step size profiles)
+const int EXPLICIT_METHOD_ORDER = 3;
+const int IMPLICIT_METHOD_ORDER = 2;
+
+//stability boundary of the Bogacki-Shampine method on the negative real axis
+const double EXPLICIT_STABILITY_BOUNDARY = 2.5;
+
+//h * rho above STIFF_THRESHOLD (explicit method): step size limited by stability
+//h * rho below NONSTIFF_THRESHOLD (implicit method): explicit method could take the same step
+//(gap between both thresholds avoids switching back and forth)
+const double STIFF_THRESHOLD = 0.8 * EXPLICIT_STABILITY_BOUNDARY;
+const double NONSTIFF_THRESHOLD = 0.4 * EXPLICIT_STABILITY_BOUNDARY;
+
+//power iterations per implicit step
+const int POWER_ITERATIONS = 2;
+
+//explicit method: one matrix free power iteration every EXPLICIT_POWER_ITERATION_INTERVAL accepted steps
+//(the estimate from the stages alone is far too small if the stiff components are already damped)
+const int EXPLICIT_POWER_ITERATION_INTERVAL = 4;
+
+//Rosenbrock method of Shampine & Reichelt
+static const double ROSENBROCK_D = 1.0 / (2.0 + sqrt(2.0));
+static const double ROSENBROCK_E32 = 6.0 + sqrt(2.0);
+
+SimModelSolverAutoSwitch::SimModelSolverAutoSwitch (ISolverCaller * pSolverCaller, int problemSize, int numberOfSensitivityParameters)
+	: SimModelSolverBase(pSolverCaller, problemSize, numberOfSensitivityParameters)
+{
+	_integrationMethod = METHOD_AUTOMATIC;
+	_stiffnessSwitchSteps = 15;
+
+	_t = 0.0;
+	_h = 0.0;
+	_stiff = false;
+	_stiffnessCounter = 0;
+	_spectralRadius = 0.0;
+
+	_numberOfMethodSwitches = 0;
+	_numberOfExplicitSteps = 0;
+	_numberOfImplicitSteps = 0;
+
+	_systemSize = 0;
+	_fValid = false;
+	_jacobianValid = false;
+
+	_factorizationValid = false;
+	_factorizationScale = 0.0;
+	_factorizationStepSize = 0.0;
+	_jacobianAvailable = false;
+	_jacobianTime = 0.0;
+	_jacobianCacheLookup = false;
+	_jacobianCacheStore = false;
+	_jacobianFromCache = false;
+
+	_useBand = false;
+	_ml = 0;
+	_mu = 0;
+}
+
+std::vector < OptionInfo > SimModelSolverAutoSwitch::GetSolverOptionsInfo ()
+{
+	std::vector < OptionInfo > optionsInfo = GetBaseSolverOptionsInfo();
+
+	OptionInfo methodInfo;
+	methodInfo.SetName(OPTION_INTEGRATION_METHOD);
+	methodInfo.SetDescription("Integration method (automatic: switch between explicit and implicit method depending on the stiffness)");
+	methodInfo.SetDataType(OptionInfo::SODT_ListOfValues);
+	methodInfo.SetDefaultValue(METHOD_AUTOMATIC);
+	methodInfo.AddOptionValue(OptionValueInfo(METHOD_EXPLICIT, "Explicit (Bogacki-Shampine 3(2))"));
+	methodInfo.AddOptionValue(OptionValueInfo(METHOD_IMPLICIT, "Implicit (Rosenbrock 2(3))"));
+	methodInfo.AddOptionValue(OptionValueInfo(METHOD_AUTOMATIC, "Automatic"));
+	optionsInfo.push_back(methodInfo);
+
+	OptionInfo switchStepsInfo;
+	switchStepsInfo.SetName(OPTION_STIFFNESS_SWITCH_STEPS);
+	switchStepsInfo.SetDescription("Number of consecutive steps indicating (non-)stiffness before the integration method is switched");
+	switchStepsInfo.SetDataType(OptionInfo::SODT_Integer);
+	switchStepsInfo.SetDefaultValue(15);
+	switchStepsInfo.SetMinValue(1);
+	optionsInfo.push_back(switchStepsInfo);
+
+	return optionsInfo;
+}
+
+void SimModelSolverAutoSwitch::SetOption (const std::string & name, double value)
+{
+	const char * ERROR_SOURCE = "SimModelSolverAutoSwitch::SetOption";
+
+	if (SetBaseSolverOption(name, value))
+		return;
+
+	if (name == OPTION_INTEGRATION_METHOD)
+	{
+		int method = (int)value;
+		if ((method != METHOD_EXPLICIT) && (method != METHOD_IMPLICIT) && (method != METHOD_AUTOMATIC))
+			throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Invalid integration method");
+
+		SetIntegrationMethod((IntegrationMethod)method);
+	}
+	else if (name == OPTION_STIFFNESS_SWITCH_STEPS)
+		SetStiffnessSwitchSteps((int)value);
+	else
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Unknown option: " + name);
+}
+
+SimModelSolverAutoSwitch::IntegrationMethod SimModelSolverAutoSwitch::GetIntegrationMethod ()
+{
+	return _integrationMethod;
+}
+
+void SimModelSolverAutoSwitch::SetIntegrationMethod (IntegrationMethod integrationMethod)
+{
+	_integrationMethod = integrationMethod;
+
+	if (_integrationMethod != METHOD_AUTOMATIC)
+		_stiff = (_integrationMethod == METHOD_IMPLICIT);
+	_stiffnessCounter = 0;
+}
+
+int SimModelSolverAutoSwitch::GetStiffnessSwitchSteps ()
+{
+	return _stiffnessSwitchSteps;
+}
+
+void SimModelSolverAutoSwitch::SetStiffnessSwitchSteps (int stiffnessSwitchSteps)
+{
+	const char * ERROR_SOURCE = "SimModelSolverAutoSwitch::SetStiffnessSwitchSteps";
+
+	if (stiffnessSwitchSteps < 1)
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Number of stiffness switch steps must be >= 1");
+
+	_stiffnessSwitchSteps = stiffnessSwitchSteps;
+}
+
+bool SimModelSolverAutoSwitch::IsStiff ()
+{
+	return _stiff;
+}
+
+long SimModelSolverAutoSwitch::GetNumberOfMethodSwitches ()
+{
+	return _numberOfMethodSwitches;
+}
+
+long SimModelSolverAutoSwitch::GetNumberOfExplicitSteps ()
+{
+	return _numberOfExplicitSteps;
+}
+
+long SimModelSolverAutoSwitch::GetNumberOfImplicitSteps ()
+{
+	return _numberOfImplicitSteps;
+}
+
+void SimModelSolverAutoSwitch::Init ()
+{
+	const char * ERROR_SOURCE = "SimModelSolverAutoSwitch::Init";
+
+	SimModelSolverBase::Init();
+
+	if (_ddeSystem && (_numberOfSensitivityParameters > 0))
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Sensitivities of DDE systems are not supported by the solver");
+
+	int n = _problemSize, ns = _numberOfSensitivityParameters;
+
+	_useBand = _solverCaller->UseBandLinearSolver();
+	_ml = _useBand ? _solverCaller->GetLowerHalfBandWidth() : n - 1;
+	_mu = _useBand ? _solverCaller->GetUpperHalfBandWidth() : n - 1;
+
+	if ((_ml < 0) || (_mu < 0))
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Invalid half band widths");
+
+	size_t maxSystemSize = (size_t)n * (1 + ns);
+
+	_z.resize(maxSystemSize);
+	_zNew.resize(maxSystemSize);
+	_zStage.resize(maxSystemSize);
+	_f.resize(maxSystemSize);
+	_fNew.resize(maxSystemSize);
+	_k1.resize(maxSystemSize);
+	_k2.resize(maxSystemSize);
+	_k3.resize(maxSystemSize);
+	_fStage.resize(maxSystemSize);
+	_dfdt.resize(maxSystemSize);
+
+	//Jacobian is always passed as dense matrix (interface of ISolverCaller)
+	_jacobian.assign((size_t)n * n, 0.0);
+	_jacobianRows.resize(n);
+	for (int i = 0; i < n; i++)
+		_jacobianRows[i] = &_jacobian[(size_t)i * n];
+
+	_matrix.assign((size_t)n * n, 0.0);
+	_matrixRows.resize(n);
+	_pivots.resize(n);
+
+	_powerScratch.resize(n);
+
+	ResetIntegrationState();
+
+	_initialized = true;
+}
+
+void SimModelSolverAutoSwitch::ResetIntegrationState ()
+{
+	size_t n = _problemSize;
+
+	_t = _initialTime;
+	_h = 0.0;
+
+	_systemSize = n * (1 + _activeSensitivityParameters.size());
+
+	//blocks behind the active ones stay 0 (see RemoveInactiveSensitivities)
+	std::copy(_initialValues.begin(), _initialValues.end(), _z.begin());
+	std::fill(_z.begin() + n, _z.end(), 0.0);
+	std::fill(_zNew.begin() + _systemSize, _zNew.end(), 0.0);
+	std::fill(_f.begin() + _systemSize, _f.end(), 0.0);
+	std::fill(_fNew.begin() + _systemSize, _fNew.end(), 0.0);
+
+	_fValid = false;
+	_jacobianValid = false;
+
+	_factorizationValid = false;
+	_jacobianAvailable = false;
+	_jacobianCacheLookup = true;
+	_jacobianCacheStore = true;
+	_jacobianFromCache = false;
+
+	_stiff = (_integrationMethod == METHOD_IMPLICIT);
+	_stiffnessCounter = 0;
+	_spectralRadius = 0.0;
+
+	_numberOfMethodSwitches = 0;
+	_numberOfExplicitSteps = 0;
+	_numberOfImplicitSteps = 0;
+
+	_powerVector.assign(n, n > 0 ? 1.0 / sqrt((double)n) : 0.0);
+}
+
+int SimModelSolverAutoSwitch::ReInit (double t0, const std::vector < double > & y0)
+{
+	int retVal = SimModelSolverBase::ReInit(t0, y0);
+	if (retVal != 0)
+		return retVal;
+
+	//last Jacobian before the restart (e.g. for the restart of the next population member at the same time)
+	if (_jacobianCache && _jacobianAvailable)
+		StoreJacobianInCache();
+
+	//sensitivities and integration method are continued; step size is estimated again
+	_t = t0;
+	std::copy(y0.begin(), y0.end(), _z.begin());
+
+	RemoveInactiveSensitivities();
+
+	_h = 0.0;
+	_fValid = false;
+	_jacobianValid = false;
+
+	_factorizationValid = false;
+	_jacobianAvailable = false;
+	_jacobianCacheLookup = true;
+	_jacobianCacheStore = true;
+	_jacobianFromCache = false;
+
+	return AS_SUCCESS;
+}
+
+void SimModelSolverAutoSwitch::RemoveInactiveSensitivities ()
+{
+	std::vector < int > previousParameters(_activeSensitivityParameters);
+
+	if (!DeactivateSensitivityParameters(_t))
+		return;
+
+	size_t n = _problemSize, k = 0;
+
+	for (size_t kPrevious = 0; kPrevious < previousParameters.size(); kPrevious++)
+	{
+		if ((k == _activeSensitivityParameters.size()) || (previousParameters[kPrevious] != _activeSensitivityParameters[k]))
+			continue;
+
+		if (k != kPrevious)
+		{
+			std::copy(_z.begin() + (kPrevious + 1) * n, _z.begin() + (kPrevious + 2) * n, _z.begin() + (k + 1) * n);
+			std::copy(_f.begin() + (kPrevious + 1) * n, _f.begin() + (kPrevious + 2) * n, _f.begin() + (k + 1) * n);
+		}
+		k++;
+	}
+
+	_systemSize = n * (1 + _activeSensitivityParameters.size());
+	std::fill(_z.begin() + _systemSize, _z.end(), 0.0);
+	std::fill(_zNew.begin() + _systemSize, _zNew.end(), 0.0);
+	std::fill(_f.begin() + _systemSize, _f.end(), 0.0);
+	std::fill(_fNew.begin() + _systemSize, _fNew.end(), 0.0);
+}
+
+void SimModelSolverAutoSwitch::ResetForReuse ()
+{
+	if (!_initialized)
+	{
+		Init();
+		return;
+	}
+
+	SimModelSolverBase::Init();
+
+	//work memory is kept
+	ResetIntegrationState();
+}
+
+void SimModelSolverAutoSwitch::Terminate ()
+{
+	_z.clear();
+	_zNew.clear();
+	_zStage.clear();
+	_f.clear();
+	_fNew.clear();
+	_k1.clear();
+	_k2.clear();
+	_k3.clear();
+	_fStage.clear();
+	_dfdt.clear();
+	_jacobian.clear();
+	_jacobianRows.clear();
+	_matrix.clear();
+	_matrixRows.clear();
+	_pivots.clear();
+	_powerVector.clear();
+	_powerScratch.clear();
+
+	_initialized = false;
+}
+
+void SimModelSolverAutoSwitch::SaveSolverState (SimModelSolverState & state)
+{
+	state.WriteDouble(_t);
+	state.WriteDouble(_h);
+	state.WriteBool(_stiff);
+	state.WriteInt(_stiffnessCounter);
+	state.WriteDouble(_spectralRadius);
+	state.WriteVector(_activeSensitivityParameters);
+	state.WriteVector(_z);
+	state.WriteVector(_powerVector);
+}
+
+void SimModelSolverAutoSwitch::RestoreSolverState (const SimModelSolverState & state, size_t & position)
+{
+	_t = state.ReadDouble(position);
+	_h = state.ReadDouble(position);
+	_stiff = state.ReadBool(position);
+	_stiffnessCounter = state.ReadInt(position);
+	_spectralRadius = state.ReadDouble(position);
+	state.ReadVector(position, _activeSensitivityParameters);
+	state.ReadVector(position, _z);
+	state.ReadVector(position, _powerVector);
+
+	_systemSize = (size_t)_problemSize * (1 + _activeSensitivityParameters.size());
+	std::fill(_zNew.begin() + _systemSize, _zNew.end(), 0.0);
+	std::fill(_f.begin() + _systemSize, _f.end(), 0.0);
+	std::fill(_fNew.begin() + _systemSize, _fNew.end(), 0.0);
+
+	//recomputed at the restored point
+	_fValid = false;
+	_jacobianValid = false;
+	_factorizationValid = false;
+	_jacobianAvailable = false;
+	_jacobianFromCache = false;
+}
+
+void SimModelSolverAutoSwitch::GetSolution (double * y, double ** yS)
+{
+	int n = _problemSize, ns = _numberOfSensitivityParameters;
+	size_t numberOfActiveParameters = _activeSensitivityParameters.size();
+
+	for (int i = 0; i < n; i++)
+	{
+		y[i] = _z[i];
+
+		if (yS == NULL)
+			continue;
+
+		for (int j = 0; j < ns; j++)
+			yS[i][j] = 0.0;
+		for (size_t k = 0; k < numberOfActiveParameters; k++)
+			yS[i][_activeSensitivityParameters[k]] = _z[(k + 1) * n + i];
+	}
+}
+
+int SimModelSolverAutoSwitch::PerformSolverStep (double tout, double * y, double ** yS, double & tret)
+{
+	const char * ERROR_SOURCE = "SimModelSolverAutoSwitch::PerformSolverStep";
+
+	if (!_initialized)
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Solver was not initialized");
+
+	//no own root finding: stop at the first root found in the internal steps
+	if (GetNumberOfRootFunctions() > 0)
+		return PerformSolverStepWithRoots(tout, y, yS, tret);
+
+	StartSolverStepStatistics();
+
+	int retVal = AS_SUCCESS;
+	double roundoff = 100.0 * DBL_EPSILON * (fabs(tout) > 1.0 ? fabs(tout) : 1.0);
+	long numberOfSteps = 0;
+	size_t n = _problemSize;
+
+	while (_t < tout - roundoff)
+	{
+		//solution does not change anymore
+		if (_steadyStateReached)
+		{
+			_t = tout;
+			break;
+		}
+
+		if (numberOfSteps >= _mxStep)
+		{
+			retVal = AS_TOO_MUCH_WORK;
+			break;
+		}
+
+		retVal = TakeStep(tout);
+		if (retVal != AS_SUCCESS)
+			break;
+
+		numberOfSteps++;
+
+		//RHS at the new point is known from the last stage (_z, _f: packed blocks of the active parameters)
+		if (_steadyStateDetection)
+			CheckSteadyState(_t, &_z[0], &_f[0], _numberOfSensitivityParameters > 0 ? &_z[0] + n : NULL,
+			                 _numberOfSensitivityParameters > 0 ? &_f[0] + n : NULL, 1, (int)n, &_activeSensitivityParameters);
+	}
+
+	if ((retVal == AS_SUCCESS) && (_t >= tout - roundoff))
+		_t = tout;
+
+	GetSolution(y, yS);
+	ApplySensitivityActivation(_t, yS);
+	tret = _t;
+
+	return retVal;
+}
+
+bool SimModelSolverAutoSwitch::SupportsInternalSteps ()
+{
+	return true;
+}
+
+bool SimModelSolverAutoSwitch::SupportsSensitivityActivation ()
+{
+	return true;
+}
+
+bool SimModelSolverAutoSwitch::SupportsStateSnapshots ()
+{
+	return true;
+}
+
+bool SimModelSolverAutoSwitch::SupportsLinearSolver (LinearSolverType linearSolver)
+{
+	//linear systems of the Rosenbrock method are always solved by LU factorization
+	return linearSolver == LS_DIRECT;
+}
+
+int SimModelSolverAutoSwitch::PerformInternalStep (double tstop, double * y, double ** yS, double & tret)
+{
+	const char * ERROR_SOURCE = "SimModelSolverAutoSwitch::PerformInternalStep";
+
+	if (!_initialized)
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Solver was not initialized");
+
+	int retVal = AS_SUCCESS;
+	double roundoff = 100.0 * DBL_EPSILON * (fabs(tstop) > 1.0 ? fabs(tstop) : 1.0);
+
+	if (_t < tstop - roundoff)
+	{
+		retVal = TakeStep(tstop);
+		if ((retVal == AS_SUCCESS) && (_t >= tstop - roundoff))
+			_t = tstop;
+	}
+
+	GetSolution(y, yS);
+	tret = _t;
+
+	return retVal;
+}
+
+int SimModelSolverAutoSwitch::EvaluateRhs (double t, const double * z, double * f)
+{
+	size_t n = _problemSize;
+	const double * p = _numberOfSensitivityParameters > 0 ? &_sensitivityParametersInitialValues[0] : NULL;
+
+	Rhs_Return_Value rhsRetVal = CallODERhsFunction(t, z, p, f, NULL);
+	if (rhsRetVal == RHS_RECOVERABLE_ERROR)
+		return AS_RECOVERABLE_RHS_FAILURE;
+	if (rhsRetVal != RHS_OK)
+		return AS_RHS_FAILURE;
+
+	if (_activeSensitivityParameters.empty())
+		return AS_SUCCESS;
+
+	Sensitivity_Rhs_Return_Value sensitivityRetVal = CallODESensitivityRhsFunction(t, z, f, z + n, f + n, NULL, _activeSensitivityParameters);
+	if (sensitivityRetVal == SENSITIVITY_RHS_RECOVERABLE_ERROR)
+		return AS_RECOVERABLE_RHS_FAILURE;
+	if (sensitivityRetVal != SENSITIVITY_RHS_OK)
+		return AS_SENSITIVITY_RHS_FAILURE;
+
+	return AS_SUCCESS;
+}
+
+double SimModelSolverAutoSwitch::ErrorNorm (const double * e, const double * zOld, const double * zNew)
+{
+	return SimModelSolverVectorKernels::WeightedRmsNorm(_problemSize, e, zOld, zNew, _relTol, &_absTol[0]);
+}
+
+double SimModelSolverAutoSwitch::InitialStepSize (double tstop)
+{
+	double h = _h0;
+
+	if (h <= 0.0)
+	{
+		//ratio of the weighted norms of y and dy/dt
+		double yNorm = ErrorNorm(&_z[0], &_z[0], &_z[0]);
+		double fNorm = ErrorNorm(&_f[0], &_z[0], &_z[0]);
+
+		h = ((yNorm < 1e-5) || (fNorm < 1e-5)) ? 1e-6 : 0.01 * yNorm / fNorm;
+	}
+
+	double hMax = GetMaxStepSize(_t);
+	if ((hMax > 0.0) && (h > hMax))
+		h = hMax;
+
+	return std::min(h, tstop - _t);
+}
+
+int SimModelSolverAutoSwitch::TakeStep (double tstop)
+{
+	int retVal;
+
+	//(not at the end of the previous step: its end point is needed for the interpolation of sensitivities)
+	RemoveInactiveSensitivities();
+
+	if (!_fValid)
+	{
+		retVal = EvaluateRhs(_t, &_z[0], &_f[0]);
+		if (retVal != AS_SUCCESS)
+			return retVal == AS_RECOVERABLE_RHS_FAILURE ? AS_RHS_FAILURE : retVal;
+
+		_fValid = true;
+	}
+
+	bool restart = (_h <= 0.0);
+
+	//first step after a restart: step size and method of the reference run
+	if (restart)
+	{
+		double h;
+		int order;
+
+		if (GetWarmStartStep(_t, h, order) && (h > 0.0))
+		{
+			_h = h;
+
+			if ((_integrationMethod == METHOD_AUTOMATIC) && (_stiff != (order == IMPLICIT_METHOD_ORDER)))
+			{
+				_stiff = !_stiff;
+				_stiffnessCounter = 0;
+			}
+		}
+	}
+
+	//first step after a restart: Jacobian from the cache, step size of the cached factorization
+	if (_jacobianCacheLookup)
+	{
+		_jacobianCacheLookup = false;
+
+		if (_stiff && _jacobianCache && LoadJacobianFromCache() && restart && _factorizationValid)
+			_h = _factorizationStepSize;
+	}
+
+	if (_h <= 0.0)
+		_h = InitialStepSize(tstop);
+
+	double hMinEffective = std::max(_hMin, 16.0 * DBL_EPSILON * std::max(fabs(_t), fabs(tstop)));
+	double hMax = GetMaxStepSize(_t);
+
+	for (int attempt = 0; ; attempt++)
+	{
+		if (attempt >= MAX_FAILED_ATTEMPTS_PER_STEP)
+			return AS_STEP_SIZE_TOO_SMALL;
+
+		double h = _h;
+		if ((hMax > 0.0) && (h > hMax))
+			h = hMax;
+
+		//last step to tstop is not limited by hMin
+		bool stepToStop = (_t + h >= tstop);
+		if (stepToStop)
+			h = tstop - _t;
+		else if (h < hMinEffective)
+			return AS_STEP_SIZE_TOO_SMALL;
+
+		double errorNorm = 0.0, stiffnessRatio = 0.0;
+
+		retVal = _stiff ? ImplicitStep(h, errorNorm) : ExplicitStep(h, errorNorm, stiffnessRatio);
+
+		if (retVal == AS_RECOVERABLE_RHS_FAILURE)
+		{
+			_h = h * STEP_RECOVERABLE_FAILURE_FACTOR;
+			continue;
+		}
+
+		if (retVal != AS_SUCCESS)
+			return retVal;
+
+		double factor = errorNorm > 0.0 ? STEP_SAFETY_FACTOR * pow(errorNorm, -1.0 / 3.0) : STEP_MAX_FACTOR;
+		factor = std::min(STEP_MAX_FACTOR, std::max(STEP_MIN_FACTOR, factor));
+
+		if (errorNorm > 1.0)
+		{
+			_statistics.NumberOfErrorTestFailures++;
+			_h = h * factor;
+			continue;
+		}
+
+		//step accepted (no step size increase directly after a failure)
+		if (attempt > 0)
+			factor = std::min(factor, 1.0);
+
+		double hNew = h * factor;
+
+		//step shortened to reach tstop: keep the step size proposed before
+		_h = stepToStop ? std::max(_h, hNew) : hNew;
+
+		_t = stepToStop ? tstop : _t + h;
+		_z.swap(_zNew);
+		_f.swap(_fNew);
+		_jacobianValid = false;
+
+		if (_ddeSystem)
+			AddDelayHistoryPoint(_t, &_z[0], &_f[0]);
+
+		if (_stiff)
+		{
+			_numberOfImplicitSteps++;
+			_spectralRadius = EstimateSpectralRadius();
+			stiffnessRatio = h * _spectralRadius;
+		}
+		else
+		{
+			_numberOfExplicitSteps++;
+
+			if ((_integrationMethod == METHOD_AUTOMATIC) && (_numberOfExplicitSteps % EXPLICIT_POWER_ITERATION_INTERVAL == 0))
+				_spectralRadius = EstimateSpectralRadiusMatrixFree();
+
+			stiffnessRatio = std::max(stiffnessRatio, h * _spectralRadius);
+		}
+
+		ReportInternalStep(_t, h, _stiff ? IMPLICIT_METHOD_ORDER : EXPLICIT_METHOD_ORDER);
+
+		UpdateIntegrationMethod(stiffnessRatio);
+
+		return AS_SUCCESS;
+	}
+}
+
+void SimModelSolverAutoSwitch::UpdateIntegrationMethod (double stiffnessRatio)
+{
+	if (_integrationMethod != METHOD_AUTOMATIC)
+		return;
+
+	bool switchIndicated = _stiff ? (stiffnessRatio < NONSTIFF_THRESHOLD) : (stiffnessRatio > STIFF_THRESHOLD);
+
+	_stiffnessCounter = switchIndicated ? _stiffnessCounter + 1 : 0;
+
+	if (_stiffnessCounter < _stiffnessSwitchSteps)
+		return;
+
+	_stiff = !_stiff;
+	_stiffnessCounter = 0;
+	_numberOfMethodSwitches++;
+}
+
+int SimModelSolverAutoSwitch::ExplicitStep (double h, double & errorNorm, double & stiffnessRatio)
+{
+	size_t N = _systemSize, n = _problemSize, i;
+	int retVal;
+
+	const double * f0 = &_f[0];
+
+	//Bogacki-Shampine 3(2): c = (0, 1/2, 3/4, 1), b = (2/9, 1/3, 4/9, 0)
+	SimModelSolverVectorKernels::LinearSum(N, 1.0, &_z[0], 0.5 * h, f0, &_zStage[0]);
+	retVal = EvaluateRhs(_t + 0.5 * h, &_zStage[0], &_k2[0]);
+	if (retVal != AS_SUCCESS)
+		return retVal;
+
+	SimModelSolverVectorKernels::LinearSum(N, 1.0, &_z[0], 0.75 * h, &_k2[0], &_zStage[0]);
+	retVal = EvaluateRhs(_t + 0.75 * h, &_zStage[0], &_k3[0]);
+	if (retVal != AS_SUCCESS)
+		return retVal;
+
+	const double newCoefficients[] = {1.0, 2.0 / 9.0 * h, 1.0 / 3.0 * h, 4.0 / 9.0 * h};
+	const double * newVectors[] = {&_z[0], f0, &_k2[0], &_k3[0]};
+	SimModelSolverVectorKernels::LinearCombination(N, 4, newCoefficients, newVectors, &_zNew[0]);
+	retVal = EvaluateRhs(_t + h, &_zNew[0], &_fNew[0]);
+	if (retVal != AS_SUCCESS)
+		return retVal;
+
+	//difference to the embedded 2nd order solution, b* = (7/24, 1/4, 1/3, 1/8)
+	const double errorCoefficients[] = {-5.0 / 72.0 * h, 1.0 / 12.0 * h, 1.0 / 9.0 * h, -1.0 / 8.0 * h};
+	const double * errorVectors[] = {f0, &_k2[0], &_k3[0], &_fNew[0]};
+	SimModelSolverVectorKernels::LinearCombination(n, 4, errorCoefficients, errorVectors, &_k1[0]);
+	errorNorm = ErrorNorm(&_k1[0], &_z[0], &_zNew[0]);
+
+	//spectral radius estimate from the last two stages (states only, weighted like the
+	//error test: otherwise stiff components with small values are hidden by the large ones)
+	double fDifference = 0.0, zDifference = 0.0;
+	for (i = 0; i < n; i++)
+	{
+		double weight = 1.0 / (_absTol[i] + _relTol * std::max(fabs(_z[i]), fabs(_zNew[i])));
+		double df = weight * (_fNew[i] - _k3[i]), dz = weight * (_zNew[i] - _zStage[i]);
+		fDifference += df * df;
+		zDifference += dz * dz;
+	}
+	stiffnessRatio = zDifference > 0.0 ? h * sqrt(fDifference / zDifference) : 0.0;
+
+	return AS_SUCCESS;
+}
+
+int SimModelSolverAutoSwitch::ImplicitStep (double h, double & errorNorm)
+{
+	size_t N = _systemSize, n = _problemSize;
+	size_t numberOfBlocks = 1 + _activeSensitivityParameters.size();
+	int retVal;
+
+	//Jacobian is kept for repeated attempts from the same point
+	if (!_jacobianValid)
+	{
+		retVal = EvaluateJacobian(h);
+		if (retVal != AS_SUCCESS)
+			return retVal;
+	}
+
+	double hd = h * ROSENBROCK_D;
+
+	retVal = FactorizeIterationMatrix(hd);
+	if (retVal != AS_SUCCESS)
+		return retVal;
+
+	_factorizationStepSize = h;
+
+	//first Jacobian evaluated after a restart
+	if (_jacobianCacheStore && _jacobianCache)
+	{
+		StoreJacobianInCache();
+		_jacobianCacheStore = false;
+	}
+
+	const double * f0 = &_f[0];
+
+	//k1 = W^-1 (f0 + h*d*T)
+	SimModelSolverVectorKernels::LinearSum(N, 1.0, f0, hd, &_dfdt[0], &_k1[0]);
+	SolveLinearSystem(&_k1[0], numberOfBlocks);
+
+	//f1 = f(t + h/2, z + h/2 * k1)
+	SimModelSolverVectorKernels::LinearSum(N, 1.0, &_z[0], 0.5 * h, &_k1[0], &_zStage[0]);
+	retVal = EvaluateRhs(_t + 0.5 * h, &_zStage[0], &_fStage[0]);
+	if (retVal != AS_SUCCESS)
+		return retVal;
+
+	//k2 = W^-1 (f1 - k1) + k1
+	SimModelSolverVectorKernels::LinearSum(N, 1.0, &_fStage[0], -1.0, &_k1[0], &_k2[0]);
+	SolveLinearSystem(&_k2[0], numberOfBlocks);
+	SimModelSolverVectorKernels::Axpy(N, 1.0, &_k1[0], &_k2[0]);
+
+	//z_new = z + h * k2, f2 = f(t + h, z_new)
+	SimModelSolverVectorKernels::LinearSum(N, 1.0, &_z[0], h, &_k2[0], &_zNew[0]);
+	retVal = EvaluateRhs(_t + h, &_zNew[0], &_fNew[0]);
+	if (retVal != AS_SUCCESS)
+		return retVal;
+
+	//k3 = W^-1 (f2 - e32 * (k2 - f1) - 2 * (k1 - f0) + h*d*T) (states only: used for the error estimate)
+	const double k3Coefficients[] = {1.0, -ROSENBROCK_E32, ROSENBROCK_E32, -2.0, 2.0, hd};
+	const double * k3Vectors[] = {&_fNew[0], &_k2[0], &_fStage[0], &_k1[0], f0, &_dfdt[0]};
+	SimModelSolverVectorKernels::LinearCombination(n, 6, k3Coefficients, k3Vectors, &_k3[0]);
+	SolveLinearSystem(&_k3[0], 1);
+
+	//error estimate h/6 * (k1 - 2*k2 + k3)
+	const double errorCoefficients[] = {h / 6.0, -h / 3.0, h / 6.0};
+	const double * errorVectors[] = {&_k1[0], &_k2[0], &_k3[0]};
+	SimModelSolverVectorKernels::LinearCombination(n, 3, errorCoefficients, errorVectors, &_k3[0]);
+	errorNorm = ErrorNorm(&_k3[0], &_z[0], &_zNew[0]);
+
+	return AS_SUCCESS;
+}
+
+int SimModelSolverAutoSwitch::EvaluateJacobian (double h)
+{
+	int n = _problemSize, i, j, retVal;
+	size_t N = _systemSize;
+	const double * p = _numberOfSensitivityParameters > 0 ? &_sensitivityParametersInitialValues[0] : NULL;
+
+	//Jacobian (and factorization) already taken from the cache
+	if (_jacobianFromCache)
+		_jacobianFromCache = false;
+	else
+	{
+		//band solver: entries outside the band stay 0 (callers are allowed to set only the nonzero entries)
+		for (i = 0; i < n; i++)
+		{
+			int jmin = i - _ml > 0 ? i - _ml : 0;
+			int jmax = i + _mu < n - 1 ? i + _mu : n - 1;
+
+			for (j = jmin; j <= jmax; j++)
+				_jacobianRows[i][j] = 0.0;
+		}
+
+		//finite difference Jacobian (by the base class) if the caller provides none
+		if (CallODEJacFunction(_t, &_z[0], p, &_f[0], &_jacobianRows[0], NULL) != JACOBIAN_OK)
+			return AS_JACOBIAN_FAILURE;
+
+		_factorizationValid = false;
+	}
+
+	_jacobianAvailable = true;
+	_jacobianTime = _t;
+
+	//time derivative of the RHS by forward difference (models with dosing are not autonomous)
+	double dt = sqrt(DBL_EPSILON) * std::max(fabs(_t), fabs(_t + h));
+	if (dt <= 0.0)
+		dt = sqrt(DBL_EPSILON);
+
+	retVal = EvaluateRhs(_t + dt, &_z[0], &_dfdt[0]);
+	if (retVal != AS_SUCCESS)
+		return retVal;
+
+	SimModelSolverVectorKernels::LinearSum(N, 1.0 / dt, &_dfdt[0], -1.0 / dt, &_f[0], &_dfdt[0]);
+
+	_jacobianValid = true;
+
+	return AS_SUCCESS;
+}
+
+std::string SimModelSolverAutoSwitch::GetJacobianCacheStructure ()
+{
+	return std::string(typeid(*this).name()) + ";" + std::to_string(_problemSize) + ";" +
+		   (_useBand ? "band;" + std::to_string(_ml) + ";" + std::to_string(_mu) : "dense");
+}
+
+bool SimModelSolverAutoSwitch::LoadJacobianFromCache ()
+{
+	size_t n = _problemSize, i;
+	SimModelSolverJacobianCacheEntry entry;
+
+	if (!_jacobianCache->Lookup(GetJacobianCacheStructure(), _t, GetJacobianCacheParameters(), entry) ||
+		(entry.Jacobian.size() != _jacobian.size()))
+		return false;
+
+	_jacobian = entry.Jacobian;
+	_jacobianFromCache = true;
+	_jacobianValid = false;
+
+	//a Jacobian taken from the cache is not stored again
+	_jacobianCacheStore = false;
+
+	_factorizationValid = (entry.Factorization.size() == _matrix.size()) && (entry.Pivots.size() == _pivots.size()) &&
+		                  (entry.FactorizationScale > 0.0) && (entry.StepSize > 0.0);
+
+	if (_factorizationValid)
+	{
+		//rows of the factorization are stored in pivot order
+		_matrix = entry.Factorization;
+		for (i = 0; i < n; i++)
+			_matrixRows[i] = &_matrix[i * n];
+
+		_pivots = entry.Pivots;
+		_factorizationScale = entry.FactorizationScale;
+		_factorizationStepSize = entry.StepSize;
+	}
+
+	return true;
+}
+
+void SimModelSolverAutoSwitch::StoreJacobianInCache ()
+{
+	size_t n = _problemSize, i;
+	SimModelSolverJacobianCacheEntry entry;
+
+	entry.Structure = GetJacobianCacheStructure();
+	entry.Time = _jacobianTime;
+	entry.Parameters = GetJacobianCacheParameters();
+	entry.Jacobian = _jacobian;
+
+	if (_factorizationValid)
+	{
+		entry.Factorization.resize(n * n);
+		for (i = 0; i < n; i++)
+			std::copy(_matrixRows[i], _matrixRows[i] + n, entry.Factorization.begin() + i * n);
+
+		entry.Pivots = _pivots;
+		entry.FactorizationScale = _factorizationScale;
+		entry.StepSize = _factorizationStepSize;
+	}
+
+	_jacobianCache->Store(entry);
+}
+
+int SimModelSolverAutoSwitch::FactorizeIterationMatrix (double hd)
+{
+	int n = _problemSize, i, j, k;
+
+	//same Jacobian and step size as the last factorization (e.g. taken from the Jacobian cache)
+	if (_factorizationValid && (hd == _factorizationScale))
+		return AS_SUCCESS;
+
+	_factorizationValid = false;
+
+	//W = I - h*d*J
+	for (i = 0; i < n; i++)
+	{
+		_matrixRows[i] = &_matrix[(size_t)i * n];
+
+		int jmin = i - _ml > 0 ? i - _ml : 0;
+		int jmax = i + _mu < n - 1 ? i + _mu : n - 1;
+
+		for (j = jmin; j <= jmax; j++)
+			_matrixRows[i][j] = -hd * _jacobianRows[i][j];
+		_matrixRows[i][i] += 1.0;
+
+		//band LU: clear fill-in of the last factorization (U has upper half band width ml + mu)
+		int jfill = i + _ml + _mu < n - 1 ? i + _ml + _mu : n - 1;
+		for (j = jmax + 1; _useBand && (j <= jfill); j++)
+			_matrixRows[i][j] = 0.0;
+	}
+
+	_statistics.NumberOfLinearSolverSetups++;
+
+	if (_useBand)
+	{
+		//band LU with partial pivoting (as LAPACK dgbtrf): pivots are searched in the ml rows below 
+		//the diagonal; rows are swapped from column k on only, so the multipliers of column k stay 
+		//in rows k+1..k+ml (applied together with the row swaps in SolveLinearSystem)
+		for (k = 0; k < n; k++)
+		{
+			int imax = k + _ml < n - 1 ? k + _ml : n - 1;
+			int jmax = k + _ml + _mu < n - 1 ? k + _ml + _mu : n - 1;
+
+			int pivotRow = k;
+			for (i = k + 1; i <= imax; i++)
+				if (fabs(_matrixRows[i][k]) > fabs(_matrixRows[pivotRow][k]))
+					pivotRow = i;
+
+			if (_matrixRows[pivotRow][k] == 0.0)
+				return AS_SINGULAR_MATRIX;
+
+			_pivots[k] = pivotRow;
+			if (pivotRow != k)
+			{
+				for (j = k; j <= jmax; j++)
+				{
+					double tmp = _matrixRows[k][j];
+					_matrixRows[k][j] = _matrixRows[pivotRow][j];
+					_matrixRows[pivotRow][j] = tmp;
+				}
+			}
+
+			double pivot = _matrixRows[k][k];
+
+			for (i = k + 1; i <= imax; i++)
+			{
+				double l = _matrixRows[i][k] / pivot;
+				_matrixRows[i][k] = l;
+				for (j = k + 1; j <= jmax; j++)
+					_matrixRows[i][j] -= l * _matrixRows[k][j];
+			}
+		}
+
+		_factorizationValid = true;
+		_factorizationScale = hd;
+
+		return AS_SUCCESS;
+	}
+
+	//dense LU with partial pivoting (rows are swapped by swapping row pointers)
+	for (k = 0; k < n; k++)
+	{
+		int pivotRow = k;
+		for (i = k + 1; i < n; i++)
+			if (fabs(_matrixRows[i][k]) > fabs(_matrixRows[pivotRow][k]))
+				pivotRow = i;
+
+		if (_matrixRows[pivotRow][k] == 0.0)
+			return AS_SINGULAR_MATRIX;
+
+		_pivots[k] = pivotRow;
+		if (pivotRow != k)
+		{
+			double * row = _matrixRows[k];
+			_matrixRows[k] = _matrixRows[pivotRow];
+			_matrixRows[pivotRow] = row;
+		}
+
+		for (i = k + 1; i < n; i++)
+		{
+			double l = _matrixRows[i][k] / _matrixRows[k][k];
+			_matrixRows[i][k] = l;
+			for (j = k + 1; j < n; j++)
+				_matrixRows[i][j] -= l * _matrixRows[k][j];
+		}
+	}
+
+	_factorizationValid = true;
+	_factorizationScale = hd;
+
+	return AS_SUCCESS;
+}
+
+void SimModelSolverAutoSwitch::SolveLinearSystem (double * b, size_t numberOfBlocks)
+{
+	int n = _problemSize, i, j;
+
+	//the solution of the states and of every sensitivity parameter is one block
+	for (size_t block = 0; block < numberOfBlocks; block++)
+	{
+		double * x = b + block * n;
+
+		if (_useBand)
+		{
+			//row swaps and multipliers column by column (see FactorizeIterationMatrix)
+			for (j = 0; j < n; j++)
+			{
+				if (_pivots[j] != j)
+				{
+					double tmp = x[j];
+					x[j] = x[_pivots[j]];
+					x[_pivots[j]] = tmp;
+				}
+
+				int imax = j + _ml < n - 1 ? j + _ml : n - 1;
+				for (i = j + 1; i <= imax; i++)
+					x[i] -= _matrixRows[i][j] * x[j];
+			}
+		}
+		else
+		{
+			//apply row permutation
+			for (i = 0; i < n; i++)
+			{
+				if (_pivots[i] != i)
+				{
+					double tmp = x[i];
+					x[i] = x[_pivots[i]];
+					x[_pivots[i]] = tmp;
+				}
+			}
+
+			for (i = 0; i < n; i++)
+			{
+				double sum = x[i];
+				for (j = 0; j < i; j++)
+					sum -= _matrixRows[i][j] * x[j];
+				x[i] = sum;
+			}
+		}
+
+		//U has upper half band width ml + mu (band) resp. n - 1 (dense)
+		int upperBandWidth = _useBand ? _ml + _mu : n - 1;
+
+		for (i = n - 1; i >= 0; i--)
+		{
+			int jmax = i + upperBandWidth < n - 1 ? i + upperBandWidth : n - 1;
+			double sum = x[i];
+			for (j = i + 1; j <= jmax; j++)
+				sum -= _matrixRows[i][j] * x[j];
+			x[i] = sum / _matrixRows[i][i];
+		}
+	}
+}
+
+double SimModelSolverAutoSwitch::EstimateSpectralRadius ()
+{
+	int n = _problemSize, i, j;
+	double radius = 0.0;
+
+	//Jacobian of the accepted step (evaluated at its start point)
+	for (int iteration = 0; iteration < POWER_ITERATIONS; iteration++)
+	{
+		double norm = 0.0;
+
+		for (i = 0; i < n; i++)
+		{
+			int jmin = i - _ml > 0 ? i - _ml : 0;
+			int jmax = i + _mu < n - 1 ? i + _mu : n - 1;
+
+			double sum = 0.0;
+			for (j = jmin; j <= jmax; j++)
+				sum += _jacobianRows[i][j] * _powerVector[j];
+
+			_powerScratch[i] = sum;
+			norm += sum * sum;
+		}
+
+		norm = sqrt(norm);
+
+		//start vector in the null space of J: start again (radius 0 is a valid estimate)
+		if (norm == 0.0)
+		{
+			_powerVector.assign(n, n > 0 ? 1.0 / sqrt((double)n) : 0.0);
+			return 0.0;
+		}
+
+		radius = norm;
+		for (i = 0; i < n; i++)
+			_powerVector[i] = _powerScratch[i] / norm;
+	}
+
+	return radius;
+}
+
+double SimModelSolverAutoSwitch::EstimateSpectralRadiusMatrixFree ()
+{
+	int n = _problemSize, i;
+	double zNorm = 0.0;
+
+	for (i = 0; i < n; i++)
+		zNorm += _z[i] * _z[i];
+
+	//J*v by a forward difference of the RHS (states only) at the current point
+	double delta = sqrt(DBL_EPSILON) * std::max(1.0, sqrt(zNorm));
+
+	for (i = 0; i < n; i++)
+		_zStage[i] = _z[i] + delta * _powerVector[i];
+
+	const double * p = _numberOfSensitivityParameters > 0 ? &_sensitivityParametersInitialValues[0] : NULL;
+
+	//failure of the additional evaluation is not an error of the step: keep the last estimate
+	if (CallODERhsFunction(_t, &_zStage[0], p, &_fStage[0], NULL) != RHS_OK)
+		return _spectralRadius;
+
+	double norm = 0.0;
+	for (i = 0; i < n; i++)
+	{
+		_powerScratch[i] = (_fStage[i] - _f[i]) / delta;
+		norm += _powerScratch[i] * _powerScratch[i];
+	}
+
+	norm = sqrt(norm);
+
+	if (norm == 0.0)
+	{
+		_powerVector.assign(n, n > 0 ? 1.0 / sqrt((double)n) : 0.0);
+		return 0.0;
+	}
+
+	for (i = 0; i < n; i++)
+		_powerVector[i] = _powerScratch[i] / norm;
+
+	return norm;
+}
+
+std::string SimModelSolverAutoSwitch::GetSolverErrMsg (int solverRetVal)
+{
+	switch (solverRetVal)
+	{
+		case AS_SUCCESS:
+			return "Success";
+		case AS_TOO_MUCH_WORK:
+			return "Max. number of internal steps reached";
+		case AS_RHS_FAILURE:
+			return "RHS function failed";
+		case AS_JACOBIAN_FAILURE:
+			return "Jacobian function failed";
+		case AS_SINGULAR_MATRIX:
+			return "Iteration matrix is singular";
+		case AS_SENSITIVITY_RHS_FAILURE:
+			return "Sensitivity RHS function failed";
+		case AS_STEP_SIZE_TOO_SMALL:
+			return "Step size became too small (repeated error test failures)";
+		default:
+			return "Unknown error";
+	}
+}
+
+SimModelSolverErrorData::errNumber SimModelSolverAutoSwitch::GetErrorNumberFromSolverReturnValue (int solverRetVal)
+{
+	switch (solverRetVal)
+	{
+		case AS_SUCCESS:
+			return SimModelSolverErrorData::err_OK;
+		case AS_TOO_MUCH_WORK:
+			return SimModelSolverErrorData::err_TOO_MUCH_WORK;
+		case AS_SINGULAR_MATRIX:
+			return SimModelSolverErrorData::err_CONV_FAILURE;
+		case AS_STEP_SIZE_TOO_SMALL:
+			return SimModelSolverErrorData::err_TEST_FAILURE;
+		default:
+			return SimModelSolverErrorData::err_FAILURE;
+	}
+}
@@ -1,87 +1,2387 @@
 #include "SimModelSolverBase/SimModelSolverBase.h"
+#include "SimModelSolverBase/SimModelSolverVectorKernels.h"
+#include <cmath>
+#include <cfloat>
+#include <algorithm>
+#include <utility>
+#include <chrono>
+#include <typeinfo>
+
+//names of options handled by the base class
+const char * const OPTION_LINEAR_SOLVER = "LinearSolver";
+const char * const OPTION_KRYLOV_MAX_DIMENSION = "KrylovMaxDimension";
+const char * const OPTION_JACOBIAN_SPARSITY_PROBING = "JacobianSparsityProbing";
+const char * const OPTION_MAX_DELAY = "MaxDelay";
+const char * const OPTION_MAX_DELAY_HISTORY_POINTS = "MaxDelayHistoryPoints";
+const char * const OPTION_ADJOINT_CHECKPOINT_INTERVAL = "AdjointCheckpointInterval";
+const char * const OPTION_STEADY_STATE_DETECTION = "SteadyStateDetection";
+const char * const OPTION_STEADY_STATE_TOLERANCE = "SteadyStateTolerance";
+
+//format version of solver state snapshots (SaveState/RestoreState)
+const int SOLVER_STATE_VERSION = 4;
+
+//number of output times buffered by PerformSolverStepsToSink
+const int OUTPUT_SINK_CHUNK_SIZE = 32;
+
+//default max. number of DDE history points (bounds the memory if the max. delay is not set)
+const int DEFAULT_MAX_DELAY_HISTORY_POINTS = 10000;
+
+//default steady state threshold: y changes by less than 1% of its error tolerance per time unit
+const double DEFAULT_STEADY_STATE_TOLERANCE = 0.01;
+
+//wall clock time used for callback timings
+static double CurrentTimeInSeconds ()
+{
+	return std::chrono::duration < double > (std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//LU factorization with partial pivoting of the dense matrix given by its rows (rows are swapped);
+//zero entries below the pivot are skipped, so band matrices are factorized in O(n^2) instead of O(n^3).
+//Returns false if the matrix is singular
+static bool FactorizeDenseMatrix (int n, double * * rows, int * pivots)
+{
+	for (int k = 0; k < n; k++)
+	{
+		int pivotRow = k;
+		for (int i = k + 1; i < n; i++)
+			if (fabs(rows[i][k]) > fabs(rows[pivotRow][k]))
+				pivotRow = i;
+
+		if (rows[pivotRow][k] == 0.0)
+			return false;
+
+		pivots[k] = pivotRow;
+		std::swap(rows[k], rows[pivotRow]);
+
+		for (int i = k + 1; i < n; i++)
+		{
+			if (rows[i][k] == 0.0)
+				continue;
+
+			double factor = rows[i][k] / rows[k][k];
+			rows[i][k] = factor;
+
+			for (int j = k + 1; j < n; j++)
+				rows[i][j] -= factor * rows[k][j];
+		}
+	}
+
+	return true;
+}
+
+//Solve LU x = P b in place
+static void SolveDenseSystem (int n, double * const * rows, const int * pivots, double * b)
+{
+	int i, j;
+
+	for (i = 0; i < n; i++)
+	{
+		std::swap(b[i], b[pivots[i]]);
+
+		for (j = 0; j < i; j++)
+			b[i] -= rows[i][j] * b[j];
+	}
+
+	for (i = n - 1; i >= 0; i--)
+	{
+		for (j = i + 1; j < n; j++)
+			b[i] -= rows[i][j] * b[j];
+
+		b[i] /= rows[i][i];
+	}
+}
 
 SimModelSolverBase::SimModelSolverBase(ISolverCaller * pSolverCaller, int problemSize, int numberOfSensitivityParameters)
 {
-	//Save pointer to the solver caller instance
-	//Use dynamic_cast to assure that the right pointer is passed
-	_solverCaller = dynamic_cast <ISolverCaller *> (pSolverCaller);
+	//Save pointer to the solver caller instance
+	//Use dynamic_cast to assure that the right pointer is passed
+	_solverCaller = dynamic_cast <ISolverCaller *> (pSolverCaller);
+
+	_problemSize = 0;
+	this->SetProblemSize(problemSize);
+	
+	_numberOfSensitivityParameters = 0;
+	this->SetNumberOfSensitivityParameters(numberOfSensitivityParameters);
+
+	_initialTime = 0.0;
+	_relTol = 1e-9;
+	
+	//default properties for ODE/DDE solver: 
+	//  - min/max/initial internal step
+	//  - max. no. of internal steps for the solver to reach the next output time point
+	_mxStep = 100000;
+	_h0 = 1e-10;
+	_hMin = 0.;
+	_hMax = 60;
+	
+	//Init-routine eas not called yet
+	_initialized = false;
+	
+	_delaysSize = 0;
+	_ddeSystem = false;
+	_maxDelay = 0.0;
+	_maxNumberOfDelayHistoryPoints = DEFAULT_MAX_DELAY_HISTORY_POINTS;
+
+	_adjointCheckpointInterval = 100;
+	_adjointForwardPassValid = false;
+	_adjointFinalTime = 0.0;
+
+	_steadyStateDetection = false;
+	_steadyStateTolerance = DEFAULT_STEADY_STATE_TOLERANCE;
+	_steadyStateSensitivities = false;
+	_steadyStateReached = false;
+	_steadyStateTime = 0.0;
+
+	//no batch mode by default
+	_batchSize = 1;
+	_batchSolverCaller = dynamic_cast <ISolverCallerBatch *> (pSolverCaller);
+
+	_jacobianSparsityFormat = SPARSE_CSC;
+
+	//direct linear solver by default; 0 = use solver specific default Krylov dimension
+	_linearSolver = LS_DIRECT;
+	_krylovMaxDimension = 0;
+
+	_jacobianSparsityProbing = false;
+	_fdJacobianPatternProbed = false;
+	_fdJacobianNumberOfColors = 0;
+
+	_denseOutputValid = false;
+
+	_numberOfRootFunctions = 0;
+	_rootFound = false;
+	_rootTime = 0.0;
+	_rootScanValid = false;
+	_rootScanTime = 0.0;
+
+	_collectCallbackTimings = false;
+	_stepObserver = NULL;
+
+	_jacobianCache = NULL;
+
+	_stepSizeProfile = NULL;
+	_stepSizeProfileRecording = NULL;
+	_stepSizeProfileMaxStepFactor = 10.0;
+}
+
+SimModelSolverBase::~SimModelSolverBase ()
+{
+}
+
+ISolverCaller * SimModelSolverBase::GetSolverCaller ()
+{
+	return _solverCaller;
+}
+
+void SimModelSolverBase::Init ()
+{
+	const char * ERROR_SOURCE = "SimModelSolverInterface::Init";
+
+	//general checks
+	if (!_solverCaller) //should never happen
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE,"Invalid pointer to the solver caller instance passed!");
+	
+	if (_problemSize == 0)
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE,"Invalid number of absolute tolerances passed");
+
+	if ((long)_absTol.size() != _problemSize)
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE,"Number of absolute tolerances differs from problem size");
+
+	if (_batchSize > 1)
+	{
+		if (!SupportsBatchMode())
+			throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE,"Batch mode is not supported by the solver");
+
+		if ((long)_batchInitialValues.size() != (long)_problemSize * _batchSize)
+			throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE,"Number of batch initial value components differs from problem size * batch size");
+
+		if ((long)_batchSensitivityParametersInitialValues.size() != (long)_numberOfSensitivityParameters * _batchSize)
+			throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Number of batch sensitivity parameters initial values differs from the number of sensitivity parameters * batch size");
+	}
+	else
+	{
+		if ((long)_initialValues.size() != _problemSize)
+			throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE,"Number of initial value components differs from problem size");	
+
+		if ((long)_sensitivityParametersInitialValues.size() != _numberOfSensitivityParameters)
+			throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Number of sensitivity parameters initial values differs from the number of sensitivity parameters");
+	}
+
+	if (!SupportsLinearSolver(_linearSolver))
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE,"Linear solver is not supported by the solver");
+
+	//sensitivity subsets
+	bool sensitivitySubsets = !_sensitivityWindowEndTimes.empty() ||
+		(std::find(_sensitivityParametersActive.begin(), _sensitivityParametersActive.end(), false) != _sensitivityParametersActive.end());
+
+	if (sensitivitySubsets && !SupportsSensitivityActivation())
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE,"Sensitivity subsets are not supported by the solver");
+
+	_sensitivityParametersActivationPending.assign(_numberOfSensitivityParameters, false);
+
+	_activeSensitivityParameters.clear();
+	for (int iS = 0; iS < _numberOfSensitivityParameters; iS++)
+		if (IsSensitivityParameterNeeded(iS, _initialTime))
+			_activeSensitivityParameters.push_back(iS);
+
+	_statistics.Clear();
+	_statisticsAtSolverStepStart.Clear();
+
+	LoadJacobianSparsityPattern();
+	SetupFiniteDifferenceJacobian();
+
+	//dense output restarts from the initial state
+	_denseOutputValid = false;
+
+	//root functions
+	_numberOfRootFunctions = _solverCaller->IsSet_ODERootFunction() ? _solverCaller->GetNumberOfRootFunctions() : 0;
+	if (_numberOfRootFunctions < 0)
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE,"Invalid number of root functions");
+
+	_rootsFound.assign(_numberOfRootFunctions, 0);
+	_rootScanValues.resize(_numberOfRootFunctions);
+	_rootScratchG.resize(_numberOfRootFunctions);
+	_rootScratchGHigh.resize(_numberOfRootFunctions);
+	_rootFound = false;
+	_rootScanValid = false;
+
+	_ddeSystem = _solverCaller->IsSet_DDERhsFunction();
+	InitDelayHistory(false);
+
+	_adjointForwardPassValid = false;
+	_steadyStateReached = false;
+
+	if (_stepSizeProfileRecording)
+	{
+		if (_stepSizeProfileRecording == _stepSizeProfile)
+			throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE,"Step size profile used for the warm start cannot be recorded");
+
+		_stepSizeProfileRecording->Clear();
+		_stepSizeProfileRecording->StartSegment(_initialTime);
+	}
+
+	//solver dependent checks MUST be called by the routine of inherited class,
+	//which also MUST set _initialized = true in case of success
+}
+
+void SimModelSolverBase::LoadJacobianSparsityPattern ()
+{
+	const char * ERROR_SOURCE = "SimModelSolverBase::LoadJacobianSparsityPattern";
+
+	_jacobianSparsityIndexPointers.clear();
+	_jacobianSparsityIndexValues.clear();
+
+	if (!_solverCaller->IsSet_ODESparseJacFunction())
+		return;
+
+	_jacobianSparsityFormat = _solverCaller->GetSparseJacobianFormat();
+
+	int numberOfNonZeros = _solverCaller->GetSparseJacobianNumberOfNonZeros();
+	if ((numberOfNonZeros < 0) || ((double)numberOfNonZeros > (double)_problemSize * _problemSize))
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE,"Invalid number of nonzeros of the sparse Jacobian");
+
+	_jacobianSparsityIndexPointers.resize(_problemSize + 1, 0);
+	_jacobianSparsityIndexValues.resize(numberOfNonZeros > 0 ? numberOfNonZeros : 1, 0);
+
+	_solverCaller->GetSparseJacobianPattern(&_jacobianSparsityIndexPointers[0], &_jacobianSparsityIndexValues[0]);
+	_jacobianSparsityIndexValues.resize(numberOfNonZeros);
+
+	//pattern must be a valid compressed sparse matrix with sorted, unique indices
+	if ((_jacobianSparsityIndexPointers[0] != 0) || (_jacobianSparsityIndexPointers[_problemSize] != numberOfNonZeros))
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE,"Invalid index pointers of the sparse Jacobian");
+
+	for (int k = 0; k < _problemSize; k++)
+	{
+		if (_jacobianSparsityIndexPointers[k] > _jacobianSparsityIndexPointers[k + 1])
+			throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE,"Invalid index pointers of the sparse Jacobian");
+
+		for (int idx = _jacobianSparsityIndexPointers[k]; idx < _jacobianSparsityIndexPointers[k + 1]; idx++)
+		{
+			int index = _jacobianSparsityIndexValues[idx];
+
+			if ((index < 0) || (index >= _problemSize))
+				throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE,"Invalid index in sparsity pattern of the Jacobian");
+
+			if ((idx > _jacobianSparsityIndexPointers[k]) && (index <= _jacobianSparsityIndexValues[idx - 1]))
+				throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE,"Indices in sparsity pattern of the Jacobian must be sorted and unique");
+		}
+	}
+}
+
+void SimModelSolverBase::SetupFiniteDifferenceJacobian ()
+{
+	int n = _problemSize, i, j;
+
+	if (_solverCaller->IsSet_ODEJacFunction())
+	{
+		_fdJacobianNumberOfColors = 0;
+		_fdJacobianPatternProbed = false;
+		return;
+	}
+
+	if (_solverCaller->IsSet_ODESparseJacFunction())
+	{
+		//sparse pattern of the caller (convert CSR to CSC if required)
+		if (_jacobianSparsityFormat == SPARSE_CSC)
+		{
+			_fdJacobianColumnPointers = _jacobianSparsityIndexPointers;
+			_fdJacobianRowIndices = _jacobianSparsityIndexValues;
+		}
+		else
+		{
+			_fdJacobianColumnPointers.assign(n + 1, 0);
+			_fdJacobianRowIndices.resize(_jacobianSparsityIndexValues.size());
+
+			for (size_t idx = 0; idx < _jacobianSparsityIndexValues.size(); idx++)
+				_fdJacobianColumnPointers[_jacobianSparsityIndexValues[idx] + 1]++;
+			for (j = 0; j < n; j++)
+				_fdJacobianColumnPointers[j + 1] += _fdJacobianColumnPointers[j];
+
+			std::vector < int > nextPosition(_fdJacobianColumnPointers.begin(), _fdJacobianColumnPointers.end() - 1);
+			for (i = 0; i < n; i++)
+				for (int idx = _jacobianSparsityIndexPointers[i]; idx < _jacobianSparsityIndexPointers[i + 1]; idx++)
+					_fdJacobianRowIndices[nextPosition[_jacobianSparsityIndexValues[idx]]++] = i;
+		}
+		_fdJacobianPatternProbed = false;
+	}
+	else if (_solverCaller->UseBandLinearSolver())
+	{
+		int ml = _solverCaller->GetLowerHalfBandWidth();
+		int mu = _solverCaller->GetUpperHalfBandWidth();
+
+		_fdJacobianColumnPointers.assign(1, 0);
+		_fdJacobianRowIndices.clear();
+
+		for (j = 0; j < n; j++)
+		{
+			for (i = std::max(0, j - mu); i <= std::min(n - 1, j + ml); i++)
+				_fdJacobianRowIndices.push_back(i);
+			_fdJacobianColumnPointers.push_back((int)_fdJacobianRowIndices.size());
+		}
+		_fdJacobianPatternProbed = false;
+	}
+	else if (_jacobianSparsityProbing)
+	{
+		//pattern of a previous Init can be reused (e.g. ResetForReuse)
+		if (!_fdJacobianPatternProbed || ((int)_fdJacobianColumnPointers.size() != n + 1))
+			ProbeJacobianSparsityPattern();
+	}
+	else
+	{
+		//dense
+		_fdJacobianColumnPointers.resize(n + 1);
+		_fdJacobianRowIndices.resize((size_t)n * n);
+
+		for (j = 0; j <= n; j++)
+			_fdJacobianColumnPointers[j] = j * n;
+		for (j = 0; j < n; j++)
+			for (i = 0; i < n; i++)
+				_fdJacobianRowIndices[(size_t)j * n + i] = i;
+		_fdJacobianPatternProbed = false;
+	}
+
+	//group columns by color
+	std::vector < int > colors;
+	_fdJacobianNumberOfColors = ColorJacobianColumns(n, _fdJacobianColumnPointers, _fdJacobianRowIndices, colors);
+
+	_fdJacobianColorPointers.assign(_fdJacobianNumberOfColors + 1, 0);
+	_fdJacobianColorColumns.resize(n);
+
+	for (j = 0; j < n; j++)
+		_fdJacobianColorPointers[colors[j] + 1]++;
+	for (int c = 0; c < _fdJacobianNumberOfColors; c++)
+		_fdJacobianColorPointers[c + 1] += _fdJacobianColorPointers[c];
+
+	std::vector < int > nextPosition(_fdJacobianColorPointers.begin(), _fdJacobianColorPointers.end() - 1);
+	for (j = 0; j < n; j++)
+		_fdJacobianColorColumns[nextPosition[colors[j]]++] = j;
+
+	_fdJacobianYPerturbed.resize(n);
+	_fdJacobianFPerturbed.resize(n);
+	_fdJacobianFReference.resize(n);
+	_fdJacobianIncrements.resize(n);
+}
+
+void SimModelSolverBase::ProbeJacobianSparsityPattern ()
+{
+	const char * ERROR_SOURCE = "SimModelSolverBase::ProbeJacobianSparsityPattern";
+
+	int n = _problemSize, i, j;
+	const double * p = _numberOfSensitivityParameters > 0 ? &_sensitivityParametersInitialValues[0] : NULL;
+
+	//probe at a point near the initial values with distinct components, 
+	//so that structural nonzeros are not hidden by zero initial values
+	std::vector < double > y(n), f(n), yPerturbed(n), fPerturbed(n);
+	for (j = 0; j < n; j++)
+		y[j] = _initialValues[j] + 1e-3 * (fabs(_initialValues[j]) + 1.0) * (1.0 + (j % 7) / 7.0);
+
+	if (CallODERhsFunction(_initialTime, &y[0], p, &f[0], NULL) != RHS_OK)
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "RHS evaluation failed while probing the sparsity pattern of the Jacobian");
+
+	_fdJacobianColumnPointers.assign(1, 0);
+	_fdJacobianRowIndices.clear();
+	yPerturbed = y;
+
+	for (j = 0; j < n; j++)
+	{
+		double increment = 1e-4 * (fabs(y[j]) + 1.0);
+		yPerturbed[j] = y[j] + increment;
+
+		if (CallODERhsFunction(_initialTime, &yPerturbed[0], p, &fPerturbed[0], NULL) != RHS_OK)
+			throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "RHS evaluation failed while probing the sparsity pattern of the Jacobian");
+
+		//diagonal is always part of the pattern (iteration matrix I - gamma * J)
+		for (i = 0; i < n; i++)
+			if ((i == j) || (fPerturbed[i] != f[i]))
+				_fdJacobianRowIndices.push_back(i);
+
+		_fdJacobianColumnPointers.push_back((int)_fdJacobianRowIndices.size());
+		yPerturbed[j] = y[j];
+	}
+
+	_fdJacobianPatternProbed = true;
+}
+
+int SimModelSolverBase::ColorJacobianColumns (int n, const std::vector < int > & columnPointers, 
+	                                          const std::vector < int > & rowIndices, std::vector < int > & colors)
+{
+	int i, j, idx;
+
+	colors.assign(n, -1);
+
+	//row -> columns structure (CSR of the pattern)
+	std::vector < int > rowPointers(n + 1, 0), columnIndices(rowIndices.size());
+	for (j = 0; j < n; j++)
+		for (idx = columnPointers[j]; idx < columnPointers[j + 1]; idx++)
+			rowPointers[rowIndices[idx] + 1]++;
+	for (i = 0; i < n; i++)
+		rowPointers[i + 1] += rowPointers[i];
+
+	std::vector < int > nextPosition(rowPointers.begin(), rowPointers.end() - 1);
+	for (j = 0; j < n; j++)
+		for (idx = columnPointers[j]; idx < columnPointers[j + 1]; idx++)
+			columnIndices[nextPosition[rowIndices[idx]]++] = j;
+
+	//columns with most nonzeros first
+	std::vector < std::pair < int, int > > order(n);
+	for (j = 0; j < n; j++)
+		order[j] = std::make_pair(-(columnPointers[j + 1] - columnPointers[j]), j);
+	std::sort(order.begin(), order.end());
+
+	//forbiddenFor[c] == j: color c is used by a neighbour of column j
+	std::vector < int > forbiddenFor(n + 1, -1);
+	int numberOfColors = 0;
+
+	for (int k = 0; k < n; k++)
+	{
+		j = order[k].second;
+
+		for (idx = columnPointers[j]; idx < columnPointers[j + 1]; idx++)
+		{
+			int row = rowIndices[idx];
+			for (int rowIdx = rowPointers[row]; rowIdx < rowPointers[row + 1]; rowIdx++)
+			{
+				int neighbourColor = colors[columnIndices[rowIdx]];
+				if (neighbourColor >= 0)
+					forbiddenFor[neighbourColor] = j;
+			}
+		}
+
+		int color = 0;
+		while (forbiddenFor[color] == j)
+			color++;
+
+		colors[j] = color;
+		numberOfColors = std::max(numberOfColors, color + 1);
+	}
+
+	return numberOfColors;
+}
+
+Jacobian_Return_Value SimModelSolverBase::FiniteDifferenceJacobian (double t, const double * y, const double * p, const double * fy, 
+	                                                                double * * Jacobian)
+{
+	int n = _problemSize, i, j, idx;
+
+	if ((int)_fdJacobianColorColumns.size() != n)
+		return JACOBIAN_FAILED; //Init was not called
+
+	//RHS at (t, y) is required as reference
+	if (!fy)
+	{
+		Rhs_Return_Value rhsRetVal = CallODERhsFunction(t, y, p, &_fdJacobianFReference[0], NULL);
+		if (rhsRetVal != RHS_OK)
+			return rhsRetVal == RHS_FAILED ? JACOBIAN_FAILED : JACOBIAN_RECOVERABLE_ERROR;
+
+		fy = &_fdJacobianFReference[0];
+	}
+
+	for (j = 0; j < n; j++)
+	{
+		_fdJacobianYPerturbed[j] = y[j];
+
+		//increment relative to the size of y_j (or of the absolute tolerance, if y_j is small)
+		double scale = std::max(fabs(y[j]), _relTol > 0.0 ? _absTol[j] / _relTol : _absTol[j]);
+		if (scale <= 0.0)
+			scale = 1.0;
+
+		_fdJacobianIncrements[j] = sqrt(DBL_EPSILON) * scale;
+	}
+
+	for (int color = 0; color < _fdJacobianNumberOfColors; color++)
+	{
+		int first = _fdJacobianColorPointers[color], last = _fdJacobianColorPointers[color + 1];
+
+		for (idx = first; idx < last; idx++)
+		{
+			j = _fdJacobianColorColumns[idx];
+			_fdJacobianYPerturbed[j] = y[j] + _fdJacobianIncrements[j];
+
+			//use the increment which is really representable
+			_fdJacobianIncrements[j] = _fdJacobianYPerturbed[j] - y[j];
+		}
+
+		Rhs_Return_Value rhsRetVal = CallODERhsFunction(t, &_fdJacobianYPerturbed[0], p, &_fdJacobianFPerturbed[0], NULL);
+		if (rhsRetVal != RHS_OK)
+			return rhsRetVal == RHS_FAILED ? JACOBIAN_FAILED : JACOBIAN_RECOVERABLE_ERROR;
+
+		for (idx = first; idx < last; idx++)
+		{
+			j = _fdJacobianColorColumns[idx];
+
+			for (int rowIdx = _fdJacobianColumnPointers[j]; rowIdx < _fdJacobianColumnPointers[j + 1]; rowIdx++)
+			{
+				i = _fdJacobianRowIndices[rowIdx];
+				Jacobian[i][j] = (_fdJacobianFPerturbed[i] - fy[i]) / _fdJacobianIncrements[j];
+			}
+
+			_fdJacobianYPerturbed[j] = y[j];
+		}
+	}
+
+	return JACOBIAN_OK;
+}
+
+int SimModelSolverBase::GetNumberOfJacobianColors ()
+{
+	return _fdJacobianNumberOfColors;
+}
+
+bool SimModelSolverBase::GetJacobianSparsityProbing ()
+{
+	return _jacobianSparsityProbing;
+}
+
+void SimModelSolverBase::SetJacobianSparsityProbing (bool jacobianSparsityProbing)
+{
+	if (_jacobianSparsityProbing == jacobianSparsityProbing)
+		return; //nothing to do
+
+	_jacobianSparsityProbing = jacobianSparsityProbing;
+	_fdJacobianPatternProbed = false;
+
+	//pattern must be set up again
+	_initialized = false;
+}
+
+int SimModelSolverBase::ReInit (double t0, const std::vector < double > & y0)
+{
+	const char * ERROR_SOURCE = "SimModelSolverInterface::ReInit";
+	
+	//check Initialized status
+	if (!_initialized)
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE,"Solver was not initialized");
+	
+	//set new initial value (batch mode: initial values of all problems, structure-of-arrays)
+	if (_batchSize > 1)
+	{
+		if ((long)y0.size() != (long)_problemSize * _batchSize)
+			throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE,"Batch initial value has invalid number of components");	
+		_batchInitialValues = y0;
+	}
+	else
+	{
+		if ((long)y0.size() != _problemSize)
+			throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE,"Initial value has invalid number of components");	
+		_initialValues = y0;
+	}
+	
+	//set new start time
+	_initialTime = t0;
+
+	//dense output restarts from the new initial state
+	_denseOutputValid = false;
+
+	//root search restarts from the new initial state
+	_rootFound = false;
+	_rootScanValid = false;
+
+	//delayed values before t0 are taken from the previous solution
+	InitDelayHistory(true);
+
+	_adjointForwardPassValid = false;
+	_steadyStateReached = false;
+
+	if (_stepSizeProfileRecording)
+		_stepSizeProfileRecording->StartSegment(t0);
+	
+	return SimModelSolverErrorData::err_OK;
+	
+	//Solver-dependent reinit will be performed by inherited class
+	//(which must call SimModelSolverInterface::ReInit first!)
+}
+
+void SimModelSolverBase::ResetForReuse ()
+{
+	if (_initialized)
+		Terminate();
+
+	Init();
+}
+
+bool SimModelSolverBase::IsInitialized ()
+{
+	return _initialized;
+}
+
+SimModelSolverState SimModelSolverBase::SaveState ()
+{
+	SimModelSolverState state;
+	SaveState(state);
+
+	return state;
+}
+
+void SimModelSolverBase::SaveState (SimModelSolverState & state)
+{
+	const char * ERROR_SOURCE = "SimModelSolverBase::SaveState";
+
+	if (!_initialized)
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Solver was not initialized");
+
+	state.Clear();
+
+	//header: format version, solver type, problem dimensions
+	std::string solverType = typeid(*this).name();
+	state.WriteInt(SOLVER_STATE_VERSION);
+	state.WriteLong((long)solverType.size());
+	state.WriteBytes(solverType.c_str(), solverType.size());
+	state.WriteInt(_problemSize);
+	state.WriteInt(_numberOfSensitivityParameters);
+
+	state.WriteDouble(_initialTime);
+	state.WriteVector(_initialValues);
+
+	//dense output (derivatives are recomputed on demand)
+	state.WriteBool(_denseOutputValid);
+	for (int i = 0; i < 2; i++)
+	{
+		state.WriteDouble(_denseT[i]);
+		state.WriteVector(_denseY[i]);
+		state.WriteVector(_denseYS[i]);
+	}
+
+	//root search
+	state.WriteBool(_rootFound);
+	state.WriteDouble(_rootTime);
+	state.WriteVector(_rootsFound);
+	state.WriteVector(_rootSolution);
+	state.WriteBool(_rootScanValid);
+	state.WriteDouble(_rootScanTime);
+	state.WriteVector(_rootScanValues);
+
+	state.WriteBool(_steadyStateReached);
+	state.WriteDouble(_steadyStateTime);
+	state.WriteVector(_steadyStateValues);
+	state.WriteVector(_steadyStateSensitivityValues);
+
+	state.WriteBytes(&_statistics, sizeof(_statistics));
+
+	_delayHistory.SaveState(state);
+
+	SaveSolverState(state);
+}
+
+void SimModelSolverBase::RestoreState (const SimModelSolverState & state)
+{
+	const char * ERROR_SOURCE = "SimModelSolverBase::RestoreState";
+
+	if (!_initialized)
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Solver was not initialized");
+
+	size_t position = 0;
+
+	if (state.ReadInt(position) != SOLVER_STATE_VERSION)
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Unsupported solver state version");
+
+	long typeNameSize = state.ReadLong(position);
+	if ((typeNameSize < 0) || ((size_t)typeNameSize > state.GetSize() - position))
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Invalid solver state");
+
+	std::string solverType((const char *)state.GetData() + position, typeNameSize);
+	position += typeNameSize;
+
+	if (solverType != typeid(*this).name())
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Solver state was saved by another solver type");
+
+	int problemSize = state.ReadInt(position);
+	int numberOfSensitivityParameters = state.ReadInt(position);
+
+	if ((problemSize != _problemSize) || (numberOfSensitivityParameters != _numberOfSensitivityParameters))
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Solver state has different problem dimensions");
+
+	//everything is read into temporaries first and committed only if the complete snapshot could be read,
+	//so the solver keeps its previous state if the snapshot is invalid
+	double initialTime = state.ReadDouble(position);
+	std::vector < double > initialValues;
+	state.ReadVector(position, initialValues);
+
+	bool denseOutputValid = state.ReadBool(position);
+	double denseT[2];
+	std::vector < double > denseY[2], denseYS[2];
+	for (int i = 0; i < 2; i++)
+	{
+		denseT[i] = state.ReadDouble(position);
+		state.ReadVector(position, denseY[i]);
+		state.ReadVector(position, denseYS[i]);
+	}
+
+	bool rootFound = state.ReadBool(position);
+	double rootTime = state.ReadDouble(position);
+	std::vector < int > rootsFound;
+	state.ReadVector(position, rootsFound);
+	std::vector < double > rootSolution;
+	state.ReadVector(position, rootSolution);
+	bool rootScanValid = state.ReadBool(position);
+	double rootScanTime = state.ReadDouble(position);
+	std::vector < double > rootScanValues;
+	state.ReadVector(position, rootScanValues);
+
+	bool steadyStateReached = state.ReadBool(position);
+	double steadyStateTime = state.ReadDouble(position);
+	std::vector < double > steadyStateValues, steadyStateSensitivityValues;
+	state.ReadVector(position, steadyStateValues);
+	state.ReadVector(position, steadyStateSensitivityValues);
+
+	SolverStatistics statistics;
+	state.ReadBytes(position, &statistics, sizeof(statistics));
+
+	if ((initialValues.size() != (size_t)_problemSize) || (steadyStateValues.size() > (size_t)_problemSize))
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Invalid solver state");
+
+	SimModelSolverDelayHistory delayHistory = _delayHistory;
+	delayHistory.RestoreState(state, position);
+
+	//solver specific part: keep the current one to put it back on failure
+	_solverStateBackup.Clear();
+	SaveSolverState(_solverStateBackup);
+
+	try
+	{
+		RestoreSolverState(state, position);
+
+		if (position != state.GetSize())
+			throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Solver state was not completely restored");
+	}
+	catch (...)
+	{
+		size_t backupPosition = 0;
+		RestoreSolverState(_solverStateBackup, backupPosition);
+		throw;
+	}
+
+	//commit
+	_initialTime = initialTime;
+	_initialValues.swap(initialValues);
+
+	_denseOutputValid = denseOutputValid;
+	for (int i = 0; i < 2; i++)
+	{
+		_denseT[i] = denseT[i];
+		_denseY[i].swap(denseY[i]);
+		_denseYS[i].swap(denseYS[i]);
+		_denseF[i].resize(_problemSize);
+		_denseFS[i].resize((size_t)_problemSize * _numberOfSensitivityParameters);
+		_denseFValid[i] = false;
+	}
+	_denseYNext.resize(_problemSize);
+	_denseYSNext.assign((size_t)_problemSize * _numberOfSensitivityParameters, 0.0);
+	_denseYSRows.resize(_problemSize > 0 ? _problemSize : 1);
+	_denseScratch.resize((size_t)_problemSize * _numberOfSensitivityParameters);
+	_denseSensitivityScratch.resize((size_t)_problemSize * _numberOfSensitivityParameters);
+
+	_rootFound = rootFound;
+	_rootTime = rootTime;
+	_rootsFound.swap(rootsFound);
+	_rootSolution.swap(rootSolution);
+	_rootScanValid = rootScanValid;
+	_rootScanTime = rootScanTime;
+	_rootScanValues.swap(rootScanValues);
+
+	_steadyStateReached = steadyStateReached;
+	_steadyStateTime = steadyStateTime;
+	_steadyStateValues.swap(steadyStateValues);
+	_steadyStateSensitivityValues.swap(steadyStateSensitivityValues);
+
+	_statistics = statistics;
+	_statisticsAtSolverStepStart = _statistics;
+
+	std::swap(_delayHistory, delayHistory);
+}
+
+void SimModelSolverBase::SaveSolverState (SimModelSolverState & /*state*/)
+{
+	const char * ERROR_SOURCE = "SimModelSolverBase::SaveSolverState";
+
+	throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Solver state snapshots are not supported by the solver");
+}
+
+void SimModelSolverBase::RestoreSolverState (const SimModelSolverState & /*state*/, size_t & /*position*/)
+{
+	const char * ERROR_SOURCE = "SimModelSolverBase::RestoreSolverState";
+
+	throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Solver state snapshots are not supported by the solver");
+}
+
+Rhs_Return_Value SimModelSolverBase::CallODERhsFunction (double t, const double * y, const double * p, double * ydot, void * f_data)
+{
+	//DDE system: RHS with the delayed values from the solution history (DDE RHS has no parameters)
+	if (_ddeSystem)
+		return CallDDERhsFunction(t, y, ydot, f_data);
+
+	if (!_collectCallbackTimings)
+	{
+		_statistics.NumberOfRhsEvaluations++;
+		return _solverCaller->ODERhsFunction(t, y, p, ydot, f_data);
+	}
+
+	double startTime = CurrentTimeInSeconds();
+	Rhs_Return_Value retVal = _solverCaller->ODERhsFunction(t, y, p, ydot, f_data);
+
+	_statistics.NumberOfRhsEvaluations++;
+	_statistics.RhsTime += CurrentTimeInSeconds() - startTime;
+
+	return retVal;
+}
+
+void SimModelSolverBase::InitDelayHistory (bool keepPastHistory)
+{
+	const char * ERROR_SOURCE = "SimModelSolverBase::InitDelayHistory";
+
+	if (!_ddeSystem)
+	{
+		_delayHistory.Clear();
+		return;
+	}
+
+	if (_delaysSize < 0)
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Invalid number of delays");
+
+	if (keepPastHistory)
+		_delayHistory.RemovePointsAfter(_initialTime);
+	else
+		_delayHistory.Init(_problemSize, _maxDelay, _maxNumberOfDelayHistoryPoints);
+
+	_ddeDelays.resize(_delaysSize > 0 ? _delaysSize : 1);
+	_ddeDelayedValues.resize(_problemSize * (size_t)(_delaysSize > 0 ? _delaysSize : 1));
+	_ddeDelayedValuesRows.resize(_problemSize > 0 ? _problemSize : 1);
+	_ddeDelayedValuesConstRows.resize(_problemSize > 0 ? _problemSize : 1);
+	_ddeScratch.assign(_problemSize, 0.0);
+
+	for (int i = 0; i < _problemSize; i++)
+	{
+		_ddeDelayedValuesRows[i] = &_ddeDelayedValues[i * (size_t)_ddeDelays.size()];
+		_ddeDelayedValuesConstRows[i] = _ddeDelayedValuesRows[i];
+	}
+
+	if (_problemSize == 0)
+		return;
+
+	//initial point: history before t0 (if not available) is constant = y0, 
+	//the derivative at t0 requires the delayed values of that history
+	_delayHistory.AddPoint(_initialTime, &_initialValues[0], &_ddeScratch[0]);
+
+	if (CallDDERhsFunction(_initialTime, &_initialValues[0], &_ddeScratch[0], NULL) != RHS_OK)
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "DDE RHS evaluation failed at the initial time");
+
+	_delayHistory.AddPoint(_initialTime, &_initialValues[0], &_ddeScratch[0]);
+}
+
+Rhs_Return_Value SimModelSolverBase::CallDDERhsFunction (double t, const double * y, double * ydot, void * f_data)
+{
+	double startTime = _collectCallbackTimings ? CurrentTimeInSeconds() : 0.0;
+
+	if (_delaysSize > 0)
+	{
+		_solverCaller->DDEDelayFunction(t, y, &_ddeDelays[0], NULL);
+		_delayHistory.InterpolateDelays(_delaysSize, &_ddeDelays[0], &_ddeDelayedValuesRows[0]);
+	}
+
+	Rhs_Return_Value retVal = _solverCaller->DDERhsFunction(t, y, &_ddeDelayedValuesConstRows[0], ydot, f_data);
+
+	_statistics.NumberOfRhsEvaluations++;
+	if (_collectCallbackTimings)
+		_statistics.RhsTime += CurrentTimeInSeconds() - startTime;
+
+	return retVal;
+}
+
+void SimModelSolverBase::AddDelayHistoryPoint (double t, const double * y, const double * ydot)
+{
+	_delayHistory.AddPoint(t, y, ydot);
+}
+
+Jacobian_Return_Value SimModelSolverBase::CallODEJacFunction (double t, const double * y, const double * p, const double * fy, 
+	                                                          double * * Jacobian, void * Jac_data)
+{
+	double startTime = _collectCallbackTimings ? CurrentTimeInSeconds() : 0.0;
+
+	Jacobian_Return_Value retVal = _solverCaller->IsSet_ODEJacFunction() ? 
+		_solverCaller->ODEJacFunction(t, y, p, fy, Jacobian, Jac_data) : FiniteDifferenceJacobian(t, y, p, fy, Jacobian);
+
+	_statistics.NumberOfJacobianEvaluations++;
+	if (_collectCallbackTimings)
+		_statistics.JacobianTime += CurrentTimeInSeconds() - startTime;
+
+	return retVal;
+}
+
+Jacobian_Return_Value SimModelSolverBase::CallODESparseJacFunction (double t, const double * y, const double * p, const double * fy, 
+	                                                                double * values, void * Jac_data)
+{
+	double startTime = _collectCallbackTimings ? CurrentTimeInSeconds() : 0.0;
+
+	Jacobian_Return_Value retVal = _solverCaller->ODESparseJacFunction(t, y, p, fy, values, Jac_data);
+
+	_statistics.NumberOfJacobianEvaluations++;
+	if (_collectCallbackTimings)
+		_statistics.JacobianTime += CurrentTimeInSeconds() - startTime;
+
+	return retVal;
+}
+
+void SimModelSolverBase::StartSolverStepStatistics ()
+{
+	_statisticsAtSolverStepStart = _statistics;
+}
+
+void SimModelSolverBase::ReportInternalStep (double t, double h, int order)
+{
+	_statistics.NumberOfSteps++;
+	_statistics.LastStepSize = h;
+	_statistics.LastOrder = order;
+
+	if (_stepSizeProfileRecording)
+		_stepSizeProfileRecording->AddStep(t, h, order);
+
+	if (_stepObserver)
+		_stepObserver->OnInternalStep(t, h, order, _statistics);
+}
+
+const SolverStatistics & SimModelSolverBase::GetSolverStatistics () const
+{
+	return _statistics;
+}
+
+bool SimModelSolverBase::GetWarmStartStep (double t0, double & h, int & order)
+{
+	if (!_stepSizeProfile)
+		return false;
+
+	return _stepSizeProfile->GetInitialStep(t0, h, order);
+}
+
+double SimModelSolverBase::GetMaxStepSize (double t)
+{
+	double hMax = _hMax;
+
+	if (_stepSizeProfile && (_stepSizeProfileMaxStepFactor > 0.0))
+	{
+		double hProfile = _stepSizeProfileMaxStepFactor * _stepSizeProfile->GetStepSize(t);
+		if ((hProfile > 0.0) && ((hMax <= 0.0) || (hProfile < hMax)))
+			hMax = hProfile;
+	}
+
+	return hMax;
+}
+
+SolverStatistics SimModelSolverBase::GetLastSolverStepStatistics () const
+{
+	return _statistics.Difference(_statisticsAtSolverStepStart);
+}
+
+bool SimModelSolverBase::GetCollectCallbackTimings ()
+{
+	return _collectCallbackTimings;
+}
+
+void SimModelSolverBase::SetCollectCallbackTimings (bool collectCallbackTimings)
+{
+	_collectCallbackTimings = collectCallbackTimings;
+}
+
+ISolverStepObserver * SimModelSolverBase::GetStepObserver ()
+{
+	return _stepObserver;
+}
+
+void SimModelSolverBase::SetStepObserver (ISolverStepObserver * stepObserver)
+{
+	_stepObserver = stepObserver;
+}
+
+int SimModelSolverBase::PerformSolverStepStrided (double tout, double * y, int yStride,
+	                                                double * yS, int ySRowStride, int ySColumnStride, double & tret)
+{
+	const char * ERROR_SOURCE = "SimModelSolverBase::PerformSolverStepStrided";
+	int i, j;
+
+	if ((yStride < 1) || ((yS != NULL) && ((ySRowStride < 1) || (ySColumnStride < 1))))
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE,"Invalid output buffer strides");
+
+	bool sensitivities = (yS != NULL) && (_numberOfSensitivityParameters > 0);
+	bool directY = (yStride == 1);
+	bool directYS = !sensitivities || (ySColumnStride == 1);
+
+	double * solverY = y;
+	if (!directY)
+	{
+		_outputScratchY.resize(_problemSize);
+		solverY = _problemSize > 0 ? &_outputScratchY[0] : NULL;
+	}
+
+	_outputScratchYSRows.resize(_problemSize > 0 ? _problemSize : 1);
+	if (directYS)
+	{
+		//rows of yS are contiguous: pass row pointers into the output buffer
+		for (i = 0; i < _problemSize; i++)
+			_outputScratchYSRows[i] = sensitivities ? yS + (size_t)i * ySRowStride : NULL;
+	}
+	else
+	{
+		_outputScratchYS.resize((size_t)_problemSize * _numberOfSensitivityParameters);
+		for (i = 0; i < _problemSize; i++)
+			_outputScratchYSRows[i] = &_outputScratchYS[(size_t)i * _numberOfSensitivityParameters];
+	}
+
+	int retVal = PerformSolverStep(tout, solverY, &_outputScratchYSRows[0], tret);
+
+	if (!directY)
+	{
+		for (i = 0; i < _problemSize; i++)
+			y[(size_t)i * yStride] = _outputScratchY[i];
+	}
+
+	if (!directYS)
+	{
+		for (i = 0; i < _problemSize; i++)
+		{
+			const double * row = _outputScratchYSRows[i];
+			double * target = yS + (size_t)i * ySRowStride;
+
+			for (j = 0; j < _numberOfSensitivityParameters; j++)
+				target[(size_t)j * ySColumnStride] = row[j];
+		}
+	}
+
+	return retVal;
+}
+
+bool SimModelSolverBase::SupportsInternalSteps ()
+{
+	return false;
+}
+
+int SimModelSolverBase::PerformInternalStep (double /*tstop*/, double * /*y*/, double ** /*yS*/, double & /*tret*/)
+{
+	const char * ERROR_SOURCE = "SimModelSolverBase::PerformInternalStep";
+
+	//must be overwritten by solvers supporting internal steps
+	throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE,"Internal steps are not supported by the solver");
+}
+
+bool SimModelSolverBase::CheckSteadyState (double t, const double * y, const double * ydot, 
+	                                        const double * yS, const double * ySdot, int ySRowStride, int ySColumnStride,
+	                                        const std::vector < int > * parameters)
+{
+	int n = _problemSize, ns = _numberOfSensitivityParameters, i, j;
+
+	//number of sensitivity columns passed
+	int numberOfColumns = parameters != NULL ? (int)parameters->size() : ns;
+
+	if (!_steadyStateDetection || (n == 0))
+		return false;
+
+	//weighted RMS norm of dy/dt
+	if (SimModelSolverVectorKernels::WeightedRmsNorm(n, ydot, y, _relTol, &_absTol[0]) > _steadyStateTolerance)
+		return false;
+
+	bool sensitivities = (ns > 0) && (yS != NULL);
+
+	//sensitivities are only checked if their RHS is available
+	if (_steadyStateSensitivities && sensitivities && (ySdot != NULL) && (numberOfColumns > 0))
+	{
+		//column-major block: vectorized
+		if (ySRowStride == 1)
+		{
+			if (SimModelSolverVectorKernels::WeightedRmsNormBlock(n, numberOfColumns, ySdot, yS, ySColumnStride, _relTol, &_absTol[0]) > _steadyStateTolerance)
+				return false;
+		}
+		else
+		{
+			for (j = 0; j < numberOfColumns; j++)
+			{
+				double sum = 0.0;
+				for (i = 0; i < n; i++)
+				{
+					size_t idx = (size_t)i * ySRowStride + (size_t)j * ySColumnStride;
+					double weightedValue = ySdot[idx] / (_relTol * fabs(yS[idx]) + _absTol[i]);
+					sum += weightedValue * weightedValue;
+				}
+
+				if (sqrt(sum / n) > _steadyStateTolerance)
+					return false;
+			}
+		}
+	}
+
+	//store steady state (sensitivities row-major)
+	_steadyStateReached = true;
+	_steadyStateTime = t;
+	_steadyStateValues.assign(y, y + n);
+	_steadyStateSensitivityValues.assign((size_t)n * ns, 0.0);
+
+	for (i = 0; sensitivities && (i < n); i++)
+		for (j = 0; j < numberOfColumns; j++)
+		{
+			int iS = parameters != NULL ? (*parameters)[j] : j;
+			_steadyStateSensitivityValues[(size_t)i * ns + iS] = yS[(size_t)i * ySRowStride + (size_t)j * ySColumnStride];
+		}
+
+	return true;
+}
+
+int SimModelSolverBase::CheckSteadyStateAtOutput (double t, const double * y, const double * yS)
+{
+	int n = _problemSize, ns = _numberOfSensitivityParameters, i, j;
+	const double * p = ns > 0 ? &_sensitivityParametersInitialValues[0] : NULL;
+
+	if (n == 0)
+		return 0;
+
+	_steadyStateScratchF.resize(n);
+	double * ydot = &_steadyStateScratchF[0];
+
+	Rhs_Return_Value rhsRetVal = CallODERhsFunction(t, y, p, ydot, NULL);
+	if (rhsRetVal != RHS_OK)
+		return rhsRetVal == RHS_FAILED ? -1 : 1;
+
+	bool sensitivities = _steadyStateSensitivities && (yS != NULL) && (ns > 0) &&
+		                 (_solverCaller->IsSet_ODESensitivityRhsFunction() || _solverCaller->IsSet_ODESensitivityRhsFunctionAll());
+
+	if (!sensitivities)
+	{
+		CheckSteadyState(t, y, ydot, yS, NULL, ns, 1);
+		return 0;
+	}
+
+	//sensitivity RHS works on column-major n x NS blocks
+	_steadyStateScratchYS.resize((size_t)n * ns);
+	_steadyStateScratchYSdot.resize((size_t)n * ns);
+	double * ySColumns = &_steadyStateScratchYS[0];
+	double * ySdot = &_steadyStateScratchYSdot[0];
+
+	for (i = 0; i < n; i++)
+		for (j = 0; j < ns; j++)
+			ySColumns[(size_t)j * n + i] = yS[(size_t)i * ns + j];
+
+	Sensitivity_Rhs_Return_Value sensRetVal = CallODESensitivityRhsFunction(t, y, ydot, ySColumns, ySdot, NULL);
+	if (sensRetVal != SENSITIVITY_RHS_OK)
+		return sensRetVal == SENSITIVITY_RHS_FAILED ? -1 : 1;
+
+	CheckSteadyState(t, y, ydot, ySColumns, ySdot, 1, n);
+
+	return 0;
+}
+
+void SimModelSolverBase::GetSteadyStateSolution (double * y, double * yS)
+{
+	int n = _problemSize, ns = _numberOfSensitivityParameters;
+
+	for (int i = 0; i < n; i++)
+		y[i] = _steadyStateValues[i];
+
+	for (size_t idx = 0; (yS != NULL) && (idx < (size_t)n * ns); idx++)
+		yS[idx] = _steadyStateSensitivityValues[idx];
+}
+
+bool SimModelSolverBase::GetSteadyStateDetection ()
+{
+	return _steadyStateDetection;
+}
+
+void SimModelSolverBase::SetSteadyStateDetection (bool steadyStateDetection)
+{
+	_steadyStateDetection = steadyStateDetection;
+}
+
+double SimModelSolverBase::GetSteadyStateTolerance ()
+{
+	return _steadyStateTolerance;
+}
+
+void SimModelSolverBase::SetSteadyStateTolerance (double steadyStateTolerance)
+{
+	const char * ERROR_SOURCE = "SimModelSolverBase::SetSteadyStateTolerance";
+
+	if (steadyStateTolerance <= 0.0)
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Steady state tolerance must be positive");
+
+	_steadyStateTolerance = steadyStateTolerance;
+}
+
+bool SimModelSolverBase::GetSteadyStateSensitivities ()
+{
+	return _steadyStateSensitivities;
+}
+
+void SimModelSolverBase::SetSteadyStateSensitivities (bool steadyStateSensitivities)
+{
+	_steadyStateSensitivities = steadyStateSensitivities;
+}
+
+bool SimModelSolverBase::SteadyStateReached ()
+{
+	return _steadyStateReached;
+}
+
+double SimModelSolverBase::GetSteadyStateTime ()
+{
+	return _steadyStateTime;
+}
+
+bool SimModelSolverBase::SupportsStateSnapshots ()
+{
+	return false;
+}
+
+bool SimModelSolverBase::SupportsAdjointSensitivities ()
+{
+	return SupportsInternalSteps() && SupportsStateSnapshots() && _solverCaller->IsSet_ODEAdjointQuadratureFunction();
+}
+
+int SimModelSolverBase::PerformAdjointForwardPass (double tFinal, double * y)
+{
+	const char * ERROR_SOURCE = "SimModelSolverBase::PerformAdjointForwardPass";
+
+	int n = _problemSize, ns = _numberOfSensitivityParameters;
+
+	if (!_initialized)
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Solver was not initialized");
+
+	if (!SupportsAdjointSensitivities())
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Adjoint sensitivities are not supported by the solver or the solver caller");
+
+	if (tFinal <= _initialTime)
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "End time must be greater than the initial time");
+
+	StartSolverStepStatistics();
+
+	_adjointForwardPassValid = false;
+	_adjointCheckpoints.clear();
+	_adjointCheckpointTimes.clear();
+	_adjointCheckpointValues.clear();
+	_adjointSegmentSteps.clear();
+
+	std::vector < double > yCurrent(_initialValues), ySCurrent((size_t)n * ns);
+	std::vector < double * > ySRows(n > 0 ? n : 1, (double *)NULL);
+	for (int i = 0; (ns > 0) && (i < n); i++)
+		ySRows[i] = &ySCurrent[(size_t)i * ns];
+
+	double t = _initialTime;
+	int stepsInSegment = _adjointCheckpointInterval;
+
+	while (t < tFinal)
+	{
+		if (stepsInSegment == _adjointCheckpointInterval)
+		{
+			_adjointCheckpoints.push_back(SaveState());
+			_adjointCheckpointTimes.push_back(t);
+			_adjointCheckpointValues.insert(_adjointCheckpointValues.end(), yCurrent.begin(), yCurrent.end());
+			_adjointSegmentSteps.push_back(0);
+			stepsInSegment = 0;
+		}
+
+		double tret;
+		int retVal = PerformInternalStep(tFinal, &yCurrent[0], &ySRows[0], tret);
+		if (retVal != 0)
+			return retVal;
+
+		if (tret <= t)
+			throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Internal step of the solver did not advance in time");
+
+		t = tret;
+		stepsInSegment++;
+		_adjointSegmentSteps.back()++;
+	}
+
+	for (int i = 0; i < n; i++)
+		y[i] = yCurrent[i];
+
+	_adjointFinalTime = tFinal;
+	SaveState(_adjointFinalState);
+	_adjointForwardPassValid = true;
+
+	return 0;
+}
+
+int SimModelSolverBase::RecomputeAdjointSegment (size_t segment)
+{
+	int n = _problemSize, ns = _numberOfSensitivityParameters;
+
+	//statistics are not reset to the checkpoint: recomputation is part of the backward pass
+	SolverStatistics statistics = _statistics, statisticsAtSolverStepStart = _statisticsAtSolverStepStart;
+	RestoreState(_adjointCheckpoints[segment]);
+	_statistics = statistics;
+	_statisticsAtSolverStepStart = statisticsAtSolverStepStart;
+
+	_adjointSegmentTimes.assign(1, _adjointCheckpointTimes[segment]);
+	_adjointSegmentValues.assign(_adjointCheckpointValues.begin() + segment * n, _adjointCheckpointValues.begin() + (segment + 1) * n);
+
+	std::vector < double > y(n), yS((size_t)n * ns);
+	std::vector < double * > ySRows(n > 0 ? n : 1, (double *)NULL);
+	for (int i = 0; (ns > 0) && (i < n); i++)
+		ySRows[i] = &yS[(size_t)i * ns];
+
+	for (int step = 0; step < _adjointSegmentSteps[segment]; step++)
+	{
+		double tret;
+
+		//same tstop as in the forward pass, so that the same internal steps are taken
+		int retVal = PerformInternalStep(_adjointFinalTime, &y[0], &ySRows[0], tret);
+		if (retVal != 0)
+			return retVal;
+
+		_adjointSegmentTimes.push_back(tret);
+		_adjointSegmentValues.insert(_adjointSegmentValues.end(), y.begin(), y.end());
+	}
+
+	return 0;
+}
+
+int SimModelSolverBase::ComputeAdjointSensitivities (const double * lambdaFinal, double * dGdp, double * lambdaInitial)
+{
+	const char * ERROR_SOURCE = "SimModelSolverBase::ComputeAdjointSensitivities";
+
+	int n = _problemSize, np = _solverCaller->GetNumberOfAdjointParameters(), i, j;
+	const double * p = _numberOfSensitivityParameters > 0 ? &_sensitivityParametersInitialValues[0] : NULL;
+
+	if (!_adjointForwardPassValid)
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Adjoint forward pass was not performed");
+
+	if (np < 0)
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Invalid number of adjoint parameters");
+
+	StartSolverStepStatistics();
+
+	_adjointJacobian.resize((size_t)n * n);
+	_adjointJacobianRows.resize(n > 0 ? n : 1);
+	_adjointMatrix.resize((size_t)n * n);
+	_adjointMatrixRows.resize(n > 0 ? n : 1);
+	_adjointPivots.resize(n > 0 ? n : 1);
+	for (i = 0; i < n; i++)
+		_adjointJacobianRows[i] = &_adjointJacobian[(size_t)i * n];
+
+	std::vector < double > lambda(lambdaFinal, lambdaFinal + n), lambdaDot(n), b(n, 0.0), zero(n, 0.0), f(n);
+	std::vector < double > q(np, 0.0), qDot(np), qDotNew(np);
+
+	bool callerAdjointRhs = _solverCaller->IsSet_ODEAdjointRhsFunction();
+	bool finalPoint = true;
+	double tPrevious = _adjointFinalTime;
+
+	//segments backward; every segment is integrated forward again from its checkpoint
+	for (int segment = (int)_adjointCheckpoints.size() - 1; segment >= 0; segment--)
+	{
+		int retVal = RecomputeAdjointSegment(segment);
+		if (retVal != 0)
+			return retVal;
+
+		int numberOfPoints = (int)_adjointSegmentTimes.size();
+
+		//last point of the segment was already processed as first point of the next segment
+		for (int k = finalPoint ? numberOfPoints - 1 : numberOfPoints - 2; k >= 0; k--)
+		{
+			double t = _adjointSegmentTimes[k];
+			const double * y = &_adjointSegmentValues[(size_t)k * n];
+
+			//Jacobian at (t, y)
+			if (CallODERhsFunction(t, y, p, &f[0], NULL) != RHS_OK)
+				throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "RHS evaluation failed during backward integration");
+
+			std::fill(_adjointJacobian.begin(), _adjointJacobian.end(), 0.0);
+			if (CallODEJacFunction(t, y, p, &f[0], &_adjointJacobianRows[0], NULL) != JACOBIAN_OK)
+				throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Jacobian evaluation failed during backward integration");
+
+			if (finalPoint)
+			{
+				if ((CallODEAdjointRhsFunction(t, y, &lambda[0], &lambdaDot[0]) != RHS_OK) ||
+					(CallODEAdjointQuadratureFunction(t, y, &lambda[0], &qDot[0]) != RHS_OK))
+					throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Adjoint RHS evaluation failed during backward integration");
+
+				finalPoint = false;
+				tPrevious = t;
+				continue;
+			}
+
+			double h = tPrevious - t;
+
+			//lambdaDot = -J^T lambda + b (b: part of the adjoint RHS independent of lambda)
+			if (callerAdjointRhs && (CallODEAdjointRhsFunction(t, y, &zero[0], &b[0]) != RHS_OK))
+				throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Adjoint RHS evaluation failed during backward integration");
+
+			//trapezoidal rule backward: (I - h/2 J^T) lambda(t) = lambda(t + h) - h/2 (lambdaDot(t + h) + b)
+			for (i = 0; i < n; i++)
+			{
+				_adjointMatrixRows[i] = &_adjointMatrix[(size_t)i * n];
+				for (j = 0; j < n; j++)
+					_adjointMatrixRows[i][j] = (i == j ? 1.0 : 0.0) - 0.5 * h * _adjointJacobianRows[j][i];
+
+				lambda[i] -= 0.5 * h * (lambdaDot[i] + b[i]);
+			}
+
+			if (!FactorizeDenseMatrix(n, &_adjointMatrixRows[0], &_adjointPivots[0]))
+				throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Singular iteration matrix during backward integration");
+
+			SolveDenseSystem(n, &_adjointMatrixRows[0], &_adjointPivots[0], &lambda[0]);
+
+			for (i = 0; i < n; i++)
+			{
+				lambdaDot[i] = b[i];
+				for (j = 0; j < n; j++)
+					lambdaDot[i] -= _adjointJacobianRows[j][i] * lambda[j];
+			}
+
+			if (CallODEAdjointQuadratureFunction(t, y, &lambda[0], &qDotNew[0]) != RHS_OK)
+				throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Adjoint quadrature evaluation failed during backward integration");
+
+			for (j = 0; j < np; j++)
+				q[j] += 0.5 * h * (qDot[j] + qDotNew[j]);
+
+			qDot.swap(qDotNew);
+			tPrevious = t;
+		}
+	}
+
+	for (j = 0; j < np; j++)
+		dGdp[j] = q[j];
+
+	for (i = 0; (lambdaInitial != NULL) && (i < n); i++)
+		lambdaInitial[i] = lambda[i];
+
+	//continue from the end of the forward pass
+	SolverStatistics statistics = _statistics, statisticsAtSolverStepStart = _statisticsAtSolverStepStart;
+	RestoreState(_adjointFinalState);
+	_statistics = statistics;
+	_statisticsAtSolverStepStart = statisticsAtSolverStepStart;
+
+	return 0;
+}
+
+Rhs_Return_Value SimModelSolverBase::CallODEAdjointRhsFunction (double t, const double * y, const double * lambda, double * lambdaDot)
+{
+	double startTime = _collectCallbackTimings ? CurrentTimeInSeconds() : 0.0;
+	Rhs_Return_Value retVal = RHS_OK;
+
+	if (_solverCaller->IsSet_ODEAdjointRhsFunction())
+	{
+		retVal = _solverCaller->ODEAdjointRhsFunction(t, y, lambda, lambdaDot, NULL);
+		_statistics.NumberOfAdjointRhsEvaluations++;
+	}
+	else
+	{
+		//-J^T lambda with the Jacobian at (t, y)
+		int n = _problemSize;
+		for (int i = 0; i < n; i++)
+		{
+			lambdaDot[i] = 0.0;
+			for (int j = 0; j < n; j++)
+				lambdaDot[i] -= _adjointJacobianRows[j][i] * lambda[j];
+		}
+	}
+
+	if (_collectCallbackTimings)
+		_statistics.AdjointTime += CurrentTimeInSeconds() - startTime;
+
+	return retVal;
+}
+
+Rhs_Return_Value SimModelSolverBase::CallODEAdjointQuadratureFunction (double t, const double * y, const double * lambda, double * qDot)
+{
+	double startTime = _collectCallbackTimings ? CurrentTimeInSeconds() : 0.0;
+
+	Rhs_Return_Value retVal = _solverCaller->ODEAdjointQuadratureFunction(t, y, lambda, qDot, NULL);
+
+	_statistics.NumberOfAdjointQuadratureEvaluations++;
+	if (_collectCallbackTimings)
+		_statistics.AdjointTime += CurrentTimeInSeconds() - startTime;
+
+	return retVal;
+}
+
+int SimModelSolverBase::GetAdjointCheckpointInterval ()
+{
+	return _adjointCheckpointInterval;
+}
+
+void SimModelSolverBase::SetAdjointCheckpointInterval (int adjointCheckpointInterval)
+{
+	const char * ERROR_SOURCE = "SimModelSolverBase::SetAdjointCheckpointInterval";
+
+	if (adjointCheckpointInterval < 1)
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Adjoint checkpoint interval must be at least 1");
+
+	_adjointCheckpointInterval = adjointCheckpointInterval;
+}
+
+void SimModelSolverBase::HermiteInterpolation (int n, double t0, const double * y0, const double * f0,
+	                                           double t1, const double * y1, const double * f1, 
+	                                           double t, double * y)
+{
+	double h = t1 - t0;
+
+	if (h == 0.0)
+	{
+		for (int i = 0; i < n; i++)
+			y[i] = y1[i];
+		return;
+	}
+
+	double s = (t - t0) / h;
+	double s2 = s * s, s3 = s2 * s;
+
+	double h00 = 2.0 * s3 - 3.0 * s2 + 1.0;
+	double h10 = (s3 - 2.0 * s2 + s) * h;
+	double h01 = -2.0 * s3 + 3.0 * s2;
+	double h11 = (s3 - s2) * h;
+
+	for (int i = 0; i < n; i++)
+		y[i] = h00 * y0[i] + h10 * f0[i] + h01 * y1[i] + h11 * f1[i];
+}
+
+void SimModelSolverBase::InitDenseOutput ()
+{
+	for (int idx = 0; idx < 2; idx++)
+	{
+		_denseY[idx].resize(_problemSize);
+		_denseYS[idx].assign((size_t)_problemSize * _numberOfSensitivityParameters, 0.0);
+		_denseF[idx].resize(_problemSize);
+		_denseFS[idx].resize((size_t)_problemSize * _numberOfSensitivityParameters);
+		_denseFValid[idx] = false;
+	}
+
+	_denseYNext.resize(_problemSize);
+	_denseYSNext.assign((size_t)_problemSize * _numberOfSensitivityParameters, 0.0);
+	_denseYSRows.resize(_problemSize > 0 ? _problemSize : 1);
+	_denseScratch.resize((size_t)_problemSize * _numberOfSensitivityParameters);
+	_denseSensitivityScratch.resize((size_t)_problemSize * _numberOfSensitivityParameters);
+
+	//sensitivities at the initial time are 0
+	_denseT[1] = _initialTime;
+	_denseY[1] = _initialValues;
+	_denseT[0] = _denseT[1];
+
+	_denseOutputValid = true;
+}
+
+int SimModelSolverBase::ComputeDenseOutputDerivatives (int index)
+{
+	if (_denseFValid[index])
+		return 0;
+
+	const double * p = _numberOfSensitivityParameters > 0 ? &_sensitivityParametersInitialValues[0] : NULL;
+
+	Rhs_Return_Value rhsRetVal = CallODERhsFunction(_denseT[index], &_denseY[index][0], p, &_denseF[index][0], NULL);
+	if (rhsRetVal != RHS_OK)
+		return rhsRetVal == RHS_FAILED ? -1 : 1;
+
+	if ((_numberOfSensitivityParameters > 0) && 
+		(_solverCaller->IsSet_ODESensitivityRhsFunction() || _solverCaller->IsSet_ODESensitivityRhsFunctionAll()))
+	{
+		int i, k, n = _problemSize, ns = _numberOfSensitivityParameters;
+		int numberOfActiveParameters = (int)_activeSensitivityParameters.size();
+
+		//sensitivity RHS works on column-major n x NS blocks (of the active parameters)
+		for (i = 0; i < n; i++)
+			for (k = 0; k < numberOfActiveParameters; k++)
+				_denseSensitivityScratch[(size_t)k * n + i] = _denseYS[index][(size_t)i * ns + _activeSensitivityParameters[k]];
+
+		Sensitivity_Rhs_Return_Value sensRetVal = 
+			CallODESensitivityRhsFunction(_denseT[index], &_denseY[index][0], &_denseF[index][0], &_denseSensitivityScratch[0], &_denseScratch[0], NULL,
+			                              _activeSensitivityParameters);
+		if (sensRetVal != SENSITIVITY_RHS_OK)
+			return sensRetVal == SENSITIVITY_RHS_FAILED ? -1 : 1;
+
+		std::fill(_denseFS[index].begin(), _denseFS[index].end(), 0.0);
+		for (i = 0; i < n; i++)
+			for (k = 0; k < numberOfActiveParameters; k++)
+				_denseFS[index][(size_t)i * ns + _activeSensitivityParameters[k]] = _denseScratch[(size_t)k * n + i];
+	}
+
+	_denseFValid[index] = true;
+
+	return 0;
+}
+
+int SimModelSolverBase::InterpolateSolution (double t, double * y, double ** yS)
+{
+	int i, j, ns = _numberOfSensitivityParameters;
+
+	for (int idx = 0; idx < 2; idx++)
+	{
+		int retVal = ComputeDenseOutputDerivatives(idx);
+		if (retVal != 0)
+			return retVal;
+	}
+
+	HermiteInterpolation(_problemSize, _denseT[0], &_denseY[0][0], &_denseF[0][0], _denseT[1], &_denseY[1][0], &_denseF[1][0], t, y);
+
+	if ((ns == 0) || !yS)
+		return 0;
+
+	if (_solverCaller->IsSet_ODESensitivityRhsFunction() || _solverCaller->IsSet_ODESensitivityRhsFunctionAll())
+	{
+		HermiteInterpolation(_problemSize * ns, _denseT[0], &_denseYS[0][0], &_denseFS[0][0], 
+			                 _denseT[1], &_denseYS[1][0], &_denseFS[1][0], t, &_denseScratch[0]);
+	}
+	else
+	{
+		double h = _denseT[1] - _denseT[0];
+		double s = (h != 0.0) ? (t - _denseT[0]) / h : 1.0;
+
+		for (size_t idx = 0; idx < _denseScratch.size(); idx++)
+			_denseScratch[idx] = (1.0 - s) * _denseYS[0][idx] + s * _denseYS[1][idx];
+	}
+
+	for (i = 0; i < _problemSize; i++)
+		for (j = 0; j < ns; j++)
+			yS[i][j] = _denseScratch[(size_t)i * ns + j];
+
+	return 0;
+}
+
+int SimModelSolverBase::PerformSolverSteps (const std::vector < double > & outputTimes, double * y, double * yS, 
+	                                        int & numberOfOutputsReached)
+{
+	const char * ERROR_SOURCE = "SimModelSolverBase::PerformSolverSteps";
+	int i, retVal = 0;
+	int n = _problemSize, ns = _numberOfSensitivityParameters;
+
+	if (!_initialized)
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE,"Solver was not initialized");
+
+	numberOfOutputsReached = 0;
+	StartSolverStepStatistics();
+
+	if (outputTimes.empty())
+		return 0;
+
+	std::vector < double * > ySRows(n > 0 ? n : 1, (double *)NULL);
+	bool sensitivities = (yS != NULL) && (ns > 0);
+
+	//steady state: remaining outputs are not integrated (not with events, which may still occur)
+	bool steadyStateDetection = _steadyStateDetection && (_numberOfRootFunctions == 0);
+
+	if (steadyStateDetection && _steadyStateReached)
+	{
+		for (size_t k = 0; k < outputTimes.size(); k++)
+		{
+			GetSteadyStateSolution(y + k * n, sensitivities ? yS + k * n * ns : NULL);
+
+			for (i = 0; i < n; i++)
+				ySRows[i] = sensitivities ? yS + (k * n + i) * ns : NULL;
+			ApplySensitivityActivation(outputTimes[k], sensitivities ? &ySRows[0] : NULL);
+		}
+
+		numberOfOutputsReached = (int)outputTimes.size();
+		return 0;
+	}
+
+	if (!SupportsInternalSteps())
+	{
+		//root search between two outputs (the solution between them is interpolated from the outputs)
+		if (_numberOfRootFunctions > 0)
+		{
+			if (!_denseOutputValid)
+				InitDenseOutput();
+
+			_rootFound = false;
+			retVal = CheckForRoots();
+			if (retVal != 0)
+				return retVal;
+		}
+
+		//one solver call per output time
+		for (size_t k = 0; !_rootFound && (k < outputTimes.size()); k++)
+		{
+			for (i = 0; i < n; i++)
+				ySRows[i] = sensitivities ? yS + (k * n + i) * ns : NULL;
+
+			double tret;
+			retVal = PerformSolverStep(outputTimes[k], y + k * n, &ySRows[0], tret);
+			if ((retVal != 0) || (tret < outputTimes[k]))
+				return retVal;
+
+			ApplySensitivityActivation(tret, sensitivities ? &ySRows[0] : NULL);
+
+			if (_numberOfRootFunctions > 0)
+			{
+				//output becomes the last step point
+				_denseT[0] = _denseT[1];
+				_denseY[0].swap(_denseY[1]);
+				_denseYS[0].swap(_denseYS[1]);
+				_denseF[0].swap(_denseF[1]);
+				_denseFS[0].swap(_denseFS[1]);
+				_denseFValid[0] = _denseFValid[1];
+				_denseFValid[1] = false;
+
+				_denseT[1] = tret;
+				std::copy(y + k * n, y + (k + 1) * n, _denseY[1].begin());
+				if (sensitivities)
+					std::copy(yS + k * n * ns, yS + (k + 1) * n * ns, _denseYS[1].begin());
+
+				retVal = CheckForRoots();
+				if (retVal != 0)
+					return retVal;
+
+				//stop at the root (outputs behind it are not returned)
+				if (_rootFound)
+					return 0;
+			}
+
+			numberOfOutputsReached++;
+
+			//steady state check at the output time (solver may have detected it already)
+			if (steadyStateDetection && !_steadyStateReached)
+			{
+				retVal = CheckSteadyStateAtOutput(tret, y + k * n, sensitivities ? yS + k * n * ns : NULL);
+				if (retVal != 0)
+					return retVal;
+			}
+
+			if (steadyStateDetection && _steadyStateReached)
+			{
+				for (size_t kRest = k + 1; kRest < outputTimes.size(); kRest++)
+				{
+					GetSteadyStateSolution(y + kRest * n, sensitivities ? yS + kRest * n * ns : NULL);
+
+					for (i = 0; i < n; i++)
+						ySRows[i] = sensitivities ? yS + (kRest * n + i) * ns : NULL;
+					ApplySensitivityActivation(outputTimes[kRest], sensitivities ? &ySRows[0] : NULL);
+				}
+
+				numberOfOutputsReached = (int)outputTimes.size();
+				return 0;
+			}
+		}
+
+		return 0;
+	}
+
+	if (!_denseOutputValid)
+		InitDenseOutput();
+
+	double tstop = outputTimes.back();
+
+	//check the rest of the last internal step (behind a root reported by the previous call)
+	_rootFound = false;
+	retVal = CheckForRoots();
+	if (retVal != 0)
+		return retVal;
+
+	for (size_t k = 0; k < outputTimes.size(); k++)
+	{
+		double tout = outputTimes[k];
+
+		//integrate until the output time is covered by the last internal step (or a root/steady state was found)
+		while (!_rootFound && !_steadyStateReached && (_denseT[1] < tout))
+		{
+			//step into separate buffers, so both step points stay valid if the step fails
+			for (i = 0; i < n; i++)
+				_denseYSRows[i] = ns > 0 ? &_denseYSNext[(size_t)i * ns] : NULL;
+
+			double tNext = _denseT[1];
+			retVal = PerformInternalStep(tstop, n > 0 ? &_denseYNext[0] : NULL, &_denseYSRows[0], tNext);
+
+			if ((retVal != 0) || (tNext <= _denseT[1]))
+				return retVal != 0 ? retVal : -1;
+
+			//[1] becomes [0], new step point becomes [1]
+			_denseT[0] = _denseT[1];
+			_denseT[1] = tNext;
+			_denseY[0].swap(_denseY[1]);
+			_denseY[1].swap(_denseYNext);
+			_denseYS[0].swap(_denseYS[1]);
+			_denseYS[1].swap(_denseYSNext);
+			_denseF[0].swap(_denseF[1]);
+			_denseFS[0].swap(_denseFS[1]);
+			_denseFValid[0] = _denseFValid[1];
+			_denseFValid[1] = false;
+
+			retVal = CheckForRoots();
+			if (retVal != 0)
+				return retVal;
+
+			//RHS at the step point is reused by the interpolation
+			if (steadyStateDetection && (n > 0))
+			{
+				retVal = ComputeDenseOutputDerivatives(1);
+				if (retVal != 0)
+					return retVal;
+
+				bool sensitivityRhs = (ns > 0) && 
+					(_solverCaller->IsSet_ODESensitivityRhsFunction() || _solverCaller->IsSet_ODESensitivityRhsFunctionAll());
+
+				CheckSteadyState(_denseT[1], &_denseY[1][0], &_denseF[1][0], 
+					             ns > 0 ? &_denseYS[1][0] : NULL, sensitivityRhs ? &_denseFS[1][0] : NULL, ns, 1);
+			}
+		}
+
+		//stop at the root (output times up to the root are still returned)
+		if (_rootFound && (tout > _rootTime))
+			return 0;
+
+		for (i = 0; i < n; i++)
+			ySRows[i] = sensitivities ? yS + (k * n + i) * ns : NULL;
+
+		//behind the steady state
+		if (_steadyStateReached && (tout > _denseT[1]))
+		{
+			GetSteadyStateSolution(y + k * n, sensitivities ? yS + k * n * ns : NULL);
+			ApplySensitivityActivation(tout, sensitivities ? &ySRows[0] : NULL);
+			numberOfOutputsReached++;
+			continue;
+		}
+
+		if (tout == _denseT[1])
+		{
+			for (i = 0; i < n; i++)
+			{
+				y[k * n + i] = _denseY[1][i];
+				for (int j = 0; sensitivities && (j < ns); j++)
+					ySRows[i][j] = _denseYS[1][(size_t)i * ns + j];
+			}
+		}
+		else
+		{
+			retVal = InterpolateSolution(tout, y + k * n, sensitivities ? &ySRows[0] : NULL);
+			if (retVal != 0)
+				return retVal;
+		}
+
+		ApplySensitivityActivation(tout, sensitivities ? &ySRows[0] : NULL);
+		numberOfOutputsReached++;
+	}
+
+	return 0;
+}
+
+int SimModelSolverBase::PerformSolverStepWithRoots (double tout, double * y, double ** yS, double & tret)
+{
+	int i, j, n = _problemSize, ns = _numberOfSensitivityParameters;
+	bool sensitivities = (yS != NULL) && (ns > 0);
+
+	_rootStepOutputTimes.assign(1, tout);
+	_rootStepYS.resize((size_t)n * ns);
+
+	int numberOfOutputsReached = 0;
+	int retVal = PerformSolverSteps(_rootStepOutputTimes, y, sensitivities ? &_rootStepYS[0] : NULL, numberOfOutputsReached);
+
+	if (numberOfOutputsReached == 1)
+	{
+		for (i = 0; sensitivities && (i < n); i++)
+			for (j = 0; j < ns; j++)
+				yS[i][j] = _rootStepYS[(size_t)i * ns + j];
+
+		tret = tout;
+		return retVal;
+	}
+
+	if ((retVal == 0) && _rootFound)
+	{
+		//y from the root search, yS interpolated at the root
+		retVal = InterpolateSolution(_rootTime, y, sensitivities ? yS : NULL);
+		std::copy(_rootSolution.begin(), _rootSolution.end(), y);
+		ApplySensitivityActivation(_rootTime, sensitivities ? yS : NULL);
+
+		tret = _rootTime;
+		return retVal;
+	}
+
+	//failure: last valid step point
+	for (i = 0; i < n; i++)
+	{
+		y[i] = _denseY[1][i];
+		for (j = 0; sensitivities && (j < ns); j++)
+			yS[i][j] = _denseYS[1][(size_t)i * ns + j];
+	}
+	ApplySensitivityActivation(_denseT[1], sensitivities ? yS : NULL);
+
+	tret = _denseT[1];
+	return retVal != 0 ? retVal : -1;
+}
+
+int SimModelSolverBase::PerformSolverStepsToSink (const std::vector < double > & outputTimes, ISolverOutputSink * outputSink,
+	                                              int runIndex, int & numberOfOutputsReached)
+{
+	const char * ERROR_SOURCE = "SimModelSolverBase::PerformSolverStepsToSink";
+	int retVal = 0;
+	size_t n = _problemSize, ns = _numberOfSensitivityParameters;
+
+	if (!outputSink)
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Invalid pointer to the output sink passed!");
+
+	numberOfOutputsReached = 0;
+
+	size_t chunkSize = std::min(outputTimes.size(), (size_t)OUTPUT_SINK_CHUNK_SIZE);
+	std::vector < double > chunkTimes, chunkY(std::max(chunkSize * n, (size_t)1)), chunkYS(std::max(chunkSize * n * ns, (size_t)1));
+
+	outputSink->BeginRun(runIndex);
+
+	try
+	{
+		for (size_t first = 0; first < outputTimes.size(); first += chunkSize)
+		{
+			size_t last = std::min(first + chunkSize, outputTimes.size());
+			chunkTimes.assign(outputTimes.begin() + first, outputTimes.begin() + last);
+
+			int numberOfChunkOutputsReached = 0;
+			retVal = PerformSolverSteps(chunkTimes, &chunkY[0], ns > 0 ? &chunkYS[0] : NULL, numberOfChunkOutputsReached);
+
+			for (int k = 0; k < numberOfChunkOutputsReached; k++)
+			{
+				outputSink->WriteOutput(runIndex, (int)first + k, chunkTimes[k], &chunkY[k * n], ns > 0 ? &chunkYS[k * n * ns] : NULL);
+				numberOfOutputsReached++;
+			}
+
+			//failure or root found
+			if ((retVal != 0) || (numberOfChunkOutputsReached < (int)chunkTimes.size()))
+				break;
+		}
+	}
+	catch (...)
+	{
+		outputSink->EndRun(runIndex, false);
+		throw;
+	}
+
+	outputSink->EndRun(runIndex, retVal == 0);
+
+	return retVal;
+}
+
+int SimModelSolverBase::EvaluateRootFunctions (double t, const double * y, double * g)
+{
+	const double * p = _numberOfSensitivityParameters > 0 ? &_sensitivityParametersInitialValues[0] : NULL;
+
+	Root_Return_Value rootRetVal = _solverCaller->ODERootFunction(t, y, p, g, NULL);
+	_statistics.NumberOfRootFunctionEvaluations++;
+
+	if (rootRetVal == ROOT_FAILED)
+		return -1;
+
+	return rootRetVal == ROOT_OK ? 0 : 1;
+}
+
+//true if root function changed its sign from a to b (leaving zero does not count)
+static bool RootCrossed (double a, double b)
+{
+	return ((a < 0.0) && (b >= 0.0)) || ((a > 0.0) && (b <= 0.0));
+}
+
+int SimModelSolverBase::LocateRoot (double tlo, const double * glo, double thi, const double * ghi)
+{
+	int k, retVal;
+	int ng = _numberOfRootFunctions;
+
+	std::vector < double > gLow(glo, glo + ng), gHigh(ghi, ghi + ng), gMid(ng);
+	_rootScratchY.resize(_problemSize);
+
+	double ttol = 100.0 * DBL_EPSILON * std::max(fabs(tlo), fabs(thi));
+	if (ttol <= 0.0)
+		ttol = DBL_MIN;
+
+	for (int iter = 0; (iter < 200) && (thi - tlo > ttol); iter++)
+	{
+		//secant estimate of the earliest crossing, safeguarded to shrink the interval by >= 10%
+		double tmid = thi;
+		for (k = 0; k < ng; k++)
+		{
+			if (RootCrossed(gLow[k], gHigh[k]))
+				tmid = std::min(tmid, tlo + (thi - tlo) * gLow[k] / (gLow[k] - gHigh[k]));
+		}
+
+		double margin = 0.1 * (thi - tlo);
+		tmid = std::max(tlo + margin, std::min(thi - margin, tmid));
+
+		retVal = InterpolateSolution(tmid, &_rootScratchY[0], NULL);
+		if (retVal != 0)
+			return retVal;
+
+		retVal = EvaluateRootFunctions(tmid, &_rootScratchY[0], &gMid[0]);
+		if (retVal != 0)
+			return retVal;
+
+		bool crossedInLowerPart = false;
+		for (k = 0; !crossedInLowerPart && (k < ng); k++)
+			crossedInLowerPart = RootCrossed(gLow[k], gMid[k]);
+
+		if (crossedInLowerPart)
+		{
+			thi = tmid;
+			gHigh.swap(gMid);
+		}
+		else
+		{
+			tlo = tmid;
+			gLow.swap(gMid);
+		}
+	}
+
+	//root is reported at the upper bound (all crossed functions have changed their sign there)
+	for (k = 0; k < ng; k++)
+	{
+		_rootsFound[k] = 0;
+		if (RootCrossed(gLow[k], gHigh[k]))
+			_rootsFound[k] = gHigh[k] > gLow[k] ? 1 : -1;
+	}
+
+	_rootSolution.resize(_problemSize);
+	retVal = InterpolateSolution(thi, _problemSize > 0 ? &_rootSolution[0] : NULL, NULL);
+	if (retVal != 0)
+		return retVal;
+
+	_rootFound = true;
+	_rootTime = thi;
+
+	for (k = 0; k < ng; k++)
+		_rootScratchGHigh[k] = gHigh[k];
+
+	return 0;
+}
+
+int SimModelSolverBase::CheckForRoots ()
+{
+	int k, retVal;
+
+	if (_numberOfRootFunctions == 0)
+		return 0;
+
+	const double * y1 = _problemSize > 0 ? &_denseY[1][0] : NULL;
+
+	if (!_rootScanValid)
+	{
+		//start of the integration: no roots at the initial time
+		retVal = EvaluateRootFunctions(_denseT[1], y1, &_rootScanValues[0]);
+		if (retVal != 0)
+			return retVal;
+
+		_rootScanTime = _denseT[1];
+		_rootScanValid = true;
+		return 0;
+	}
+
+	if (_denseT[1] <= _rootScanTime)
+		return 0;
+
+	retVal = EvaluateRootFunctions(_denseT[1], y1, &_rootScratchG[0]);
+	if (retVal != 0)
+		return retVal;
+
+	bool crossed = false;
+	for (k = 0; !crossed && (k < _numberOfRootFunctions); k++)
+		crossed = RootCrossed(_rootScanValues[k], _rootScratchG[k]);
+
+	if (crossed)
+	{
+		retVal = LocateRoot(_rootScanTime, &_rootScanValues[0], _denseT[1], &_rootScratchG[0]);
+		if (retVal != 0)
+			return retVal;
+
+		//continue the search behind the root
+		_rootScanTime = _rootTime;
+		_rootScanValues = _rootScratchGHigh;
+	}
+	else
+	{
+		_rootScanTime = _denseT[1];
+		_rootScanValues.swap(_rootScratchG);
+	}
+
+	return 0;
+}
+
+void SimModelSolverBase::SetRootFound (double rootTime, const std::vector < int > & rootsFound, const double * y)
+{
+	_rootFound = true;
+	_rootTime = rootTime;
+	_rootsFound = rootsFound;
+	_rootSolution.assign(y, y + _problemSize);
+}
+
+int SimModelSolverBase::GetNumberOfRootFunctions ()
+{
+	return _numberOfRootFunctions;
+}
+
+bool SimModelSolverBase::RootFound ()
+{
+	return _rootFound;
+}
+
+double SimModelSolverBase::GetRootTime ()
+{
+	return _rootTime;
+}
+
+const std::vector < int > & SimModelSolverBase::GetRootsFound () const
+{
+	return _rootsFound;
+}
+
+const std::vector < double > & SimModelSolverBase::GetRootSolution () const
+{
+	return _rootSolution;
+}
+
+int SimModelSolverBase::PerformBatchSolverStep (double /*tout*/, double * /*Y*/, double * /*YS*/, double * /*tret*/)
+{
+	const char * ERROR_SOURCE = "SimModelSolverBase::PerformBatchSolverStep";
+
+	//must be overwritten by solvers supporting batch mode
+	throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE,"Batch mode is not supported by the solver");
+}
+
+bool SimModelSolverBase::SupportsBatchMode ()
+{
+	return false;
+}
+
+bool SimModelSolverBase::SupportsLinearSolver (LinearSolverType linearSolver)
+{
+	return linearSolver == LS_DIRECT;
+}
+
+bool SimModelSolverBase::SupportsSensitivityActivation ()
+{
+	return false;
+}
+
+Rhs_Return_Value SimModelSolverBase::CallODERhsFunctionBatch(const double * t, const double * Y, const double * P, 
+	                                                         double * Ydot, void * f_data)
+{
+	if (_batchSolverCaller && _batchSolverCaller->IsSet_ODERhsFunctionBatch())
+	{
+		double startTime = _collectCallbackTimings ? CurrentTimeInSeconds() : 0.0;
+
+		Rhs_Return_Value batchRetVal = _batchSolverCaller->ODERhsFunctionBatch(t, Y, P, Ydot, _batchSize, f_data);
+
+		_statistics.NumberOfRhsEvaluations += _batchSize;
+		if (_collectCallbackTimings)
+			_statistics.RhsTime += CurrentTimeInSeconds() - startTime;
+
+		return batchRetVal;
+	}
+
+	//no batched RHS available: gather/scatter every problem and call the single RHS
+	_batchScratchY.resize(_problemSize);
+	_batchScratchP.resize(_numberOfSensitivityParameters);
+	_batchScratchYdot.resize(_problemSize);
+
+	Rhs_Return_Value retVal = RHS_OK;
+
+	for (int k = 0; k < _batchSize; k++)
+	{
+		int i;
+
+		for (i = 0; i < _problemSize; i++)
+			_batchScratchY[i] = Y[i * _batchSize + k];
+
+		for (i = 0; i < _numberOfSensitivityParameters; i++)
+			_batchScratchP[i] = P[i * _batchSize + k];
+
+		Rhs_Return_Value rhsRetVal = CallODERhsFunction(t[k], _problemSize > 0 ? &_batchScratchY[0] : NULL, 
+			                                            _numberOfSensitivityParameters > 0 ? &_batchScratchP[0] : NULL, 
+			                                            _problemSize > 0 ? &_batchScratchYdot[0] : NULL, f_data);
+
+		for (i = 0; i < _problemSize; i++)
+			Ydot[i * _batchSize + k] = _batchScratchYdot[i];
+
+		if (rhsRetVal == RHS_FAILED)
+			retVal = RHS_FAILED;
+		else if ((rhsRetVal == RHS_RECOVERABLE_ERROR) && (retVal == RHS_OK))
+			retVal = RHS_RECOVERABLE_ERROR;
+	}
+
+	return retVal;
+}
+
+Sensitivity_Rhs_Return_Value SimModelSolverBase::CallODESensitivityRhsFunction(double t, const double * y, double * ydot,
+	                                                                           const double * yS, double * ySdot, void * f_data)
+{
+	double startTime = _collectCallbackTimings ? CurrentTimeInSeconds() : 0.0;
+	Sensitivity_Rhs_Return_Value retVal = SENSITIVITY_RHS_OK;
 
-	_problemSize = 0;
-	this->SetProblemSize(problemSize);
-	
-	_numberOfSensitivityParameters = 0;
-	this->SetNumberOfSensitivityParameters(numberOfSensitivityParameters);
+	if (_solverCaller->IsSet_ODESensitivityRhsFunctionAll())
+	{
+		retVal = _solverCaller->ODESensitivityRhsFunctionAll(t, y, ydot, yS, ySdot, f_data);
+		_statistics.NumberOfSensitivityRhsEvaluations++;
+	}
+	else
+	{
+		for (int iS = 0; iS < _numberOfSensitivityParameters; iS++)
+		{
+			Sensitivity_Rhs_Return_Value sensRetVal = 
+				_solverCaller->ODESensitivityRhsFunction(t, y, ydot, iS, yS + iS * _problemSize, ySdot + iS * _problemSize, f_data);
+			_statistics.NumberOfSensitivityRhsEvaluations++;
 
-	_initialTime = 0.0;
-	_relTol = 1e-9;
-	
-	//default properties for ODE/DDE solver: 
-	//  - min/max/initial internal step
-	//  - max. no. of internal steps for the solver to reach the next output time point
-	_mxStep = 100000;
-	_h0 = 1e-10;
-	_hMin = 0.;
-	_hMax = 60;
-	
-	//Init-routine eas not called yet
-	_initialized = false;
-	
-	_delaysSize = 0;
+			if (sensRetVal == SENSITIVITY_RHS_FAILED)
+			{
+				retVal = SENSITIVITY_RHS_FAILED;
+				break;
+			}
+
+			if (sensRetVal == SENSITIVITY_RHS_RECOVERABLE_ERROR)
+				retVal = SENSITIVITY_RHS_RECOVERABLE_ERROR;
+		}
+	}
+
+	if (_collectCallbackTimings)
+		_statistics.SensitivityRhsTime += CurrentTimeInSeconds() - startTime;
+
+	return retVal;
 }
 
-SimModelSolverBase::~SimModelSolverBase ()
+Sensitivity_Rhs_Return_Value SimModelSolverBase::CallODESensitivityRhsFunction(double t, const double * y, double * ydot,
+	                                                                           const double * yS, double * ySdot, void * f_data,
+	                                                                           const std::vector < int > & parameters)
 {
+	size_t n = _problemSize, ns = _numberOfSensitivityParameters, numberOfParameters = parameters.size(), k;
+
+	if (numberOfParameters == ns)
+		return CallODESensitivityRhsFunction(t, y, ydot, yS, ySdot, f_data);
+
+	if (numberOfParameters == 0)
+		return SENSITIVITY_RHS_OK;
+
+	double startTime = _collectCallbackTimings ? CurrentTimeInSeconds() : 0.0;
+	Sensitivity_Rhs_Return_Value retVal = SENSITIVITY_RHS_OK;
+
+	if (_solverCaller->IsSet_ODESensitivityRhsFunctionAll())
+	{
+		//all parameters are evaluated (sensitivities of the others are 0)
+		_sensitivitySubsetScratchYS.assign(n * ns, 0.0);
+		_sensitivitySubsetScratchYSdot.resize(n * ns);
+
+		for (k = 0; k < numberOfParameters; k++)
+			std::copy(yS + k * n, yS + (k + 1) * n, _sensitivitySubsetScratchYS.begin() + parameters[k] * n);
+
+		retVal = _solverCaller->ODESensitivityRhsFunctionAll(t, y, ydot, &_sensitivitySubsetScratchYS[0], 
+			                                                 &_sensitivitySubsetScratchYSdot[0], f_data);
+		_statistics.NumberOfSensitivityRhsEvaluations++;
+
+		for (k = 0; k < numberOfParameters; k++)
+			std::copy(_sensitivitySubsetScratchYSdot.begin() + parameters[k] * n, _sensitivitySubsetScratchYSdot.begin() + (parameters[k] + 1) * n,
+			          ySdot + k * n);
+	}
+	else
+	{
+		for (k = 0; k < numberOfParameters; k++)
+		{
+			Sensitivity_Rhs_Return_Value sensRetVal = 
+				_solverCaller->ODESensitivityRhsFunction(t, y, ydot, parameters[k], yS + k * n, ySdot + k * n, f_data);
+			_statistics.NumberOfSensitivityRhsEvaluations++;
+
+			if (sensRetVal == SENSITIVITY_RHS_FAILED)
+			{
+				retVal = SENSITIVITY_RHS_FAILED;
+				break;
+			}
+
+			if (sensRetVal == SENSITIVITY_RHS_RECOVERABLE_ERROR)
+				retVal = SENSITIVITY_RHS_RECOVERABLE_ERROR;
+		}
+	}
+
+	if (_collectCallbackTimings)
+		_statistics.SensitivityRhsTime += CurrentTimeInSeconds() - startTime;
+
+	return retVal;
 }
 
-ISolverCaller * SimModelSolverBase::GetSolverCaller ()
+bool SimModelSolverBase::IsSensitivityParameterActive (int sensitivityParameterIndex)
 {
-	return _solverCaller;
+	if (!_sensitivityParametersActive.empty() && !_sensitivityParametersActive[sensitivityParameterIndex])
+		return false;
+
+	return _sensitivityParametersActivationPending.empty() || !_sensitivityParametersActivationPending[sensitivityParameterIndex];
 }
 
-void SimModelSolverBase::Init ()
+bool SimModelSolverBase::IsSensitivityParameterNeeded (int sensitivityParameterIndex, double t)
 {
-	const char * ERROR_SOURCE = "SimModelSolverInterface::Init";
+	if (!_sensitivityParametersActive.empty() && !_sensitivityParametersActive[sensitivityParameterIndex])
+		return false;
 
-	//general checks
-	if (!_solverCaller) //should never happen
-		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE,"Invalid pointer to the solver caller instance passed!");
-	
-	if (_problemSize == 0)
-		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE,"Invalid number of absolute tolerances passed");
+	if (_sensitivityWindowEndTimes.empty())
+		return true;
 
-	if ((long)_absTol.size() != _problemSize)
-		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE,"Number of absolute tolerances differs from problem size");
+	return t <= *std::max_element(_sensitivityWindowEndTimes.begin(), _sensitivityWindowEndTimes.end());
+}
+
+bool SimModelSolverBase::IsInSensitivityTimeWindow (double t)
+{
+	if (_sensitivityWindowEndTimes.empty())
+		return true;
 
-	if ((long)_initialValues.size() != _problemSize)
-		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE,"Number of initial value components differs from problem size");	
+	for (size_t k = 0; k < _sensitivityWindowEndTimes.size(); k++)
+		if ((t >= _sensitivityWindowStartTimes[k]) && (t <= _sensitivityWindowEndTimes[k]))
+			return true;
 
-	if ((long)_sensitivityParametersInitialValues.size() != _numberOfSensitivityParameters)
-		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Number of sensitivity parameters initial values differs from the number of sensitivity parameters");
+	return false;
+}
 
-	//solver dependent checks MUST be called by the routine of inherited class,
-	//which also MUST set _initialized = true in case of success
+bool SimModelSolverBase::DeactivateSensitivityParameters (double t)
+{
+	size_t numberOfActiveParameters = 0;
+
+	for (size_t k = 0; k < _activeSensitivityParameters.size(); k++)
+		if (IsSensitivityParameterNeeded(_activeSensitivityParameters[k], t))
+			_activeSensitivityParameters[numberOfActiveParameters++] = _activeSensitivityParameters[k];
+
+	if (numberOfActiveParameters == _activeSensitivityParameters.size())
+		return false;
+
+	_activeSensitivityParameters.resize(numberOfActiveParameters);
+
+	return true;
 }
 
-int SimModelSolverBase::ReInit (double t0, const std::vector < double > & y0)
+void SimModelSolverBase::ApplySensitivityActivation (double t, double * * yS)
 {
-	const char * ERROR_SOURCE = "SimModelSolverInterface::ReInit";
-	
-	//check Initialized status
-	if (!_initialized)
-		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE,"Solver was not initialized");
-	
-	//set new initial value
-	if ((long)y0.size() != _problemSize)
-		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE,"Initial value has invalid number of components");	
-	_initialValues = y0;
-	
-	//set new start time
-	_initialTime = t0;
-	
-	return SimModelSolverErrorData::err_OK;
-	
-	//Solver-dependent reinit will be performed by inherited class
-	//(which must call SimModelSolverInterface::ReInit first!)
+	int n = _problemSize, ns = _numberOfSensitivityParameters, i, j;
+
+	if ((yS == NULL) || (ns == 0))
+		return;
+
+	bool inTimeWindow = IsInSensitivityTimeWindow(t);
+
+	for (j = 0; j < ns; j++)
+	{
+		if (inTimeWindow && IsSensitivityParameterActive(j))
+			continue;
+
+		for (i = 0; i < n; i++)
+			yS[i][j] = 0.0;
+	}
 }
 
 int SimModelSolverBase::GetProblemSize ()
@@ -100,6 +2400,7 @@ void SimModelSolverBase::SetProblemSize (int problemSize)
 
 	//clear initial value
 	_initialValues.clear();
+	_batchInitialValues.clear();
 	
 	//clear absolute tolerances
 	//(DO NOT reset to default - user must set new AbsTol explicitely)
@@ -122,6 +2423,9 @@ void SimModelSolverBase::SetNumberOfSensitivityParameters(int numberOfSensitivit
 	_numberOfSensitivityParameters = numberOfSensitivityParameters;
 
 	_sensitivityParametersInitialValues.clear();
+	_batchSensitivityParametersInitialValues.clear();
+	_sensitivityParametersActive.clear();
+	_sensitivityParametersActivationPending.clear();
 
 	//reset initialized status
 	_initialized = false;
@@ -137,6 +2441,43 @@ void SimModelSolverBase::SetDelaysSize (int delaysSize)
     _delaysSize=delaysSize;
 }
 
+double SimModelSolverBase::GetMaxDelay ()
+{
+	return _maxDelay;
+}
+
+void SimModelSolverBase::SetMaxDelay (double maxDelay)
+{
+	const char * ERROR_SOURCE = "SimModelSolverBase::SetMaxDelay";
+
+	if (maxDelay < 0.0)
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Max. delay must not be negative");
+
+	_maxDelay = maxDelay;
+	_initialized = false;
+}
+
+int SimModelSolverBase::GetMaxNumberOfDelayHistoryPoints ()
+{
+	return _maxNumberOfDelayHistoryPoints;
+}
+
+void SimModelSolverBase::SetMaxNumberOfDelayHistoryPoints (int maxNumberOfDelayHistoryPoints)
+{
+	const char * ERROR_SOURCE = "SimModelSolverBase::SetMaxNumberOfDelayHistoryPoints";
+
+	if ((maxNumberOfDelayHistoryPoints != 0) && (maxNumberOfDelayHistoryPoints < 2))
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Max. number of DDE history points must be 0 (unlimited) or at least 2");
+
+	_maxNumberOfDelayHistoryPoints = maxNumberOfDelayHistoryPoints;
+	_initialized = false;
+}
+
+const SimModelSolverDelayHistory & SimModelSolverBase::GetDelayHistory () const
+{
+	return _delayHistory;
+}
+
 double SimModelSolverBase::GetInitialTime ()
 {
 	return _initialTime;
@@ -167,6 +2508,244 @@ void SimModelSolverBase::SetSensitivityParametersInitialValues(const std::vector
 	_sensitivityParametersInitialValues = initialValues;
 }
 
+bool SimModelSolverBase::UseSparseJacobian ()
+{
+	return _solverCaller && _solverCaller->IsSet_ODESparseJacFunction();
+}
+
+Sparse_Matrix_Format SimModelSolverBase::GetJacobianSparsityFormat ()
+{
+	return _jacobianSparsityFormat;
+}
+
+const std::vector < int > & SimModelSolverBase::GetJacobianSparsityIndexPointers () const
+{
+	return _jacobianSparsityIndexPointers;
+}
+
+const std::vector < int > & SimModelSolverBase::GetJacobianSparsityIndexValues () const
+{
+	return _jacobianSparsityIndexValues;
+}
+
+std::vector < OptionInfo > SimModelSolverBase::GetBaseSolverOptionsInfo ()
+{
+	std::vector < OptionInfo > optionsInfo;
+
+	OptionInfo linearSolverInfo;
+	linearSolverInfo.SetName(OPTION_LINEAR_SOLVER);
+	linearSolverInfo.SetDescription("Linear solver used in the Newton iteration");
+	linearSolverInfo.SetDataType(OptionInfo::SODT_ListOfValues);
+	linearSolverInfo.SetDefaultValue(LS_DIRECT);
+	linearSolverInfo.AddOptionValue(OptionValueInfo(LS_DIRECT, "Direct (dense/band/sparse)"));
+	if (SupportsLinearSolver(LS_GMRES))
+		linearSolverInfo.AddOptionValue(OptionValueInfo(LS_GMRES, "GMRES (matrix-free)"));
+	if (SupportsLinearSolver(LS_BICGSTAB))
+		linearSolverInfo.AddOptionValue(OptionValueInfo(LS_BICGSTAB, "BiCGStab (matrix-free)"));
+	optionsInfo.push_back(linearSolverInfo);
+
+	OptionInfo krylovInfo;
+	krylovInfo.SetName(OPTION_KRYLOV_MAX_DIMENSION);
+	krylovInfo.SetDescription("Max. dimension of the Krylov subspace (0 = solver default). Only used by iterative linear solvers");
+	krylovInfo.SetDataType(OptionInfo::SODT_Integer);
+	krylovInfo.SetDefaultValue(0);
+	krylovInfo.SetMinValue(0);
+	optionsInfo.push_back(krylovInfo);
+
+	OptionInfo probingInfo;
+	probingInfo.SetName(OPTION_JACOBIAN_SPARSITY_PROBING);
+	probingInfo.SetDescription("Determine sparsity pattern of the finite difference Jacobian by probing (only if the caller provides neither Jacobian nor sparsity/band structure)");
+	probingInfo.SetDataType(OptionInfo::SODT_ListOfValues);
+	probingInfo.SetDefaultValue(0);
+	probingInfo.AddOptionValue(OptionValueInfo(0, "Off (dense)"));
+	probingInfo.AddOptionValue(OptionValueInfo(1, "On"));
+	optionsInfo.push_back(probingInfo);
+
+	OptionInfo maxDelayInfo;
+	maxDelayInfo.SetName(OPTION_MAX_DELAY);
+	maxDelayInfo.SetDescription("Max. delay of the DDE system; older solution history is dropped (0 = keep complete history)");
+	maxDelayInfo.SetDataType(OptionInfo::SODT_Double);
+	maxDelayInfo.SetDefaultValue(0.0);
+	maxDelayInfo.SetMinValue(0.0);
+	optionsInfo.push_back(maxDelayInfo);
+
+	OptionInfo historyPointsInfo;
+	historyPointsInfo.SetName(OPTION_MAX_DELAY_HISTORY_POINTS);
+	historyPointsInfo.SetDescription("Max. number of stored DDE history points (0 = unlimited)");
+	historyPointsInfo.SetDataType(OptionInfo::SODT_Integer);
+	historyPointsInfo.SetDefaultValue(DEFAULT_MAX_DELAY_HISTORY_POINTS);
+	historyPointsInfo.SetMinValue(0);
+	optionsInfo.push_back(historyPointsInfo);
+
+	OptionInfo checkpointInfo;
+	checkpointInfo.SetName(OPTION_ADJOINT_CHECKPOINT_INTERVAL);
+	checkpointInfo.SetDescription("Number of internal steps between two checkpoints of the adjoint forward pass");
+	checkpointInfo.SetDataType(OptionInfo::SODT_Integer);
+	checkpointInfo.SetDefaultValue(100);
+	checkpointInfo.SetMinValue(1);
+	optionsInfo.push_back(checkpointInfo);
+
+	OptionInfo steadyStateInfo;
+	steadyStateInfo.SetName(OPTION_STEADY_STATE_DETECTION);
+	steadyStateInfo.SetDescription("Stop integration if a steady state is reached (remaining outputs are set to the steady state)");
+	steadyStateInfo.SetDataType(OptionInfo::SODT_ListOfValues);
+	steadyStateInfo.SetDefaultValue(0);
+	steadyStateInfo.AddOptionValue(OptionValueInfo(0, "Off"));
+	steadyStateInfo.AddOptionValue(OptionValueInfo(1, "States"));
+	steadyStateInfo.AddOptionValue(OptionValueInfo(2, "States and sensitivities"));
+	optionsInfo.push_back(steadyStateInfo);
+
+	OptionInfo steadyStateToleranceInfo;
+	steadyStateToleranceInfo.SetName(OPTION_STEADY_STATE_TOLERANCE);
+	steadyStateToleranceInfo.SetDescription("Steady state is reached if the weighted RMS norm of dy/dt (weights 1/(RelTol*|y|+AbsTol)) is below this value");
+	steadyStateToleranceInfo.SetDataType(OptionInfo::SODT_Double);
+	steadyStateToleranceInfo.SetDefaultValue(DEFAULT_STEADY_STATE_TOLERANCE);
+	steadyStateToleranceInfo.SetMinValue(0.0);
+	optionsInfo.push_back(steadyStateToleranceInfo);
+
+	return optionsInfo;
+}
+
+bool SimModelSolverBase::SetBaseSolverOption (const std::string & name, double value)
+{
+	const char * ERROR_SOURCE = "SimModelSolverBase::SetBaseSolverOption";
+
+	if (name == OPTION_LINEAR_SOLVER)
+	{
+		int linearSolver = (int)value;
+		if ((linearSolver != LS_DIRECT) && (linearSolver != LS_GMRES) && (linearSolver != LS_BICGSTAB))
+			throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE,"Invalid linear solver");
+
+		if (!SupportsLinearSolver((LinearSolverType)linearSolver))
+			throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE,"Linear solver is not supported by the solver");
+
+		SetLinearSolver((LinearSolverType)linearSolver);
+		return true;
+	}
+
+	if (name == OPTION_KRYLOV_MAX_DIMENSION)
+	{
+		SetKrylovMaxDimension((int)value);
+		return true;
+	}
+
+	if (name == OPTION_JACOBIAN_SPARSITY_PROBING)
+	{
+		SetJacobianSparsityProbing(value != 0.0);
+		return true;
+	}
+
+	if (name == OPTION_MAX_DELAY)
+	{
+		SetMaxDelay(value);
+		return true;
+	}
+
+	if (name == OPTION_MAX_DELAY_HISTORY_POINTS)
+	{
+		SetMaxNumberOfDelayHistoryPoints((int)value);
+		return true;
+	}
+
+	if (name == OPTION_ADJOINT_CHECKPOINT_INTERVAL)
+	{
+		SetAdjointCheckpointInterval((int)value);
+		return true;
+	}
+
+	if (name == OPTION_STEADY_STATE_DETECTION)
+	{
+		int steadyStateDetection = (int)value;
+		if ((steadyStateDetection < 0) || (steadyStateDetection > 2))
+			throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE,"Invalid steady state detection mode");
+
+		SetSteadyStateDetection(steadyStateDetection > 0);
+		SetSteadyStateSensitivities(steadyStateDetection == 2);
+		return true;
+	}
+
+	if (name == OPTION_STEADY_STATE_TOLERANCE)
+	{
+		SetSteadyStateTolerance(value);
+		return true;
+	}
+
+	return false;
+}
+
+SimModelSolverBase::LinearSolverType SimModelSolverBase::GetLinearSolver ()
+{
+	return _linearSolver;
+}
+
+void SimModelSolverBase::SetLinearSolver (LinearSolverType linearSolver)
+{
+	if (_linearSolver == linearSolver)
+		return; //nothing to do
+
+	_linearSolver = linearSolver;
+
+	//solver must set up another linear solver
+	_initialized = false;
+}
+
+int SimModelSolverBase::GetKrylovMaxDimension ()
+{
+	return _krylovMaxDimension;
+}
+
+void SimModelSolverBase::SetKrylovMaxDimension (int krylovMaxDimension)
+{
+	const char * ERROR_SOURCE = "SimModelSolverBase::SetKrylovMaxDimension";
+
+	if (krylovMaxDimension < 0)
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE,"Max. Krylov dimension must be >= 0");
+
+	_krylovMaxDimension = krylovMaxDimension;
+}
+
+int SimModelSolverBase::GetBatchSize ()
+{
+	return _batchSize;
+}
+
+void SimModelSolverBase::SetBatchSize (int batchSize)
+{
+	if (batchSize < 1)
+		batchSize = 1;
+
+	if (_batchSize == batchSize)
+		return; //nothing to do
+
+	_batchSize = batchSize;
+
+	_batchInitialValues.clear();
+	_batchSensitivityParametersInitialValues.clear();
+
+	//reset initialized status
+	_initialized = false;
+}
+
+std::vector < double > SimModelSolverBase::GetBatchInitialValues ()
+{
+	return _batchInitialValues;
+}
+
+void SimModelSolverBase::SetBatchInitialValues (const std::vector < double > & batchInitialValues)
+{
+	_batchInitialValues = batchInitialValues;
+}
+
+std::vector < double > SimModelSolverBase::GetBatchSensitivityParametersInitialValues ()
+{
+	return _batchSensitivityParametersInitialValues;
+}
+
+void SimModelSolverBase::SetBatchSensitivityParametersInitialValues (const std::vector < double > & batchInitialValues)
+{
+	_batchSensitivityParametersInitialValues = batchInitialValues;
+}
+
 double SimModelSolverBase::GetRelTol ()
 {
 	return _relTol;
@@ -253,3 +2832,121 @@ void SimModelSolverBase::SetHMax (double hMax)
     _hMax=hMax;
 }
 
+SimModelSolverJacobianCache * SimModelSolverBase::GetJacobianCache ()
+{
+	return _jacobianCache;
+}
+
+void SimModelSolverBase::SetJacobianCache (SimModelSolverJacobianCache * jacobianCache)
+{
+	_jacobianCache = jacobianCache;
+}
+
+std::vector < double > SimModelSolverBase::GetJacobianCacheParameters ()
+{
+	std::vector < double > parameters(_sensitivityParametersInitialValues);
+	parameters.insert(parameters.end(), _jacobianCacheParameters.begin(), _jacobianCacheParameters.end());
+
+	return parameters;
+}
+
+void SimModelSolverBase::SetJacobianCacheParameters (const std::vector < double > & parameters)
+{
+	_jacobianCacheParameters = parameters;
+}
+
+SimModelSolverStepSizeProfile * SimModelSolverBase::GetStepSizeProfile ()
+{
+	return _stepSizeProfile;
+}
+
+void SimModelSolverBase::SetStepSizeProfile (SimModelSolverStepSizeProfile * stepSizeProfile)
+{
+	_stepSizeProfile = stepSizeProfile;
+}
+
+SimModelSolverStepSizeProfile * SimModelSolverBase::GetStepSizeProfileRecording ()
+{
+	return _stepSizeProfileRecording;
+}
+
+void SimModelSolverBase::SetStepSizeProfileRecording (SimModelSolverStepSizeProfile * stepSizeProfile)
+{
+	_stepSizeProfileRecording = stepSizeProfile;
+}
+
+double SimModelSolverBase::GetStepSizeProfileMaxStepFactor ()
+{
+	return _stepSizeProfileMaxStepFactor;
+}
+
+void SimModelSolverBase::SetStepSizeProfileMaxStepFactor (double maxStepFactor)
+{
+	const char * ERROR_SOURCE = "SimModelSolverBase::SetStepSizeProfileMaxStepFactor";
+
+	if (maxStepFactor < 0.0)
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Max. step factor must be >= 0");
+
+	_stepSizeProfileMaxStepFactor = maxStepFactor;
+}
+
+bool SimModelSolverBase::GetSensitivityParameterActive (int sensitivityParameterIndex)
+{
+	const char * ERROR_SOURCE = "SimModelSolverBase::GetSensitivityParameterActive";
+
+	if ((sensitivityParameterIndex < 0) || (sensitivityParameterIndex >= _numberOfSensitivityParameters))
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Invalid sensitivity parameter index");
+
+	return IsSensitivityParameterActive(sensitivityParameterIndex);
+}
+
+void SimModelSolverBase::SetSensitivityParameterActive (int sensitivityParameterIndex, bool active)
+{
+	const char * ERROR_SOURCE = "SimModelSolverBase::SetSensitivityParameterActive";
+
+	if ((sensitivityParameterIndex < 0) || (sensitivityParameterIndex >= _numberOfSensitivityParameters))
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Invalid sensitivity parameter index");
+
+	if (_sensitivityParametersActive.empty())
+		_sensitivityParametersActive.assign(_numberOfSensitivityParameters, true);
+
+	_sensitivityParametersActive[sensitivityParameterIndex] = active;
+
+	//dy/dp needs the history from the initial time: a parameter not integrated now is activated by the next Init
+	if ((size_t)_numberOfSensitivityParameters != _sensitivityParametersActivationPending.size())
+		return;
+
+	_sensitivityParametersActivationPending[sensitivityParameterIndex] = active && _initialized &&
+		(std::find(_activeSensitivityParameters.begin(), _activeSensitivityParameters.end(), sensitivityParameterIndex) == _activeSensitivityParameters.end());
+}
+
+std::vector < int > SimModelSolverBase::GetActiveSensitivityParameters ()
+{
+	return _activeSensitivityParameters;
+}
+
+std::vector < double > SimModelSolverBase::GetSensitivityTimeWindowStartTimes ()
+{
+	return _sensitivityWindowStartTimes;
+}
+
+std::vector < double > SimModelSolverBase::GetSensitivityTimeWindowEndTimes ()
+{
+	return _sensitivityWindowEndTimes;
+}
+
+void SimModelSolverBase::SetSensitivityTimeWindows (const std::vector < double > & startTimes, const std::vector < double > & endTimes)
+{
+	const char * ERROR_SOURCE = "SimModelSolverBase::SetSensitivityTimeWindows";
+
+	if (startTimes.size() != endTimes.size())
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Number of start times differs from number of end times");
+
+	for (size_t k = 0; k < startTimes.size(); k++)
+		if (!(startTimes[k] <= endTimes[k]))
+			throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Start time of a sensitivity time window is after its end time");
+
+	_sensitivityWindowStartTimes = startTimes;
+	_sensitivityWindowEndTimes = endTimes;
+}
+
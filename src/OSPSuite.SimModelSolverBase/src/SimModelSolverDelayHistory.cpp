@@ -0,0 +1,339 @@
+#include "SimModelSolverBase/SimModelSolverDelayHistory.h"
+#include <cstring>
+
+//initial capacity of the ring buffer (number of points)
+const int DELAY_HISTORY_INITIAL_CAPACITY = 64;
+
+SimModelSolverDelayHistory::SimModelSolverDelayHistory ()
+{
+	_problemSize = 0;
+	_maxDelay = 0.0;
+	_maxNumberOfPoints = 0;
+	_capacity = 0;
+
+	Clear();
+}
+
+void SimModelSolverDelayHistory::Init (int problemSize, double maxDelay, int maxNumberOfPoints)
+{
+	const char * ERROR_SOURCE = "SimModelSolverDelayHistory::Init";
+
+	if (problemSize < 0)
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Invalid problem size");
+	if (maxDelay < 0.0)
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Max. delay must not be negative");
+	if ((maxNumberOfPoints != 0) && (maxNumberOfPoints < 2))
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Max. number of history points must be 0 (unlimited) or at least 2");
+
+	//memory of a previous run is kept if the problem size did not change
+	if (problemSize != _problemSize)
+	{
+		_capacity = 0;
+		_times.clear();
+		_values.clear();
+		_derivatives.clear();
+	}
+
+	_problemSize = problemSize;
+	_maxDelay = maxDelay;
+	_maxNumberOfPoints = maxNumberOfPoints;
+
+	Clear();
+}
+
+void SimModelSolverDelayHistory::Clear ()
+{
+	_first = 0;
+	_numberOfPoints = 0;
+	_truncated = false;
+	_lastInterval = 0;
+}
+
+int SimModelSolverDelayHistory::PhysicalIndex (int k) const
+{
+	int index = _first + k;
+	return index < _capacity ? index : index - _capacity;
+}
+
+double SimModelSolverDelayHistory::TimeAt (int k) const
+{
+	return _times[PhysicalIndex(k)];
+}
+
+void SimModelSolverDelayHistory::Grow ()
+{
+	const char * ERROR_SOURCE = "SimModelSolverDelayHistory::Grow";
+
+	int newCapacity = _capacity > 0 ? 2 * _capacity : DELAY_HISTORY_INITIAL_CAPACITY;
+	if ((_maxNumberOfPoints > 0) && (newCapacity > _maxNumberOfPoints))
+		newCapacity = _maxNumberOfPoints;
+
+	if (newCapacity <= _capacity)
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Max. number of DDE history points exceeded (increase max. number of history points or set max. delay)");
+
+	size_t n = _problemSize;
+	std::vector < double > times(newCapacity), values(newCapacity * n), derivatives(newCapacity * n);
+
+	//store points in logical order from index 0
+	for (int k = 0; k < _numberOfPoints; k++)
+	{
+		int idx = PhysicalIndex(k);
+
+		times[k] = _times[idx];
+		if (n > 0)
+		{
+			memcpy(&values[k * n], &_values[idx * n], n * sizeof(double));
+			memcpy(&derivatives[k * n], &_derivatives[idx * n], n * sizeof(double));
+		}
+	}
+
+	_times.swap(times);
+	_values.swap(values);
+	_derivatives.swap(derivatives);
+
+	_capacity = newCapacity;
+	_first = 0;
+}
+
+void SimModelSolverDelayHistory::AddPoint (double t, const double * y, const double * ydot)
+{
+	const char * ERROR_SOURCE = "SimModelSolverDelayHistory::AddPoint";
+
+	size_t n = _problemSize;
+
+	if (_numberOfPoints > 0)
+	{
+		double lastTime = GetLastTime();
+
+		if (t < lastTime)
+			throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "DDE history points must be added in increasing time order");
+
+		//same time: replace last point
+		if (t == lastTime)
+			_numberOfPoints--;
+	}
+
+	//drop points which are not needed anymore: one point at or before t - maxDelay is kept for interpolation
+	if (_maxDelay > 0.0)
+	{
+		double oldestTimeNeeded = t - _maxDelay;
+		int numberOfDroppedPoints = 0;
+
+		while ((_numberOfPoints >= 2) && (TimeAt(1) <= oldestTimeNeeded))
+		{
+			_first = PhysicalIndex(1);
+			_numberOfPoints--;
+			numberOfDroppedPoints++;
+		}
+
+		if (numberOfDroppedPoints > 0)
+		{
+			_truncated = true;
+			_lastInterval = _lastInterval > numberOfDroppedPoints ? _lastInterval - numberOfDroppedPoints : 0;
+		}
+	}
+
+	if (_numberOfPoints == _capacity)
+		Grow();
+
+	int idx = PhysicalIndex(_numberOfPoints);
+
+	_times[idx] = t;
+	if (n > 0)
+	{
+		memcpy(&_values[idx * n], y, n * sizeof(double));
+		memcpy(&_derivatives[idx * n], ydot, n * sizeof(double));
+	}
+
+	_numberOfPoints++;
+}
+
+void SimModelSolverDelayHistory::RemovePointsAfter (double t)
+{
+	while ((_numberOfPoints > 0) && (GetLastTime() > t))
+		_numberOfPoints--;
+
+	if (_lastInterval > _numberOfPoints - 2)
+		_lastInterval = _numberOfPoints > 1 ? _numberOfPoints - 2 : 0;
+}
+
+int SimModelSolverDelayHistory::GetNumberOfPoints () const
+{
+	return _numberOfPoints;
+}
+
+int SimModelSolverDelayHistory::GetCapacity () const
+{
+	return _capacity;
+}
+
+double SimModelSolverDelayHistory::GetFirstTime () const
+{
+	return _numberOfPoints > 0 ? TimeAt(0) : 0.0;
+}
+
+double SimModelSolverDelayHistory::GetLastTime () const
+{
+	return _numberOfPoints > 0 ? TimeAt(_numberOfPoints - 1) : 0.0;
+}
+
+int SimModelSolverDelayHistory::FindInterval (double t)
+{
+	if (t < TimeAt(0))
+		return -1;
+
+	int lastIntervalIndex = _numberOfPoints - 2;
+
+	//delays change slowly: check interval of the previous lookup and its successor first
+	if (_lastInterval <= lastIntervalIndex)
+	{
+		if ((t >= TimeAt(_lastInterval)) && (t <= TimeAt(_lastInterval + 1)))
+			return _lastInterval;
+
+		if ((_lastInterval < lastIntervalIndex) && (t >= TimeAt(_lastInterval + 1)) && (t <= TimeAt(_lastInterval + 2)))
+			return ++_lastInterval;
+	}
+
+	//beyond the last point: extrapolate last interval
+	if (t >= TimeAt(lastIntervalIndex + 1))
+		return _lastInterval = lastIntervalIndex;
+
+	//binary search: t_low <= t < t_high
+	int low = 0, high = lastIntervalIndex + 1;
+	while (high - low > 1)
+	{
+		int middle = (low + high) / 2;
+
+		if (TimeAt(middle) <= t)
+			low = middle;
+		else
+			high = middle;
+	}
+
+	return _lastInterval = low;
+}
+
+void SimModelSolverDelayHistory::InterpolationCoefficients (double t, int & idx0, int & idx1, double * coefficients)
+{
+	const char * ERROR_SOURCE = "SimModelSolverDelayHistory::InterpolationCoefficients";
+
+	if (_numberOfPoints == 0)
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "DDE history is empty");
+
+	if ((_numberOfPoints == 1) || (t < TimeAt(0)))
+	{
+		if ((t < TimeAt(0)) && _truncated)
+			throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Delayed time is older than the stored DDE history (max. delay too small)");
+
+		//constant initial history; single point: linear extrapolation
+		idx0 = idx1 = PhysicalIndex(0);
+		double dt = t > _times[idx0] ? t - _times[idx0] : 0.0;
+
+		coefficients[0] = 1.0;
+		coefficients[1] = dt;
+		coefficients[2] = 0.0;
+		coefficients[3] = 0.0;
+
+		return;
+	}
+
+	int k = FindInterval(t);
+	idx0 = PhysicalIndex(k);
+	idx1 = PhysicalIndex(k + 1);
+
+	double t0 = _times[idx0];
+	double h = _times[idx1] - t0;
+
+	//cubic Hermite basis (computed once for all components)
+	double s = (t - t0) / h;
+	double s2 = s * s, s3 = s2 * s;
+
+	coefficients[0] = 2.0 * s3 - 3.0 * s2 + 1.0;
+	coefficients[1] = (s3 - 2.0 * s2 + s) * h;
+	coefficients[2] = -2.0 * s3 + 3.0 * s2;
+	coefficients[3] = (s3 - s2) * h;
+}
+
+void SimModelSolverDelayHistory::Interpolate (double t, double * y)
+{
+	int n = _problemSize, idx0, idx1;
+	double c[4];
+
+	InterpolationCoefficients(t, idx0, idx1, c);
+
+	const double * y0 = &_values[(size_t)idx0 * n];
+	const double * f0 = &_derivatives[(size_t)idx0 * n];
+	const double * y1 = &_values[(size_t)idx1 * n];
+	const double * f1 = &_derivatives[(size_t)idx1 * n];
+
+	for (int i = 0; i < n; i++)
+		y[i] = c[0] * y0[i] + c[1] * f0[i] + c[2] * y1[i] + c[3] * f1[i];
+}
+
+void SimModelSolverDelayHistory::InterpolateDelays (int numberOfDelays, const double * delayTimes, double * * yd)
+{
+	int n = _problemSize, idx0, idx1;
+	double c[4];
+
+	for (int j = 0; j < numberOfDelays; j++)
+	{
+		InterpolationCoefficients(delayTimes[j], idx0, idx1, c);
+
+		const double * y0 = &_values[(size_t)idx0 * n];
+		const double * f0 = &_derivatives[(size_t)idx0 * n];
+		const double * y1 = &_values[(size_t)idx1 * n];
+		const double * f1 = &_derivatives[(size_t)idx1 * n];
+
+		for (int i = 0; i < n; i++)
+			yd[i][j] = c[0] * y0[i] + c[1] * f0[i] + c[2] * y1[i] + c[3] * f1[i];
+	}
+}
+
+void SimModelSolverDelayHistory::SaveState (SimModelSolverState & state) const
+{
+	size_t n = _problemSize;
+
+	state.WriteInt(_problemSize);
+	state.WriteBool(_truncated);
+	state.WriteInt(_numberOfPoints);
+
+	//points in logical order
+	for (int k = 0; k < _numberOfPoints; k++)
+	{
+		int idx = PhysicalIndex(k);
+
+		state.WriteDouble(_times[idx]);
+		state.WriteDoubles(n > 0 ? &_values[idx * n] : NULL, n);
+		state.WriteDoubles(n > 0 ? &_derivatives[idx * n] : NULL, n);
+	}
+}
+
+void SimModelSolverDelayHistory::RestoreState (const SimModelSolverState & state, size_t & position)
+{
+	const char * ERROR_SOURCE = "SimModelSolverDelayHistory::RestoreState";
+
+	if (state.ReadInt(position) != _problemSize)
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "DDE history in solver state has different problem size");
+
+	bool truncated = state.ReadBool(position);
+	int numberOfPoints = state.ReadInt(position);
+
+	if ((numberOfPoints < 0) || ((_maxNumberOfPoints > 0) && (numberOfPoints > _maxNumberOfPoints)))
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Invalid number of DDE history points in solver state");
+
+	Clear();
+	while (_capacity < numberOfPoints)
+		Grow();
+
+	size_t n = _problemSize;
+
+	for (int k = 0; k < numberOfPoints; k++)
+	{
+		_times[k] = state.ReadDouble(position);
+		state.ReadDoubles(position, n > 0 ? &_values[k * n] : NULL, n);
+		state.ReadDoubles(position, n > 0 ? &_derivatives[k * n] : NULL, n);
+	}
+
+	_numberOfPoints = numberOfPoints;
+	_truncated = truncated;
+}
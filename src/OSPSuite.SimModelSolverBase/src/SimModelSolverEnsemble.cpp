@@ -0,0 +1,558 @@
+#include "SimModelSolverBase/SimModelSolverEnsemble.h"
+
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <limits>
+#include <exception>
+
+//Queue of run indices of one worker.
+//Owner takes runs from the front, other workers steal from the back
+class EnsembleWorkQueue
+{
+	private:
+		std::deque < int > _runs;
+		std::mutex _mutex;
+
+	public:
+		void Push (int runIndex)
+		{
+			std::lock_guard < std::mutex > lock(_mutex);
+			_runs.push_back(runIndex);
+		}
+
+		bool PopFront (int & runIndex)
+		{
+			std::lock_guard < std::mutex > lock(_mutex);
+			if (_runs.empty())
+				return false;
+			runIndex = _runs.front();
+			_runs.pop_front();
+			return true;
+		}
+
+		bool StealBack (int & runIndex)
+		{
+			std::lock_guard < std::mutex > lock(_mutex);
+			if (_runs.empty())
+				return false;
+			runIndex = _runs.back();
+			_runs.pop_back();
+			return true;
+		}
+};
+
+//Solvers, work queues and threads of one Run call.
+//Destructor joins all started threads first, then frees the queues and terminates and releases 
+//the solvers, so nothing leaks if Run is left by an exception (e.g. thread creation failed)
+class EnsembleRunResources
+{
+	private:
+		ISimModelSolverFactory * _solverFactory;
+
+	public:
+		std::vector < SimModelSolverBase * > Solvers;
+		std::vector < EnsembleWorkQueue * > WorkQueues;
+		std::vector < std::thread > Threads;
+
+		EnsembleRunResources (ISimModelSolverFactory * solverFactory)
+		{
+			_solverFactory = solverFactory;
+		}
+
+		~EnsembleRunResources ()
+		{
+			size_t i;
+
+			for (i = 0; i < Threads.size(); i++)
+			{
+				if (Threads[i].joinable())
+					Threads[i].join();
+			}
+
+			for (i = 0; i < WorkQueues.size(); i++)
+				delete WorkQueues[i];
+
+			for (i = 0; i < Solvers.size(); i++)
+			{
+				try
+				{
+					if (Solvers[i]->IsInitialized())
+						Solvers[i]->Terminate();
+				}
+				catch (...)
+				{
+					//results are already stored
+				}
+
+				_solverFactory->ReleaseSolver(Solvers[i]);
+			}
+		}
+
+	private:
+		EnsembleRunResources (const EnsembleRunResources &);
+		EnsembleRunResources & operator = (const EnsembleRunResources &);
+};
+
+SimModelSolverEnsemble::SimModelSolverEnsemble (ISimModelSolverFactory * solverFactory, int numberOfThreads)
+{
+	_solverFactory = solverFactory;
+	_problemSize = 0;
+	_numberOfSensitivityParameters = 0;
+	_resultCache = NULL;
+	_jacobianCache = NULL;
+	_stepSizeProfile = NULL;
+	SetNumberOfThreads(numberOfThreads);
+}
+
+SimModelSolverEnsemble::~SimModelSolverEnsemble ()
+{
+}
+
+int SimModelSolverEnsemble::GetNumberOfThreads ()
+{
+	return _numberOfThreads;
+}
+
+void SimModelSolverEnsemble::SetNumberOfThreads (int numberOfThreads)
+{
+	_numberOfThreads = numberOfThreads;
+	if (_numberOfThreads < 0)
+		_numberOfThreads = 0;
+}
+
+std::vector < double > SimModelSolverEnsemble::GetOutputTimes ()
+{
+	return _outputTimes;
+}
+
+void SimModelSolverEnsemble::SetOutputTimes (const std::vector < double > & outputTimes)
+{
+	_outputTimes = outputTimes;
+}
+
+int SimModelSolverEnsemble::AddRun (const std::vector < double > & initialValues,
+	                                const std::vector < double > & sensitivityParametersValues)
+{
+	_initialValues.push_back(initialValues);
+	_sensitivityParametersValues.push_back(sensitivityParametersValues);
+
+	return (int)_initialValues.size() - 1;
+}
+
+int SimModelSolverEnsemble::GetNumberOfRuns ()
+{
+	return (int)_initialValues.size();
+}
+
+void SimModelSolverEnsemble::ClearRuns ()
+{
+	_initialValues.clear();
+	_sensitivityParametersValues.clear();
+	_runErrors.clear();
+}
+
+void SimModelSolverEnsemble::GetProblemDimensions (int & problemSize, int & numberOfSensitivityParameters)
+{
+	const char * ERROR_SOURCE = "SimModelSolverEnsemble::GetProblemDimensions";
+
+	if (!_solverFactory)
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Invalid pointer to the solver factory passed!");
+
+	SimModelSolverBase * solver = _solverFactory->CreateSolver();
+	if (!solver)
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Solver factory failed to create a solver");
+
+	problemSize = solver->GetProblemSize();
+	numberOfSensitivityParameters = solver->GetNumberOfSensitivityParameters();
+
+	_solverFactory->ReleaseSolver(solver);
+}
+
+const SimModelSolverErrorData & SimModelSolverEnsemble::GetRunError (int runIndex) const
+{
+	const char * ERROR_SOURCE = "SimModelSolverEnsemble::GetRunError";
+
+	if ((runIndex < 0) || (runIndex >= (int)_runErrors.size()))
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Invalid run index");
+
+	return _runErrors[runIndex];
+}
+
+void SimModelSolverEnsemble::SetResultCache (SimModelSolverResultCache * resultCache, const std::string & modelIdentifier)
+{
+	_resultCache = resultCache;
+	_resultCacheModelIdentifier = modelIdentifier;
+}
+
+SimModelSolverResultCache * SimModelSolverEnsemble::GetResultCache ()
+{
+	return _resultCache;
+}
+
+void SimModelSolverEnsemble::SetJacobianCache (SimModelSolverJacobianCache * jacobianCache)
+{
+	_jacobianCache = jacobianCache;
+}
+
+SimModelSolverJacobianCache * SimModelSolverEnsemble::GetJacobianCache ()
+{
+	return _jacobianCache;
+}
+
+void SimModelSolverEnsemble::SetStepSizeProfile (SimModelSolverStepSizeProfile * stepSizeProfile)
+{
+	_stepSizeProfile = stepSizeProfile;
+}
+
+SimModelSolverStepSizeProfile * SimModelSolverEnsemble::GetStepSizeProfile ()
+{
+	return _stepSizeProfile;
+}
+
+int SimModelSolverEnsemble::Run (double * solution, double * sensitivities)
+{
+	const char * ERROR_SOURCE = "SimModelSolverEnsemble::Run";
+
+	if (!solution)
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Invalid solution buffer passed");
+
+	return RunAll(solution, sensitivities, NULL);
+}
+
+int SimModelSolverEnsemble::Run (ISolverOutputSink * outputSink)
+{
+	const char * ERROR_SOURCE = "SimModelSolverEnsemble::Run";
+
+	if (!outputSink)
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Invalid pointer to the output sink passed!");
+
+	return RunAll(NULL, NULL, outputSink);
+}
+
+int SimModelSolverEnsemble::RunAll (double * solution, double * sensitivities, ISolverOutputSink * outputSink)
+{
+	const char * ERROR_SOURCE = "SimModelSolverEnsemble::Run";
+	int runIndex, workerIndex;
+
+	if (!_solverFactory)
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Invalid pointer to the solver factory passed!");
+
+	int numberOfRuns = GetNumberOfRuns();
+
+	_runErrors.clear();
+	_runErrors.resize(numberOfRuns);
+
+	if (numberOfRuns == 0)
+		return 0;
+
+	int numberOfWorkers = _numberOfThreads;
+	if (numberOfWorkers == 0)
+		numberOfWorkers = (int)std::thread::hardware_concurrency();
+	if (numberOfWorkers < 1)
+		numberOfWorkers = 1;
+	if (numberOfWorkers > numberOfRuns)
+		numberOfWorkers = numberOfRuns;
+
+	//create one solver per worker (sequentially, so the factory need not be thread safe)
+	EnsembleRunResources resources(_solverFactory);
+	std::vector < SimModelSolverBase * > & solvers = resources.Solvers;
+	solvers.reserve(numberOfWorkers);
+
+	for (workerIndex = 0; workerIndex < numberOfWorkers; workerIndex++)
+	{
+		SimModelSolverBase * solver = _solverFactory->CreateSolver();
+		if (!solver)
+			throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Solver factory failed to create a solver");
+		solvers.push_back(solver);
+
+		if (_jacobianCache)
+			solver->SetJacobianCache(_jacobianCache);
+
+		if (_stepSizeProfile)
+			solver->SetStepSizeProfile(_stepSizeProfile);
+
+		if (workerIndex == 0)
+		{
+			_problemSize = solver->GetProblemSize();
+			_numberOfSensitivityParameters = solver->GetNumberOfSensitivityParameters();
+		}
+		else if ((solver->GetProblemSize() != _problemSize) ||
+			     (solver->GetNumberOfSensitivityParameters() != _numberOfSensitivityParameters))
+			throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Solvers created by the factory have different problem dimensions");
+	}
+
+	if ((_numberOfSensitivityParameters > 0) && !sensitivities && !outputSink)
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Invalid sensitivities buffer passed");
+
+	//distribute runs in contiguous blocks (neighbouring runs share output memory pages)
+	std::vector < EnsembleWorkQueue * > & workQueues = resources.WorkQueues;
+	workQueues.reserve(numberOfWorkers);
+	for (workerIndex = 0; workerIndex < numberOfWorkers; workerIndex++)
+		workQueues.push_back(new EnsembleWorkQueue());
+
+	for (runIndex = 0; runIndex < numberOfRuns; runIndex++)
+		workQueues[(int)((long long)runIndex * numberOfWorkers / numberOfRuns)]->Push(runIndex);
+
+	//worker 0 runs in the calling thread
+	std::vector < std::thread > & threads = resources.Threads;
+	threads.reserve(numberOfWorkers - 1);
+	for (workerIndex = 1; workerIndex < numberOfWorkers; workerIndex++)
+		threads.push_back(std::thread(&SimModelSolverEnsemble::WorkerThread, this, solvers[workerIndex], workerIndex,
+		                              std::ref(workQueues), solution, sensitivities, outputSink));
+
+	WorkerThread(solvers[0], 0, workQueues, solution, sensitivities, outputSink);
+
+	for (size_t i = 0; i < threads.size(); i++)
+		threads[i].join();
+
+	int numberOfFailedRuns = 0;
+	for (runIndex = 0; runIndex < numberOfRuns; runIndex++)
+	{
+		if (_runErrors[runIndex].GetNumber() != SimModelSolverErrorData::err_OK)
+			numberOfFailedRuns++;
+	}
+
+	return numberOfFailedRuns;
+}
+
+void SimModelSolverEnsemble::WorkerThread (SimModelSolverBase * solver, int workerIndex, std::vector < EnsembleWorkQueue * > & workQueues,
+	                                       double * solution, double * sensitivities, ISolverOutputSink * outputSink)
+{
+	int numberOfWorkers = (int)workQueues.size();
+	int runIndex;
+
+	for (;;)
+	{
+		bool found = workQueues[workerIndex]->PopFront(runIndex);
+
+		//own queue is empty: try to steal from other workers
+		for (int i = 1; !found && (i < numberOfWorkers); i++)
+			found = workQueues[(workerIndex + i) % numberOfWorkers]->StealBack(runIndex);
+
+		//runs are never added during Run: no more work if all queues are empty
+		if (!found)
+			return;
+
+		RunSingle(solver, runIndex, solution, sensitivities, outputSink);
+	}
+}
+
+void SimModelSolverEnsemble::RunSingle (SimModelSolverBase * solver, int runIndex, double * solution, double * sensitivities, ISolverOutputSink * outputSink)
+{
+	const char * ERROR_SOURCE = "SimModelSolverEnsemble::RunSingle";
+
+	int numberOfOutputTimes = (int)_outputTimes.size();
+	size_t solutionOffset = (size_t)runIndex * numberOfOutputTimes * _problemSize;
+	size_t sensitivitiesOffset = solutionOffset * _numberOfSensitivityParameters;
+	int outputIndex = 0, i;
+	bool runStarted = false;
+
+	std::vector < double * > yS(_problemSize > 0 ? _problemSize : 1, (double *)NULL);
+
+	//output sink: outputs of ONE time point are buffered and passed to the sink
+	//(outputs of all time points if the result is stored in the result cache)
+	size_t numberOfSinkOutputs = _resultCache ? numberOfOutputTimes : 1;
+	size_t runSolutionSize = numberOfSinkOutputs * _problemSize;
+	size_t runSensitivitiesSize = runSolutionSize * _numberOfSensitivityParameters;
+
+	std::vector < double > sinkSolution, sinkSensitivities;
+	if (outputSink)
+	{
+		sinkSolution.resize(runSolutionSize > 0 ? runSolutionSize : 1);
+		sinkSensitivities.resize(runSensitivitiesSize > 0 ? runSensitivitiesSize : 1);
+	}
+
+	try
+	{
+		if (outputSink)
+		{
+			outputSink->BeginRun(runIndex);
+			runStarted = true;
+		}
+
+		solver->SetInitialValues(_initialValues[runIndex]);
+		solver->SetSensitivityParametersInitialValues(_sensitivityParametersValues[runIndex]);
+
+		//repeated run: result is taken from the cache
+		SimModelSolverResultCacheKey cacheKey;
+		if (_resultCache)
+		{
+			std::vector < double > cachedSolution, cachedSensitivities;
+
+			cacheKey = SimModelSolverResultCacheKey::FromSolver(solver, _outputTimes, _resultCacheModelIdentifier);
+
+			if (_resultCache->Lookup(cacheKey, cachedSolution, cachedSensitivities) &&
+				(cachedSolution.size() == (size_t)numberOfOutputTimes * _problemSize) &&
+				(cachedSensitivities.size() == cachedSolution.size() * _numberOfSensitivityParameters))
+			{
+				WriteCachedResult(runIndex, cachedSolution, cachedSensitivities, solution, sensitivities, outputSink);
+
+				if (runStarted)
+				{
+					runStarted = false;
+					outputSink->EndRun(runIndex, true);
+				}
+
+				return;
+			}
+		}
+
+		//keeps work memory of the solver from the previous run
+		solver->ResetForReuse();
+
+		double initialTime = solver->GetInitialTime();
+
+		for (outputIndex = 0; outputIndex < numberOfOutputTimes; outputIndex++)
+		{
+			double * y, * ySBlock;
+			if (outputSink)
+			{
+				size_t sinkOffset = _resultCache ? (size_t)outputIndex * _problemSize : 0;
+
+				y = &sinkSolution[sinkOffset];
+				ySBlock = (_numberOfSensitivityParameters > 0) ? &sinkSensitivities[sinkOffset * _numberOfSensitivityParameters] : NULL;
+			}
+			else
+			{
+				y = solution + solutionOffset + (size_t)outputIndex * _problemSize;
+				ySBlock = (_numberOfSensitivityParameters > 0) ?
+					sensitivities + sensitivitiesOffset + (size_t)outputIndex * _problemSize * _numberOfSensitivityParameters : NULL;
+			}
+
+			//rows of yS point directly into the output buffer (no copy required)
+			for (i = 0; i < _problemSize; i++)
+				yS[i] = ySBlock ? ySBlock + (size_t)i * _numberOfSensitivityParameters : NULL;
+
+			double tout = _outputTimes[outputIndex];
+
+			if (tout <= initialTime)
+			{
+				for (i = 0; i < _problemSize; i++)
+					y[i] = _initialValues[runIndex][i];
+				for (i = 0; ySBlock && (i < _problemSize * _numberOfSensitivityParameters); i++)
+					ySBlock[i] = 0.0;
+
+				if (outputSink)
+					outputSink->WriteOutput(runIndex, outputIndex, tout, y, ySBlock);
+				continue;
+			}
+
+			double tret = initialTime;
+			int solverRetVal = solver->PerformSolverStep(tout, y, &yS[0], tret);
+
+			if ((solverRetVal != 0) || (tret < tout))
+			{
+				SimModelSolverErrorData::errNumber errNumber = solver->GetErrorNumberFromSolverReturnValue(solverRetVal);
+				if (errNumber == SimModelSolverErrorData::err_OK)
+					errNumber = SimModelSolverErrorData::err_FAILURE;
+
+				throw SimModelSolverErrorData(errNumber, ERROR_SOURCE, solver->GetSolverErrMsg(solverRetVal));
+			}
+
+			if (outputSink)
+				outputSink->WriteOutput(runIndex, outputIndex, tout, y, ySBlock);
+		}
+
+		if (_resultCache)
+		{
+			const double * runSolution = outputSink ? &sinkSolution[0] : solution + solutionOffset;
+			const double * runSensitivities = outputSink ? &sinkSensitivities[0] : 
+				(_numberOfSensitivityParameters > 0 ? sensitivities + sensitivitiesOffset : runSolution);
+
+			try
+			{
+				_resultCache->Store(cacheKey, std::vector < double > (runSolution, runSolution + runSolutionSize),
+					                std::vector < double > (runSensitivities, runSensitivities + runSensitivitiesSize));
+			}
+			catch (...)
+			{
+				//result of the run is valid: error of the cache (e.g. disk full) is ignored
+			}
+		}
+
+		if (runStarted)
+		{
+			runStarted = false;
+			outputSink->EndRun(runIndex, true);
+		}
+	}
+	catch (const SimModelSolverErrorData & ED)
+	{
+		_runErrors[runIndex] = ED;
+	}
+	catch (const std::exception & ex)
+	{
+		_runErrors[runIndex].SetError(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, ex.what());
+	}
+	catch (...)
+	{
+		_runErrors[runIndex].SetError(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Unknown error");
+	}
+
+	if (_runErrors[runIndex].GetNumber() == SimModelSolverErrorData::err_OK)
+		return;
+
+	//failed solver is not reused: next run starts from scratch
+	try
+	{
+		solver->Terminate();
+	}
+	catch (...)
+	{
+		//run result is already stored; error in clean up must not stop the worker
+	}
+
+	if (outputSink)
+	{
+		try
+		{
+			if (runStarted)
+				outputSink->EndRun(runIndex, false);
+		}
+		catch (...)
+		{
+			//run error is already stored
+		}
+
+		return;
+	}
+
+	//invalidate outputs of the failed run from the first failed output time on
+	double NaN = std::numeric_limits < double >::quiet_NaN();
+
+	size_t first = solutionOffset + (size_t)outputIndex * _problemSize;
+	size_t last = solutionOffset + (size_t)numberOfOutputTimes * _problemSize;
+	for (size_t idx = first; idx < last; idx++)
+		solution[idx] = NaN;
+
+	if (_numberOfSensitivityParameters > 0)
+	{
+		for (size_t idx = first * _numberOfSensitivityParameters; idx < last * _numberOfSensitivityParameters; idx++)
+			sensitivities[idx] = NaN;
+	}
+}
+
+void SimModelSolverEnsemble::WriteCachedResult (int runIndex, const std::vector < double > & cachedSolution, const std::vector < double > & cachedSensitivities,
+	                                            double * solution, double * sensitivities, ISolverOutputSink * outputSink)
+{
+	size_t n = _problemSize, ns = _numberOfSensitivityParameters;
+	int numberOfOutputTimes = (int)_outputTimes.size();
+
+	if (!outputSink)
+	{
+		size_t solutionOffset = (size_t)runIndex * numberOfOutputTimes * n;
+
+		for (size_t idx = 0; idx < cachedSolution.size(); idx++)
+			solution[solutionOffset + idx] = cachedSolution[idx];
+		for (size_t idx = 0; idx < cachedSensitivities.size(); idx++)
+			sensitivities[solutionOffset * ns + idx] = cachedSensitivities[idx];
+
+		return;
+	}
+
+	for (int outputIndex = 0; outputIndex < numberOfOutputTimes; outputIndex++)
+		outputSink->WriteOutput(runIndex, outputIndex, _outputTimes[outputIndex],
+		                        n > 0 ? &cachedSolution[outputIndex * n] : NULL,
+		                        ns > 0 ? &cachedSensitivities[outputIndex * n * ns] : NULL);
+}
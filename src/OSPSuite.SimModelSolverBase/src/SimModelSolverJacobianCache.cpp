@@ -0,0 +1,201 @@
+#include "SimModelSolverBase/SimModelSolverJacobianCache.h"
+#include <cmath>
+#include <cfloat>
+#include <algorithm>
+
+SimModelSolverJacobianCacheEntry::SimModelSolverJacobianCacheEntry ()
+{
+	Time = 0.0;
+	FactorizationScale = 0.0;
+	StepSize = 0.0;
+}
+
+SimModelSolverJacobianCache::SimModelSolverJacobianCache (size_t maxMemorySize)
+{
+	_maxTimeDistance = DBL_MAX;
+	_maxParameterDistance = 0.1;
+
+	_maxMemorySize = maxMemorySize;
+	_memorySize = 0;
+
+	_numberOfHits = 0;
+	_numberOfMisses = 0;
+}
+
+bool SimModelSolverJacobianCache::IsValid (const SimModelSolverJacobianCacheEntry & entry, const std::string & structure, double t,
+	                                       const std::vector < double > & parameters, double & timeDistance)
+{
+	if ((entry.Structure != structure) || (entry.Parameters.size() != parameters.size()))
+		return false;
+
+	timeDistance = fabs(t - entry.Time);
+	if (timeDistance > _maxTimeDistance)
+		return false;
+
+	for (size_t j = 0; j < parameters.size(); j++)
+	{
+		double scale = std::max(fabs(parameters[j]), fabs(entry.Parameters[j]));
+		if ((scale > 0.0) && (fabs(parameters[j] - entry.Parameters[j]) > _maxParameterDistance * scale))
+			return false;
+	}
+
+	return true;
+}
+
+void SimModelSolverJacobianCache::EvictEntries ()
+{
+	while ((_memorySize > _maxMemorySize) && !_entries.empty())
+	{
+		_memorySize -= _entries.back().MemorySize;
+		_entries.pop_back();
+	}
+}
+
+bool SimModelSolverJacobianCache::Lookup (const std::string & structure, double t, const std::vector < double > & parameters,
+	                                      SimModelSolverJacobianCacheEntry & entry)
+{
+	std::lock_guard < std::mutex > lock(_mutex);
+
+	std::list < CacheEntry >::iterator nearestEntry = _entries.end();
+	double nearestTimeDistance = DBL_MAX;
+
+	for (std::list < CacheEntry >::iterator it = _entries.begin(); it != _entries.end(); ++it)
+	{
+		double timeDistance;
+		if (IsValid(it->Data, structure, t, parameters, timeDistance) &&
+			((nearestEntry == _entries.end()) || (timeDistance < nearestTimeDistance)))
+		{
+			nearestEntry = it;
+			nearestTimeDistance = timeDistance;
+		}
+	}
+
+	if (nearestEntry == _entries.end())
+	{
+		_numberOfMisses++;
+		return false;
+	}
+
+	//most recently used
+	_entries.splice(_entries.begin(), _entries, nearestEntry);
+
+	entry = nearestEntry->Data;
+	_numberOfHits++;
+
+	return true;
+}
+
+void SimModelSolverJacobianCache::Store (const SimModelSolverJacobianCacheEntry & entry)
+{
+	std::lock_guard < std::mutex > lock(_mutex);
+
+	double timeTolerance = 100.0 * DBL_EPSILON * std::max(1.0, fabs(entry.Time));
+
+	//entry which would be found for the new one at its time: outdated
+	for (std::list < CacheEntry >::iterator it = _entries.begin(); it != _entries.end(); ++it)
+	{
+		double timeDistance;
+		if (IsValid(it->Data, entry.Structure, entry.Time, entry.Parameters, timeDistance) && (timeDistance <= timeTolerance))
+		{
+			_memorySize -= it->MemorySize;
+			_entries.erase(it);
+			break;
+		}
+	}
+
+	CacheEntry cacheEntry;
+	cacheEntry.Data = entry;
+	cacheEntry.MemorySize = entry.Structure.size() +
+		                    (entry.Parameters.size() + entry.Jacobian.size() + entry.Factorization.size()) * sizeof(double) +
+		                    entry.Pivots.size() * sizeof(int);
+
+	//entry would not fit (or cache disabled)
+	if (cacheEntry.MemorySize > _maxMemorySize)
+		return;
+
+	_entries.push_front(cacheEntry);
+	_memorySize += cacheEntry.MemorySize;
+
+	EvictEntries();
+}
+
+void SimModelSolverJacobianCache::Clear ()
+{
+	std::lock_guard < std::mutex > lock(_mutex);
+
+	_entries.clear();
+	_memorySize = 0;
+}
+
+double SimModelSolverJacobianCache::GetMaxTimeDistance ()
+{
+	return _maxTimeDistance;
+}
+
+void SimModelSolverJacobianCache::SetMaxTimeDistance (double maxTimeDistance)
+{
+	const char * ERROR_SOURCE = "SimModelSolverJacobianCache::SetMaxTimeDistance";
+
+	if (maxTimeDistance < 0.0)
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Max. time distance must be >= 0");
+
+	std::lock_guard < std::mutex > lock(_mutex);
+	_maxTimeDistance = maxTimeDistance;
+}
+
+double SimModelSolverJacobianCache::GetMaxParameterDistance ()
+{
+	return _maxParameterDistance;
+}
+
+void SimModelSolverJacobianCache::SetMaxParameterDistance (double maxParameterDistance)
+{
+	const char * ERROR_SOURCE = "SimModelSolverJacobianCache::SetMaxParameterDistance";
+
+	if (maxParameterDistance < 0.0)
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Max. parameter distance must be >= 0");
+
+	std::lock_guard < std::mutex > lock(_mutex);
+	_maxParameterDistance = maxParameterDistance;
+}
+
+size_t SimModelSolverJacobianCache::GetMaxMemorySize ()
+{
+	return _maxMemorySize;
+}
+
+void SimModelSolverJacobianCache::SetMaxMemorySize (size_t maxMemorySize)
+{
+	std::lock_guard < std::mutex > lock(_mutex);
+
+	_maxMemorySize = maxMemorySize;
+	EvictEntries();
+}
+
+size_t SimModelSolverJacobianCache::GetMemorySize ()
+{
+	std::lock_guard < std::mutex > lock(_mutex);
+
+	return _memorySize;
+}
+
+int SimModelSolverJacobianCache::GetNumberOfEntries ()
+{
+	std::lock_guard < std::mutex > lock(_mutex);
+
+	return (int)_entries.size();
+}
+
+long SimModelSolverJacobianCache::GetNumberOfHits ()
+{
+	std::lock_guard < std::mutex > lock(_mutex);
+
+	return _numberOfHits;
+}
+
+long SimModelSolverJacobianCache::GetNumberOfMisses ()
+{
+	std::lock_guard < std::mutex > lock(_mutex);
+
+	return _numberOfMisses;
+}
@@ -0,0 +1,363 @@
+#include "SimModelSolverBase/SimModelSolverMappedFileSink.h"
+#include <cstring>
+
+#ifdef _WINDOWS
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+//file format identification
+const char TRAJECTORY_FILE_MAGIC[8] = {'O', 'S', 'P', 'T', 'R', 'A', 'J', '1'};
+const int TRAJECTORY_FILE_VERSION = 1;
+
+const long long TRAJECTORY_FILE_HEADER_SIZE = 64;
+const long long TRAJECTORY_FILE_RUN_TABLE_ENTRY_SIZE = 16;
+
+//alignment of the start of a mapping (page size resp. allocation granularity)
+static long long MappingGranularity ()
+{
+#ifdef _WINDOWS
+	SYSTEM_INFO systemInfo;
+	GetSystemInfo(&systemInfo);
+	return systemInfo.dwAllocationGranularity;
+#else
+	return sysconf(_SC_PAGESIZE);
+#endif
+}
+
+static long long AlignTo8 (long long size)
+{
+	return (size + 7) / 8 * 8;
+}
+
+SimModelSolverMappedFileSink::SimModelSolverMappedFileSink ()
+{
+	_isOpen = false;
+
+	_numberOfRuns = 0;
+	_numberOfOutputTimes = 0;
+	_problemSize = 0;
+	_numberOfSensitivityParameters = 0;
+	_sensitivityStorage = SENSITIVITIES_DOUBLE;
+
+	_runTableOffset = 0;
+	_dataOffset = 0;
+	_runBlockSize = 0;
+	_numberOfRunBlocks = 0;
+	_fileSize = 0;
+
+	_headerRegion.MappingStart = NULL;
+	_headerRegion.MappingSize = 0;
+	_headerRegion.Data = NULL;
+
+#ifdef _WINDOWS
+	_fileHandle = INVALID_HANDLE_VALUE;
+#else
+	_fileDescriptor = -1;
+#endif
+}
+
+SimModelSolverMappedFileSink::~SimModelSolverMappedFileSink ()
+{
+	try
+	{
+		Close();
+	}
+	catch (...)
+	{
+	}
+}
+
+void SimModelSolverMappedFileSink::MapRegion (long long offset, long long size, MappedRegion & region)
+{
+	const char * ERROR_SOURCE = "SimModelSolverMappedFileSink::MapRegion";
+
+	long long granularity = MappingGranularity();
+	long long mappingOffset = offset / granularity * granularity;
+	long long mappingSize = offset + size - mappingOffset;
+
+	//the file is never resized while views are mapped (not possible on Windows)
+	if (offset + size > _fileSize)
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Region is beyond the end of file " + _fileName);
+
+#ifdef _WINDOWS
+	//the mapping object is only needed until the view is created
+	HANDLE mapping = CreateFileMapping((HANDLE)_fileHandle, NULL, PAGE_READWRITE, 0, 0, NULL);
+	if (mapping == NULL)
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Cannot map file " + _fileName);
+
+	void * start = MapViewOfFile(mapping, FILE_MAP_WRITE, (DWORD)(mappingOffset >> 32), (DWORD)(mappingOffset & 0xFFFFFFFF), (SIZE_T)mappingSize);
+	CloseHandle(mapping);
+
+	if (start == NULL)
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Cannot map file " + _fileName);
+#else
+	void * start = mmap(NULL, (size_t)mappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, _fileDescriptor, (off_t)mappingOffset);
+	if (start == MAP_FAILED)
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Cannot map file " + _fileName);
+#endif
+
+	region.MappingStart = start;
+	region.MappingSize = (size_t)mappingSize;
+	region.Data = (unsigned char *)start + (offset - mappingOffset);
+}
+
+void SimModelSolverMappedFileSink::UnmapRegion (MappedRegion & region)
+{
+	if (region.MappingStart == NULL)
+		return;
+
+#ifdef _WINDOWS
+	FlushViewOfFile(region.MappingStart, 0);
+	UnmapViewOfFile(region.MappingStart);
+#else
+	munmap(region.MappingStart, region.MappingSize);
+#endif
+
+	region.MappingStart = NULL;
+	region.MappingSize = 0;
+	region.Data = NULL;
+}
+
+void SimModelSolverMappedFileSink::Open (const std::string & fileName, int numberOfRuns, const std::vector < double > & outputTimes,
+	                                     int problemSize, int numberOfSensitivityParameters,
+	                                     SensitivityStorage sensitivityStorage)
+{
+	const char * ERROR_SOURCE = "SimModelSolverMappedFileSink::Open";
+
+	if (_isOpen)
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Output file is already open");
+	if (numberOfRuns < 0)
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Invalid number of runs");
+	if (problemSize < 0)
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Invalid problem size");
+	if (numberOfSensitivityParameters < 0)
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Invalid number of sensitivity parameters");
+	if ((sensitivityStorage != SENSITIVITIES_DOUBLE) && (sensitivityStorage != SENSITIVITIES_FLOAT))
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Invalid sensitivity storage");
+
+	_fileName = fileName;
+	_numberOfRuns = numberOfRuns;
+	_numberOfOutputTimes = (int)outputTimes.size();
+	_problemSize = problemSize;
+	_numberOfSensitivityParameters = numberOfSensitivityParameters;
+	_sensitivityStorage = sensitivityStorage;
+
+	long long K = _numberOfOutputTimes, n = _problemSize, NS = _numberOfSensitivityParameters;
+	long long sensitivityValueSize = (_sensitivityStorage == SENSITIVITIES_FLOAT) ? sizeof(float) : sizeof(double);
+
+	long long outputTimesOffset = TRAJECTORY_FILE_HEADER_SIZE;
+	_runTableOffset = outputTimesOffset + K * (long long)sizeof(double);
+	_dataOffset = AlignTo8(_runTableOffset + _numberOfRuns * TRAJECTORY_FILE_RUN_TABLE_ENTRY_SIZE);
+	_runBlockSize = AlignTo8(K * n * (long long)sizeof(double) + K * n * NS * sensitivityValueSize);
+
+	_numberOfRunBlocks = 0;
+	_fileSize = 0;
+
+#ifdef _WINDOWS
+	_fileHandle = CreateFileA(_fileName.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (_fileHandle == INVALID_HANDLE_VALUE)
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Cannot create file " + _fileName);
+#else
+	_fileDescriptor = open(_fileName.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (_fileDescriptor < 0)
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Cannot create file " + _fileName);
+#endif
+
+	_isOpen = true;
+
+	try
+	{
+		//preallocate the blocks of all runs (restarted runs reuse their block); Close cuts off unused space
+		long long fileSize = _dataOffset + _numberOfRuns * _runBlockSize;
+
+#ifdef _WINDOWS
+		LARGE_INTEGER newSize;
+		newSize.QuadPart = fileSize;
+		if (!SetFilePointerEx((HANDLE)_fileHandle, newSize, NULL, FILE_BEGIN) || !SetEndOfFile((HANDLE)_fileHandle))
+			throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Cannot resize file " + _fileName);
+#else
+		if (ftruncate(_fileDescriptor, (off_t)fileSize) != 0)
+			throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Cannot resize file " + _fileName);
+#endif
+		_fileSize = fileSize;
+
+		_runRegions.assign(_numberOfRuns, _headerRegion);
+		MapRegion(0, _dataOffset, _headerRegion);
+	}
+	catch (...)
+	{
+		Close();
+		throw;
+	}
+
+	unsigned char * header = _headerRegion.Data;
+	int version = TRAJECTORY_FILE_VERSION, storage = _sensitivityStorage;
+	long long header64[6] = {(long long)_numberOfRuns, K, n, NS, outputTimesOffset, _runTableOffset};
+
+	memcpy(header, TRAJECTORY_FILE_MAGIC, 8);
+	memcpy(header + 8, &version, sizeof(int));
+	memcpy(header + 12, &storage, sizeof(int));
+	memcpy(header + 16, header64, sizeof(header64));
+
+	if (K > 0)
+		memcpy(header + outputTimesOffset, &outputTimes[0], K * sizeof(double));
+
+	for (int runIndex = 0; runIndex < _numberOfRuns; runIndex++)
+		SetRunTableEntry(runIndex, -1, RUN_NOT_WRITTEN, 0);
+}
+
+void SimModelSolverMappedFileSink::Close ()
+{
+	if (!_isOpen)
+		return;
+
+	for (size_t runIndex = 0; runIndex < _runRegions.size(); runIndex++)
+		UnmapRegion(_runRegions[runIndex]);
+	_runRegions.clear();
+
+	UnmapRegion(_headerRegion);
+
+	//cut off space preallocated for runs not written
+	long long usedFileSize = _dataOffset + _numberOfRunBlocks * _runBlockSize;
+
+#ifdef _WINDOWS
+	LARGE_INTEGER newSize;
+	newSize.QuadPart = usedFileSize;
+	if (SetFilePointerEx((HANDLE)_fileHandle, newSize, NULL, FILE_BEGIN))
+		SetEndOfFile((HANDLE)_fileHandle);
+	CloseHandle((HANDLE)_fileHandle);
+	_fileHandle = INVALID_HANDLE_VALUE;
+#else
+	if (ftruncate(_fileDescriptor, (off_t)usedFileSize) == 0)
+		_fileSize = usedFileSize;
+	close(_fileDescriptor);
+	_fileDescriptor = -1;
+#endif
+
+	_isOpen = false;
+}
+
+bool SimModelSolverMappedFileSink::IsOpen ()
+{
+	return _isOpen;
+}
+
+const std::string & SimModelSolverMappedFileSink::GetFileName () const
+{
+	return _fileName;
+}
+
+long long SimModelSolverMappedFileSink::GetFileSize ()
+{
+	std::lock_guard < std::mutex > lock(_mutex);
+
+	return _dataOffset + _numberOfRunBlocks * _runBlockSize;
+}
+
+void SimModelSolverMappedFileSink::SetRunTableEntry (int runIndex, long long offset, int status, int numberOfOutputsWritten)
+{
+	unsigned char * entry = _headerRegion.Data + _runTableOffset + runIndex * TRAJECTORY_FILE_RUN_TABLE_ENTRY_SIZE;
+
+	memcpy(entry, &offset, sizeof(long long));
+	memcpy(entry + 8, &status, sizeof(int));
+	memcpy(entry + 12, &numberOfOutputsWritten, sizeof(int));
+}
+
+void SimModelSolverMappedFileSink::CheckRunIndex (int runIndex, const char * errorSource)
+{
+	if (!_isOpen)
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, errorSource, "Output file is not open");
+	if ((runIndex < 0) || (runIndex >= _numberOfRuns))
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, errorSource, "Invalid run index");
+}
+
+void SimModelSolverMappedFileSink::BeginRun (int runIndex)
+{
+	const char * ERROR_SOURCE = "SimModelSolverMappedFileSink::BeginRun";
+
+	CheckRunIndex(runIndex, ERROR_SOURCE);
+
+	//append block of the run (file resizing and run table are shared by all threads)
+	std::lock_guard < std::mutex > lock(_mutex);
+
+	if (_runRegions[runIndex].MappingStart != NULL)
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Run was already started");
+
+	long long offset = _dataOffset + _numberOfRunBlocks * _runBlockSize;
+
+	//restarted run: the block written before is reused
+	long long previousOffset;
+	memcpy(&previousOffset, _headerRegion.Data + _runTableOffset + runIndex * TRAJECTORY_FILE_RUN_TABLE_ENTRY_SIZE, sizeof(long long));
+	if (previousOffset >= 0)
+		offset = previousOffset;
+
+	if (_runBlockSize > 0)
+		MapRegion(offset, _runBlockSize, _runRegions[runIndex]);
+
+	if (previousOffset < 0)
+		_numberOfRunBlocks++;
+
+	SetRunTableEntry(runIndex, offset, RUN_RUNNING, 0);
+}
+
+void SimModelSolverMappedFileSink::WriteOutput (int runIndex, int outputIndex, double /*t*/, const double * y, const double * yS)
+{
+	const char * ERROR_SOURCE = "SimModelSolverMappedFileSink::WriteOutput";
+
+	CheckRunIndex(runIndex, ERROR_SOURCE);
+
+	if ((outputIndex < 0) || (outputIndex >= _numberOfOutputTimes))
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Invalid output index");
+
+	//run block is only accessed by the thread performing the run: no locking required
+	unsigned char * block = _runRegions[runIndex].Data;
+	size_t n = _problemSize, NS = _numberOfSensitivityParameters;
+
+	if (block == NULL)
+	{
+		if (_runBlockSize > 0)
+			throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Run was not started");
+		return;
+	}
+
+	if (n > 0)
+		memcpy(block + outputIndex * n * sizeof(double), y, n * sizeof(double));
+
+	if ((NS > 0) && (yS != NULL))
+	{
+		unsigned char * sensitivities = block + _numberOfOutputTimes * n * sizeof(double);
+		size_t count = n * NS;
+
+		if (_sensitivityStorage == SENSITIVITIES_FLOAT)
+		{
+			float * target = (float *)sensitivities + outputIndex * count;
+			for (size_t k = 0; k < count; k++)
+				target[k] = (float)yS[k];
+		}
+		else
+			memcpy(sensitivities + outputIndex * count * sizeof(double), yS, count * sizeof(double));
+	}
+
+	//outputs are written in increasing order: number written = last index + 1
+	int numberOfOutputsWritten = outputIndex + 1;
+	memcpy(_headerRegion.Data + _runTableOffset + runIndex * TRAJECTORY_FILE_RUN_TABLE_ENTRY_SIZE + 12, &numberOfOutputsWritten, sizeof(int));
+}
+
+void SimModelSolverMappedFileSink::EndRun (int runIndex, bool success)
+{
+	const char * ERROR_SOURCE = "SimModelSolverMappedFileSink::EndRun";
+
+	CheckRunIndex(runIndex, ERROR_SOURCE);
+
+	std::lock_guard < std::mutex > lock(_mutex);
+
+	UnmapRegion(_runRegions[runIndex]);
+
+	int status = success ? RUN_FINISHED : RUN_FAILED;
+	memcpy(_headerRegion.Data + _runTableOffset + runIndex * TRAJECTORY_FILE_RUN_TABLE_ENTRY_SIZE + 8, &status, sizeof(int));
+}
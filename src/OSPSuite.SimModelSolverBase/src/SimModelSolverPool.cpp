@@ -0,0 +1,219 @@
+#include "SimModelSolverBase/SimModelSolverPool.h"
+
+//---- SimModelSolverPoolKey ----------------------------------------------
+
+SimModelSolverPoolKey::SimModelSolverPoolKey ()
+{
+	ProblemSize = 0;
+	NumberOfSensitivityParameters = 0;
+	LowerHalfBandWidth = -1;
+	UpperHalfBandWidth = -1;
+}
+
+SimModelSolverPoolKey::SimModelSolverPoolKey (int problemSize, int numberOfSensitivityParameters,
+	                                          int lowerHalfBandWidth, int upperHalfBandWidth)
+{
+	ProblemSize = problemSize;
+	NumberOfSensitivityParameters = numberOfSensitivityParameters;
+	LowerHalfBandWidth = lowerHalfBandWidth;
+	UpperHalfBandWidth = upperHalfBandWidth;
+}
+
+SimModelSolverPoolKey SimModelSolverPoolKey::FromSolver (SimModelSolverBase * solver)
+{
+	SimModelSolverPoolKey key(solver->GetProblemSize(), solver->GetNumberOfSensitivityParameters());
+
+	ISolverCaller * solverCaller = solver->GetSolverCaller();
+	if (solverCaller && solverCaller->UseBandLinearSolver())
+	{
+		key.LowerHalfBandWidth = solverCaller->GetLowerHalfBandWidth();
+		key.UpperHalfBandWidth = solverCaller->GetUpperHalfBandWidth();
+	}
+
+	return key;
+}
+
+bool SimModelSolverPoolKey::operator < (const SimModelSolverPoolKey & other) const
+{
+	if (ProblemSize != other.ProblemSize)
+		return ProblemSize < other.ProblemSize;
+	if (NumberOfSensitivityParameters != other.NumberOfSensitivityParameters)
+		return NumberOfSensitivityParameters < other.NumberOfSensitivityParameters;
+	if (LowerHalfBandWidth != other.LowerHalfBandWidth)
+		return LowerHalfBandWidth < other.LowerHalfBandWidth;
+
+	return UpperHalfBandWidth < other.UpperHalfBandWidth;
+}
+
+bool SimModelSolverPoolKey::operator == (const SimModelSolverPoolKey & other) const
+{
+	return (ProblemSize == other.ProblemSize) &&
+		   (NumberOfSensitivityParameters == other.NumberOfSensitivityParameters) &&
+		   (LowerHalfBandWidth == other.LowerHalfBandWidth) &&
+		   (UpperHalfBandWidth == other.UpperHalfBandWidth);
+}
+
+//---- SimModelSolverPool -------------------------------------------------
+
+SimModelSolverPool::SimModelSolverPool (int maxIdleSolversPerKey)
+{
+	_maxIdleSolversPerKey = maxIdleSolversPerKey;
+	_numberOfCreatedSolvers = 0;
+	_numberOfReusedSolvers = 0;
+}
+
+SimModelSolverPool::~SimModelSolverPool ()
+{
+	try
+	{
+		Clear();
+	}
+	catch (...)
+	{
+		//destructor must not throw
+	}
+}
+
+void SimModelSolverPool::DestroySolver (const PooledSolver & pooledSolver)
+{
+	try
+	{
+		if (pooledSolver.Solver->IsInitialized())
+			pooledSolver.Solver->Terminate();
+	}
+	catch (...)
+	{
+		//solver is released anyway
+	}
+
+	pooledSolver.Factory->ReleaseSolver(pooledSolver.Solver);
+}
+
+SimModelSolverBase * SimModelSolverPool::Acquire (const SimModelSolverPoolKey & key, ISimModelSolverFactory * factory)
+{
+	const char * ERROR_SOURCE = "SimModelSolverPool::Acquire";
+
+	if (!factory)
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Invalid solver factory passed");
+
+	{
+		std::lock_guard < std::mutex > lock(_mutex);
+
+		std::map < IdleSolversKey, std::vector < PooledSolver > >::iterator it = _idleSolvers.find(IdleSolversKey(factory, key));
+		if ((it != _idleSolvers.end()) && !it->second.empty())
+		{
+			PooledSolver pooledSolver = it->second.back();
+			it->second.pop_back();
+
+			_acquiredSolvers[pooledSolver.Solver] = pooledSolver.Factory;
+			_numberOfReusedSolvers++;
+
+			return pooledSolver.Solver;
+		}
+	}
+
+	//create new solver outside of the lock (may be expensive)
+	SimModelSolverBase * solver = factory->CreateSolver();
+	if (!solver)
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Solver factory failed to create a solver");
+
+	if (!(SimModelSolverPoolKey::FromSolver(solver) == key))
+	{
+		factory->ReleaseSolver(solver);
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Solver created by the factory does not match the pool key");
+	}
+
+	std::lock_guard < std::mutex > lock(_mutex);
+
+	_acquiredSolvers[solver] = factory;
+	_numberOfCreatedSolvers++;
+
+	return solver;
+}
+
+void SimModelSolverPool::Release (SimModelSolverBase * solver)
+{
+	const char * ERROR_SOURCE = "SimModelSolverPool::Release";
+
+	if (!solver)
+		return;
+
+	PooledSolver pooledSolver;
+	pooledSolver.Solver = solver;
+
+	{
+		std::lock_guard < std::mutex > lock(_mutex);
+
+		std::map < SimModelSolverBase *, ISimModelSolverFactory * >::iterator it = _acquiredSolvers.find(solver);
+		if (it == _acquiredSolvers.end())
+			throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Solver was not acquired from this pool");
+
+		pooledSolver.Factory = it->second;
+		_acquiredSolvers.erase(it);
+
+		std::vector < PooledSolver > & idleSolvers = _idleSolvers[IdleSolversKey(pooledSolver.Factory, SimModelSolverPoolKey::FromSolver(solver))];
+
+		if ((_maxIdleSolversPerKey <= 0) || ((int)idleSolvers.size() < _maxIdleSolversPerKey))
+		{
+			idleSolvers.push_back(pooledSolver);
+			return;
+		}
+	}
+
+	//pool is full
+	DestroySolver(pooledSolver);
+}
+
+void SimModelSolverPool::Clear ()
+{
+	std::vector < PooledSolver > solversToRelease;
+
+	{
+		std::lock_guard < std::mutex > lock(_mutex);
+
+		std::map < IdleSolversKey, std::vector < PooledSolver > >::iterator it;
+		for (it = _idleSolvers.begin(); it != _idleSolvers.end(); it++)
+			solversToRelease.insert(solversToRelease.end(), it->second.begin(), it->second.end());
+
+		_idleSolvers.clear();
+	}
+
+	for (size_t i = 0; i < solversToRelease.size(); i++)
+		DestroySolver(solversToRelease[i]);
+}
+
+int SimModelSolverPool::GetMaxIdleSolversPerKey ()
+{
+	return _maxIdleSolversPerKey;
+}
+
+void SimModelSolverPool::SetMaxIdleSolversPerKey (int maxIdleSolversPerKey)
+{
+	std::lock_guard < std::mutex > lock(_mutex);
+	_maxIdleSolversPerKey = maxIdleSolversPerKey;
+}
+
+int SimModelSolverPool::GetNumberOfIdleSolvers ()
+{
+	std::lock_guard < std::mutex > lock(_mutex);
+
+	int numberOfIdleSolvers = 0;
+
+	std::map < IdleSolversKey, std::vector < PooledSolver > >::const_iterator it;
+	for (it = _idleSolvers.begin(); it != _idleSolvers.end(); it++)
+		numberOfIdleSolvers += (int)it->second.size();
+
+	return numberOfIdleSolvers;
+}
+
+long SimModelSolverPool::GetNumberOfCreatedSolvers ()
+{
+	std::lock_guard < std::mutex > lock(_mutex);
+	return _numberOfCreatedSolvers;
+}
+
+long SimModelSolverPool::GetNumberOfReusedSolvers ()
+{
+	std::lock_guard < std::mutex > lock(_mutex);
+	return _numberOfReusedSolvers;
+}
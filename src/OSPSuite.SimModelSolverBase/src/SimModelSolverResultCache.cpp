@@ -0,0 +1,435 @@
+#include "SimModelSolverBase/SimModelSolverResultCache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <thread>
+#include <typeinfo>
+
+//format version of the key and of the files of the disk tier
+const int RESULT_CACHE_VERSION = 4;
+
+//extension of the files of the disk tier
+const char * const RESULT_CACHE_FILE_EXTENSION = ".simresult";
+
+SimModelSolverResultCacheKey::SimModelSolverResultCacheKey ()
+{
+	_hash = 0;
+}
+
+SimModelSolverResultCacheKey SimModelSolverResultCacheKey::FromSolver (SimModelSolverBase * solver,
+	                                                                   const std::vector < double > & outputTimes,
+	                                                                   const std::string & modelIdentifier)
+{
+	const char * ERROR_SOURCE = "SimModelSolverResultCacheKey::FromSolver";
+
+	if (!solver)
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Invalid pointer to the solver passed!");
+
+	SimModelSolverState data;
+	std::string solverType = typeid(*solver).name();
+
+	data.WriteInt(RESULT_CACHE_VERSION);
+
+	data.WriteInt((int)modelIdentifier.size());
+	data.WriteBytes(modelIdentifier.data(), modelIdentifier.size());
+	data.WriteInt((int)solverType.size());
+	data.WriteBytes(solverType.data(), solverType.size());
+
+	data.WriteInt(solver->GetProblemSize());
+	data.WriteInt(solver->GetNumberOfSensitivityParameters());
+
+	data.WriteDouble(solver->GetRelTol());
+	data.WriteVector(solver->GetAbsTol());
+	data.WriteDouble(solver->GetH0());
+	data.WriteDouble(solver->GetHMin());
+	data.WriteDouble(solver->GetHMax());
+	data.WriteLong(solver->GetMxStep());
+
+	//base solver options which change the result
+	data.WriteInt((int)solver->GetLinearSolver());
+	data.WriteInt(solver->GetKrylovMaxDimension());
+	data.WriteBool(solver->GetJacobianSparsityProbing());
+	data.WriteBool(solver->GetSteadyStateDetection());
+	data.WriteBool(solver->GetSteadyStateSensitivities());
+	data.WriteDouble(solver->GetSteadyStateTolerance());
+	data.WriteDouble(solver->GetMaxDelay());
+
+	//warm start (initial and max. step sizes are taken from the profile)
+	SimModelSolverStepSizeProfile * stepSizeProfile = solver->GetStepSizeProfile();
+	data.WriteBool(stepSizeProfile != NULL);
+	if (stepSizeProfile != NULL)
+		stepSizeProfile->SaveState(data);
+	data.WriteDouble(solver->GetStepSizeProfileMaxStepFactor());
+
+	//sensitivity subsets
+	std::vector < double > sensitivityParametersActive;
+	for (int iS = 0; iS < solver->GetNumberOfSensitivityParameters(); iS++)
+		sensitivityParametersActive.push_back(solver->GetSensitivityParameterActive(iS) ? 1.0 : 0.0);
+	data.WriteVector(sensitivityParametersActive);
+	data.WriteVector(solver->GetSensitivityTimeWindowStartTimes());
+	data.WriteVector(solver->GetSensitivityTimeWindowEndTimes());
+
+	data.WriteDouble(solver->GetInitialTime());
+	data.WriteVector(solver->GetInitialValues());
+	data.WriteVector(solver->GetSensitivityParametersInitialValues());
+	data.WriteVector(outputTimes);
+
+	SimModelSolverResultCacheKey key;
+	key.SetData(data.GetData(), data.GetSize());
+
+	return key;
+}
+
+void SimModelSolverResultCacheKey::SetData (const unsigned char * data, size_t size)
+{
+	_data.SetData(data, size);
+
+	//FNV-1a
+	_hash = 14695981039346656037ULL;
+	for (size_t i = 0; i < size; i++)
+	{
+		_hash ^= data[i];
+		_hash *= 1099511628211ULL;
+	}
+}
+
+size_t SimModelSolverResultCacheKey::GetSize () const
+{
+	return _data.GetSize();
+}
+
+const unsigned char * SimModelSolverResultCacheKey::GetData () const
+{
+	return _data.GetData();
+}
+
+unsigned long long SimModelSolverResultCacheKey::GetHash () const
+{
+	return _hash;
+}
+
+bool SimModelSolverResultCacheKey::operator == (const SimModelSolverResultCacheKey & other) const
+{
+	if ((_hash != other._hash) || (GetSize() != other.GetSize()))
+		return false;
+
+	return (GetSize() == 0) || (memcmp(GetData(), other.GetData(), GetSize()) == 0);
+}
+
+SimModelSolverResultCache::SimModelSolverResultCache (size_t maxMemorySize)
+{
+	_maxMemorySize = maxMemorySize;
+	_memorySize = 0;
+
+	_numberOfHits = 0;
+	_numberOfDiskHits = 0;
+	_numberOfMisses = 0;
+}
+
+std::list < SimModelSolverResultCache::CacheEntry >::iterator SimModelSolverResultCache::FindEntry (const SimModelSolverResultCacheKey & key)
+{
+	auto range = _entriesByHash.equal_range(key.GetHash());
+
+	for (auto it = range.first; it != range.second; ++it)
+	{
+		if (it->second->Key == key)
+			return it->second;
+	}
+
+	return _entries.end();
+}
+
+void SimModelSolverResultCache::InsertEntry (const SimModelSolverResultCacheKey & key, const std::vector < double > & solution,
+	                                         const std::vector < double > & sensitivities)
+{
+	size_t memorySize = key.GetSize() + (solution.size() + sensitivities.size()) * sizeof(double);
+
+	//result would not fit (or memory tier disabled)
+	if (memorySize > _maxMemorySize)
+		return;
+
+	CacheEntry entry;
+	entry.Key = key;
+	entry.Solution = solution;
+	entry.Sensitivities = sensitivities;
+	entry.MemorySize = memorySize;
+
+	_entries.push_front(entry);
+	_entriesByHash.insert(std::make_pair(key.GetHash(), _entries.begin()));
+	_memorySize += memorySize;
+
+	EvictEntries();
+}
+
+void SimModelSolverResultCache::EvictEntries ()
+{
+	//drop least recently used entries
+	while ((_memorySize > _maxMemorySize) && !_entries.empty())
+	{
+		std::list < CacheEntry >::iterator last = --_entries.end();
+
+		auto range = _entriesByHash.equal_range(last->Key.GetHash());
+		for (auto it = range.first; it != range.second; ++it)
+		{
+			if (it->second == last)
+			{
+				_entriesByHash.erase(it);
+				break;
+			}
+		}
+
+		_memorySize -= last->MemorySize;
+		_entries.erase(last);
+	}
+}
+
+std::string SimModelSolverResultCache::DiskFileName (const std::string & diskDirectory, const SimModelSolverResultCacheKey & key)
+{
+	char hash[17];
+	snprintf(hash, sizeof(hash), "%016llx", key.GetHash());
+
+	std::string fileName = diskDirectory;
+	if (!fileName.empty() && (fileName[fileName.size() - 1] != '/') && (fileName[fileName.size() - 1] != '\\'))
+		fileName += "/";
+
+	return fileName + hash + RESULT_CACHE_FILE_EXTENSION;
+}
+
+bool SimModelSolverResultCache::ReadFromDisk (const std::string & diskDirectory, const SimModelSolverResultCacheKey & key,
+	                                          std::vector < double > & solution, std::vector < double > & sensitivities)
+{
+	std::ifstream file(DiskFileName(diskDirectory, key).c_str(), std::ios::binary | std::ios::ate);
+	if (!file)
+		return false;
+
+	std::streamoff fileSize = file.tellg();
+	if (fileSize < 0)
+		return false;
+
+	std::vector < unsigned char > content((size_t)fileSize);
+	file.seekg(0);
+
+	if ((fileSize > 0) && !file.read((char *)&content[0], fileSize))
+		return false;
+
+	file.close();
+
+	//invalid or incomplete file or result of another key with the same hash: not found
+	try
+	{
+		SimModelSolverState data;
+		data.SetData(content.empty() ? NULL : &content[0], content.size());
+
+		size_t position = 0;
+		if (data.ReadInt(position) != RESULT_CACHE_VERSION)
+			return false;
+
+		int keySize = data.ReadInt(position);
+		if ((keySize < 0) || ((size_t)keySize != key.GetSize()) || (position + keySize > data.GetSize()))
+			return false;
+
+		if ((keySize > 0) && (memcmp(data.GetData() + position, key.GetData(), keySize) != 0))
+			return false;
+		position += keySize;
+
+		data.ReadVector(position, solution);
+		data.ReadVector(position, sensitivities);
+	}
+	catch (...)
+	{
+		return false;
+	}
+
+	return true;
+}
+
+void SimModelSolverResultCache::WriteToDisk (const std::string & diskDirectory, const SimModelSolverResultCacheKey & key,
+	                                         const std::vector < double > & solution, const std::vector < double > & sensitivities)
+{
+	const char * ERROR_SOURCE = "SimModelSolverResultCache::WriteToDisk";
+
+	SimModelSolverState data;
+
+	data.WriteInt(RESULT_CACHE_VERSION);
+	data.WriteInt((int)key.GetSize());
+	data.WriteBytes(key.GetData(), key.GetSize());
+	data.WriteVector(solution);
+	data.WriteVector(sensitivities);
+
+	//write to temporary file first, so readers never see an incomplete file
+	//(one temporary file per thread: the same key may be stored by several threads)
+	char threadId[17];
+	snprintf(threadId, sizeof(threadId), "%016llx", (unsigned long long)std::hash < std::thread::id > ()(std::this_thread::get_id()));
+
+	std::string fileName = DiskFileName(diskDirectory, key);
+	std::string tempFileName = fileName + "." + threadId + ".tmp";
+
+	std::ofstream file(tempFileName.c_str(), std::ios::binary | std::ios::trunc);
+	if (!file)
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Cannot create file " + tempFileName);
+
+	file.write((const char *)data.GetData(), data.GetSize());
+	file.close();
+	bool written = !file.fail();
+
+	remove(fileName.c_str());
+
+	if (!written || (rename(tempFileName.c_str(), fileName.c_str()) != 0))
+	{
+		remove(tempFileName.c_str());
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Cannot write file " + fileName);
+	}
+}
+
+bool SimModelSolverResultCache::Lookup (const SimModelSolverResultCacheKey & key, std::vector < double > & solution,
+	                                    std::vector < double > & sensitivities)
+{
+	std::string diskDirectory;
+
+	{
+		std::lock_guard < std::mutex > lock(_mutex);
+
+		std::list < CacheEntry >::iterator entry = FindEntry(key);
+
+		if (entry != _entries.end())
+		{
+			//most recently used
+			_entries.splice(_entries.begin(), _entries, entry);
+
+			solution = entry->Solution;
+			sensitivities = entry->Sensitivities;
+			_numberOfHits++;
+
+			return true;
+		}
+
+		diskDirectory = _diskDirectory;
+	}
+
+	//disk I/O without holding the lock
+	bool found = !diskDirectory.empty() && ReadFromDisk(diskDirectory, key, solution, sensitivities);
+
+	std::lock_guard < std::mutex > lock(_mutex);
+
+	if (found)
+	{
+		//another thread may have inserted the result meanwhile
+		if (FindEntry(key) == _entries.end())
+			InsertEntry(key, solution, sensitivities);
+
+		_numberOfHits++;
+		_numberOfDiskHits++;
+
+		return true;
+	}
+
+	_numberOfMisses++;
+
+	return false;
+}
+
+void SimModelSolverResultCache::Store (const SimModelSolverResultCacheKey & key, const std::vector < double > & solution,
+	                                   const std::vector < double > & sensitivities)
+{
+	std::string diskDirectory;
+
+	{
+		std::lock_guard < std::mutex > lock(_mutex);
+
+		std::list < CacheEntry >::iterator entry = FindEntry(key);
+
+		if (entry != _entries.end())
+		{
+			//replace existing result
+			_memorySize -= entry->MemorySize;
+			entry->Solution = solution;
+			entry->Sensitivities = sensitivities;
+			entry->MemorySize = key.GetSize() + (solution.size() + sensitivities.size()) * sizeof(double);
+			_memorySize += entry->MemorySize;
+
+			_entries.splice(_entries.begin(), _entries, entry);
+			EvictEntries();
+		}
+		else
+			InsertEntry(key, solution, sensitivities);
+
+		diskDirectory = _diskDirectory;
+	}
+
+	//disk I/O without holding the lock
+	if (!diskDirectory.empty())
+		WriteToDisk(diskDirectory, key, solution, sensitivities);
+}
+
+void SimModelSolverResultCache::Clear ()
+{
+	std::lock_guard < std::mutex > lock(_mutex);
+
+	_entries.clear();
+	_entriesByHash.clear();
+	_memorySize = 0;
+}
+
+size_t SimModelSolverResultCache::GetMaxMemorySize ()
+{
+	return _maxMemorySize;
+}
+
+void SimModelSolverResultCache::SetMaxMemorySize (size_t maxMemorySize)
+{
+	std::lock_guard < std::mutex > lock(_mutex);
+
+	_maxMemorySize = maxMemorySize;
+	EvictEntries();
+}
+
+size_t SimModelSolverResultCache::GetMemorySize ()
+{
+	std::lock_guard < std::mutex > lock(_mutex);
+
+	return _memorySize;
+}
+
+int SimModelSolverResultCache::GetNumberOfEntries ()
+{
+	std::lock_guard < std::mutex > lock(_mutex);
+
+	return (int)_entries.size();
+}
+
+std::string SimModelSolverResultCache::GetDiskDirectory ()
+{
+	std::lock_guard < std::mutex > lock(_mutex);
+
+	return _diskDirectory;
+}
+
+void SimModelSolverResultCache::SetDiskDirectory (const std::string & diskDirectory)
+{
+	std::lock_guard < std::mutex > lock(_mutex);
+
+	_diskDirectory = diskDirectory;
+}
+
+long SimModelSolverResultCache::GetNumberOfHits ()
+{
+	std::lock_guard < std::mutex > lock(_mutex);
+
+	return _numberOfHits;
+}
+
+long SimModelSolverResultCache::GetNumberOfDiskHits ()
+{
+	std::lock_guard < std::mutex > lock(_mutex);
+
+	return _numberOfDiskHits;
+}
+
+long SimModelSolverResultCache::GetNumberOfMisses ()
+{
+	std::lock_guard < std::mutex > lock(_mutex);
+
+	return _numberOfMisses;
+}
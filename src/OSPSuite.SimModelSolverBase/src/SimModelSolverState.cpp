@@ -0,0 +1,149 @@
+#include "SimModelSolverBase/SimModelSolverState.h"
+#include <cstring>
+
+SimModelSolverState::SimModelSolverState ()
+{
+}
+
+bool SimModelSolverState::IsEmpty () const
+{
+	return _data.empty();
+}
+
+void SimModelSolverState::Clear ()
+{
+	_data.clear();
+}
+
+size_t SimModelSolverState::GetSize () const
+{
+	return _data.size();
+}
+
+const unsigned char * SimModelSolverState::GetData () const
+{
+	return _data.empty() ? NULL : &_data[0];
+}
+
+void SimModelSolverState::SetData (const unsigned char * data, size_t size)
+{
+	_data.assign(data, data + size);
+}
+
+void SimModelSolverState::WriteBytes (const void * data, size_t size)
+{
+	if (size == 0)
+		return;
+
+	const unsigned char * bytes = static_cast < const unsigned char * > (data);
+	_data.insert(_data.end(), bytes, bytes + size);
+}
+
+void SimModelSolverState::WriteBool (bool value)
+{
+	unsigned char byte = value ? 1 : 0;
+	WriteBytes(&byte, 1);
+}
+
+void SimModelSolverState::WriteInt (int value)
+{
+	WriteBytes(&value, sizeof(value));
+}
+
+void SimModelSolverState::WriteLong (long value)
+{
+	WriteBytes(&value, sizeof(value));
+}
+
+void SimModelSolverState::WriteDouble (double value)
+{
+	WriteBytes(&value, sizeof(value));
+}
+
+void SimModelSolverState::WriteDoubles (const double * values, size_t n)
+{
+	WriteBytes(values, n * sizeof(double));
+}
+
+void SimModelSolverState::WriteVector (const std::vector < double > & values)
+{
+	WriteLong((long)values.size());
+	WriteDoubles(values.empty() ? NULL : &values[0], values.size());
+}
+
+void SimModelSolverState::WriteVector (const std::vector < int > & values)
+{
+	WriteLong((long)values.size());
+	WriteBytes(values.empty() ? NULL : &values[0], values.size() * sizeof(int));
+}
+
+void SimModelSolverState::ReadBytes (size_t & position, void * data, size_t size) const
+{
+	const char * ERROR_SOURCE = "SimModelSolverState::ReadBytes";
+
+	if (size == 0)
+		return;
+
+	if ((position > _data.size()) || (size > _data.size() - position))
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Unexpected end of solver state");
+
+	memcpy(data, &_data[position], size);
+	position += size;
+}
+
+bool SimModelSolverState::ReadBool (size_t & position) const
+{
+	unsigned char byte;
+	ReadBytes(position, &byte, 1);
+	return byte != 0;
+}
+
+int SimModelSolverState::ReadInt (size_t & position) const
+{
+	int value;
+	ReadBytes(position, &value, sizeof(value));
+	return value;
+}
+
+long SimModelSolverState::ReadLong (size_t & position) const
+{
+	long value;
+	ReadBytes(position, &value, sizeof(value));
+	return value;
+}
+
+double SimModelSolverState::ReadDouble (size_t & position) const
+{
+	double value;
+	ReadBytes(position, &value, sizeof(value));
+	return value;
+}
+
+void SimModelSolverState::ReadDoubles (size_t & position, double * values, size_t n) const
+{
+	ReadBytes(position, values, n * sizeof(double));
+}
+
+void SimModelSolverState::ReadVector (size_t & position, std::vector < double > & values) const
+{
+	const char * ERROR_SOURCE = "SimModelSolverState::ReadVector";
+
+	long size = ReadLong(position);
+	if ((size < 0) || ((size_t)size > (_data.size() - position) / sizeof(double)))
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Invalid vector size in solver state");
+
+	values.resize(size);
+	ReadDoubles(position, values.empty() ? NULL : &values[0], size);
+}
+
+void SimModelSolverState::ReadVector (size_t & position, std::vector < int > & values) const
+{
+	const char * ERROR_SOURCE = "SimModelSolverState::ReadVector";
+
+	long size = ReadLong(position);
+	if ((size < 0) || ((size_t)size > (_data.size() - position) / sizeof(int)))
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "Invalid vector size in solver state");
+
+	values.resize(size);
+	ReadBytes(position, values.empty() ? NULL : &values[0], size * sizeof(int));
+}
@@ -0,0 +1,163 @@
+#include "SimModelSolverBase/SimModelSolverStepSizeProfile.h"
+#include <cmath>
+#include <cfloat>
+#include <algorithm>
+
+//tolerance for the comparison of restart times of different runs
+static double TimeTolerance (double t)
+{
+	return 100.0 * DBL_EPSILON * std::max(1.0, fabs(t));
+}
+
+//steps growing by at least this factor are still in the start-up phase after a restart
+//(step size limited by the max. increase of the step size control, not by the error)
+static const double START_UP_GROWTH_FACTOR = 2.0;
+
+SimModelSolverStepSizeProfile::SimModelSolverStepSizeProfile ()
+{
+}
+
+void SimModelSolverStepSizeProfile::StartSegment (double t0)
+{
+	Segment segment;
+	segment.StartTime = t0;
+	segment.FirstStep = _stepTimes.size();
+
+	//previous restart without any step
+	if (!_segments.empty() && (_segments.back().FirstStep == segment.FirstStep))
+		_segments.back() = segment;
+	else
+		_segments.push_back(segment);
+}
+
+void SimModelSolverStepSizeProfile::AddStep (double t, double h, int order)
+{
+	const char * ERROR_SOURCE = "SimModelSolverStepSizeProfile::AddStep";
+
+	if (_segments.empty())
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE, "No segment started");
+
+	_stepTimes.push_back(t);
+	_stepSizes.push_back(h);
+	_stepOrders.push_back(order);
+}
+
+void SimModelSolverStepSizeProfile::Clear ()
+{
+	_segments.clear();
+	_stepTimes.clear();
+	_stepSizes.clear();
+	_stepOrders.clear();
+}
+
+int SimModelSolverStepSizeProfile::GetNumberOfSegments () const
+{
+	return (int)_segments.size();
+}
+
+size_t SimModelSolverStepSizeProfile::GetNumberOfSteps () const
+{
+	return _stepTimes.size();
+}
+
+void SimModelSolverStepSizeProfile::SaveState (SimModelSolverState & state) const
+{
+	state.WriteInt((int)_segments.size());
+
+	for (size_t segmentIndex = 0; segmentIndex < _segments.size(); segmentIndex++)
+	{
+		state.WriteDouble(_segments[segmentIndex].StartTime);
+		state.WriteLong((long)_segments[segmentIndex].FirstStep);
+	}
+
+	state.WriteVector(_stepTimes);
+	state.WriteVector(_stepSizes);
+	state.WriteVector(_stepOrders);
+}
+
+size_t SimModelSolverStepSizeProfile::SegmentEnd (int segmentIndex) const
+{
+	return (segmentIndex + 1 < (int)_segments.size()) ? _segments[segmentIndex + 1].FirstStep : _stepTimes.size();
+}
+
+int SimModelSolverStepSizeProfile::FindSegment (double t) const
+{
+	double tolerance = TimeTolerance(t);
+
+	//latest restart before t whose steps reach t
+	for (int segmentIndex = (int)_segments.size() - 1; segmentIndex >= 0; segmentIndex--)
+	{
+		const Segment & segment = _segments[segmentIndex];
+		size_t segmentEnd = SegmentEnd(segmentIndex);
+
+		if ((segment.StartTime <= t + tolerance) && (segmentEnd > segment.FirstStep) && (_stepTimes[segmentEnd - 1] >= t - tolerance))
+			return segmentIndex;
+	}
+
+	return -1;
+}
+
+size_t SimModelSolverStepSizeProfile::FindStep (int segmentIndex, double t) const
+{
+	std::vector < double >::const_iterator first = _stepTimes.begin() + _segments[segmentIndex].FirstStep;
+	std::vector < double >::const_iterator last = _stepTimes.begin() + SegmentEnd(segmentIndex);
+
+	return std::lower_bound(first, last, t - TimeTolerance(t)) - _stepTimes.begin();
+}
+
+size_t SimModelSolverStepSizeProfile::FindStartUpEnd (int segmentIndex) const
+{
+	size_t last = SegmentEnd(segmentIndex);
+	size_t step = _segments[segmentIndex].FirstStep;
+
+	while ((step + 1 < last) && (_stepSizes[step + 1] >= START_UP_GROWTH_FACTOR * _stepSizes[step]))
+		step++;
+
+	//first step limited by the error
+	return step + 1 < last ? step + 1 : step;
+}
+
+bool SimModelSolverStepSizeProfile::GetInitialStep (double t0, double & h, int & order) const
+{
+	int segmentIndex = FindSegment(t0);
+	if (segmentIndex < 0)
+		return false;
+
+	const Segment & segment = _segments[segmentIndex];
+
+	size_t step = (fabs(segment.StartTime - t0) <= TimeTolerance(t0)) ? segment.FirstStep : FindStep(segmentIndex, t0);
+	if (step >= SegmentEnd(segmentIndex))
+		return false;
+
+	step = std::max(step, FindStartUpEnd(segmentIndex));
+
+	h = _stepSizes[step];
+	order = _stepOrders[step];
+
+	return true;
+}
+
+double SimModelSolverStepSizeProfile::GetStepSize (double t) const
+{
+	int segmentIndex = FindSegment(t);
+	if (segmentIndex < 0)
+		return 0.0;
+
+	size_t first = FindStartUpEnd(segmentIndex);
+	size_t last = SegmentEnd(segmentIndex);
+
+	size_t step = FindStep(segmentIndex, t);
+	if (step >= last)
+		return 0.0;
+
+	step = std::max(step, first);
+
+	//neighbours too: steps of the reference run are shortened at output times
+	double h = _stepSizes[step];
+	if (step > first)
+		h = std::max(h, _stepSizes[step - 1]);
+	if (step + 1 < last)
+		h = std::max(h, _stepSizes[step + 1]);
+
+	return h;
+}
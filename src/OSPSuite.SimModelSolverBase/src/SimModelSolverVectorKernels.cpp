@@ -0,0 +1,579 @@
+#include "SimModelSolverBase/SimModelSolverVectorKernels.h"
+#include <cmath>
+#include <atomic>
+
+//vectorized kernels only on x86 (can be switched off by SIMMODELSOLVER_NO_SIMD)
+#if !defined(SIMMODELSOLVER_NO_SIMD) && (defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__))
+#define SIMMODELSOLVER_X86_KERNELS
+#endif
+
+#ifdef SIMMODELSOLVER_X86_KERNELS
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+//MSVC generates AVX code for intrinsics without /arch switch
+#define TARGET_AVX2
+#define TARGET_AVX512
+#else
+#include <cpuid.h>
+//GCC/clang: only the kernel functions are compiled for the extended instruction sets
+#define TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define TARGET_AVX512 __attribute__((target("avx512f,avx2,fma")))
+#endif
+#endif
+
+//kernels of one instruction set (norms return the weighted sum of squares)
+struct VectorKernelTable
+{
+	void (*Scale) (size_t n, double c, const double * x, double * z);
+	void (*Axpy) (size_t n, double a, const double * x, double * y);
+	void (*LinearSum) (size_t n, double a, const double * x, double b, const double * y, double * z);
+	void (*LinearCombination) (size_t n, int numberOfVectors, const double * c, const double * const * X, double * z);
+	void (*ScaleAddMulti) (size_t n, int numberOfVectors, const double * a, const double * x, const double * const * Y, double * const * Z);
+	double (*WeightedSquareSum) (size_t n, const double * x, const double * y, double relTol, const double * absTol);
+	double (*WeightedSquareSumMax) (size_t n, const double * x, const double * yOld, const double * yNew, double relTol, const double * absTol);
+};
+
+//-------------------------------------------------------------------------
+//scalar kernels (also used for the remainder of the vectorized kernels)
+//-------------------------------------------------------------------------
+
+static void ScalarScale (size_t n, double c, const double * x, double * z)
+{
+	for (size_t i = 0; i < n; i++)
+		z[i] = c * x[i];
+}
+
+static void ScalarAxpy (size_t n, double a, const double * x, double * y)
+{
+	for (size_t i = 0; i < n; i++)
+		y[i] += a * x[i];
+}
+
+static void ScalarLinearSum (size_t n, double a, const double * x, double b, const double * y, double * z)
+{
+	for (size_t i = 0; i < n; i++)
+		z[i] = a * x[i] + b * y[i];
+}
+
+static void ScalarLinearCombination (size_t n, int numberOfVectors, const double * c, const double * const * X, double * z)
+{
+	for (size_t i = 0; i < n; i++)
+	{
+		double sum = c[0] * X[0][i];
+		for (int k = 1; k < numberOfVectors; k++)
+			sum += c[k] * X[k][i];
+
+		z[i] = sum;
+	}
+}
+
+static void ScalarScaleAddMulti (size_t n, int numberOfVectors, const double * a, const double * x, const double * const * Y, double * const * Z)
+{
+	for (size_t i = 0; i < n; i++)
+	{
+		double xi = x[i];
+		for (int k = 0; k < numberOfVectors; k++)
+			Z[k][i] = a[k] * xi + Y[k][i];
+	}
+}
+
+static double ScalarWeightedSquareSum (size_t n, const double * x, const double * y, double relTol, const double * absTol)
+{
+	double sum = 0.0;
+
+	for (size_t i = 0; i < n; i++)
+	{
+		double weightedValue = x[i] / (absTol[i] + relTol * fabs(y[i]));
+		sum += weightedValue * weightedValue;
+	}
+
+	return sum;
+}
+
+static double ScalarWeightedSquareSumMax (size_t n, const double * x, const double * yOld, const double * yNew, double relTol, const double * absTol)
+{
+	double sum = 0.0;
+
+	for (size_t i = 0; i < n; i++)
+	{
+		double yMax = fabs(yOld[i]) > fabs(yNew[i]) ? fabs(yOld[i]) : fabs(yNew[i]);
+		double weightedValue = x[i] / (absTol[i] + relTol * yMax);
+		sum += weightedValue * weightedValue;
+	}
+
+	return sum;
+}
+
+static const VectorKernelTable SCALAR_KERNELS =
+{
+	ScalarScale, ScalarAxpy, ScalarLinearSum, ScalarLinearCombination, ScalarScaleAddMulti,
+	ScalarWeightedSquareSum, ScalarWeightedSquareSumMax
+};
+
+#ifdef SIMMODELSOLVER_X86_KERNELS
+
+//-------------------------------------------------------------------------
+//AVX2 kernels (4 doubles per register, FMA)
+//-------------------------------------------------------------------------
+
+TARGET_AVX2 static inline double Avx2HorizontalSum (__m256d v)
+{
+	__m128d sum = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+	sum = _mm_add_sd(sum, _mm_unpackhi_pd(sum, sum));
+
+	return _mm_cvtsd_f64(sum);
+}
+
+TARGET_AVX2 static void Avx2Scale (size_t n, double c, const double * x, double * z)
+{
+	__m256d cv = _mm256_set1_pd(c);
+	size_t i = 0;
+
+	for (; i + 4 <= n; i += 4)
+		_mm256_storeu_pd(z + i, _mm256_mul_pd(cv, _mm256_loadu_pd(x + i)));
+
+	ScalarScale(n - i, c, x + i, z + i);
+}
+
+TARGET_AVX2 static void Avx2Axpy (size_t n, double a, const double * x, double * y)
+{
+	__m256d av = _mm256_set1_pd(a);
+	size_t i = 0;
+
+	for (; i + 4 <= n; i += 4)
+		_mm256_storeu_pd(y + i, _mm256_fmadd_pd(av, _mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i)));
+
+	ScalarAxpy(n - i, a, x + i, y + i);
+}
+
+TARGET_AVX2 static void Avx2LinearSum (size_t n, double a, const double * x, double b, const double * y, double * z)
+{
+	__m256d av = _mm256_set1_pd(a), bv = _mm256_set1_pd(b);
+	size_t i = 0;
+
+	for (; i + 4 <= n; i += 4)
+		_mm256_storeu_pd(z + i, _mm256_fmadd_pd(av, _mm256_loadu_pd(x + i), _mm256_mul_pd(bv, _mm256_loadu_pd(y + i))));
+
+	ScalarLinearSum(n - i, a, x + i, b, y + i, z + i);
+}
+
+TARGET_AVX2 static void Avx2LinearCombination (size_t n, int numberOfVectors, const double * c, const double * const * X, double * z)
+{
+	size_t i = 0;
+
+	for (; i + 4 <= n; i += 4)
+	{
+		__m256d sum = _mm256_mul_pd(_mm256_set1_pd(c[0]), _mm256_loadu_pd(X[0] + i));
+		for (int k = 1; k < numberOfVectors; k++)
+			sum = _mm256_fmadd_pd(_mm256_set1_pd(c[k]), _mm256_loadu_pd(X[k] + i), sum);
+
+		_mm256_storeu_pd(z + i, sum);
+	}
+
+	for (; i < n; i++)
+	{
+		double sum = c[0] * X[0][i];
+		for (int k = 1; k < numberOfVectors; k++)
+			sum += c[k] * X[k][i];
+
+		z[i] = sum;
+	}
+}
+
+TARGET_AVX2 static void Avx2ScaleAddMulti (size_t n, int numberOfVectors, const double * a, const double * x, const double * const * Y, double * const * Z)
+{
+	size_t i = 0;
+
+	for (; i + 4 <= n; i += 4)
+	{
+		__m256d xv = _mm256_loadu_pd(x + i);
+		for (int k = 0; k < numberOfVectors; k++)
+			_mm256_storeu_pd(Z[k] + i, _mm256_fmadd_pd(_mm256_set1_pd(a[k]), xv, _mm256_loadu_pd(Y[k] + i)));
+	}
+
+	for (; i < n; i++)
+	{
+		double xi = x[i];
+		for (int k = 0; k < numberOfVectors; k++)
+			Z[k][i] = a[k] * xi + Y[k][i];
+	}
+}
+
+TARGET_AVX2 static double Avx2WeightedSquareSum (size_t n, const double * x, const double * y, double relTol, const double * absTol)
+{
+	__m256d relTolV = _mm256_set1_pd(relTol), signMask = _mm256_set1_pd(-0.0);
+	__m256d sum = _mm256_setzero_pd();
+	size_t i = 0;
+
+	for (; i + 4 <= n; i += 4)
+	{
+		__m256d weight = _mm256_fmadd_pd(relTolV, _mm256_andnot_pd(signMask, _mm256_loadu_pd(y + i)), _mm256_loadu_pd(absTol + i));
+		__m256d weightedValue = _mm256_div_pd(_mm256_loadu_pd(x + i), weight);
+		sum = _mm256_fmadd_pd(weightedValue, weightedValue, sum);
+	}
+
+	return Avx2HorizontalSum(sum) + ScalarWeightedSquareSum(n - i, x + i, y + i, relTol, absTol + i);
+}
+
+TARGET_AVX2 static double Avx2WeightedSquareSumMax (size_t n, const double * x, const double * yOld, const double * yNew, double relTol, const double * absTol)
+{
+	__m256d relTolV = _mm256_set1_pd(relTol), signMask = _mm256_set1_pd(-0.0);
+	__m256d sum = _mm256_setzero_pd();
+	size_t i = 0;
+
+	for (; i + 4 <= n; i += 4)
+	{
+		__m256d yMax = _mm256_max_pd(_mm256_andnot_pd(signMask, _mm256_loadu_pd(yOld + i)), _mm256_andnot_pd(signMask, _mm256_loadu_pd(yNew + i)));
+		__m256d weightedValue = _mm256_div_pd(_mm256_loadu_pd(x + i), _mm256_fmadd_pd(relTolV, yMax, _mm256_loadu_pd(absTol + i)));
+		sum = _mm256_fmadd_pd(weightedValue, weightedValue, sum);
+	}
+
+	return Avx2HorizontalSum(sum) + ScalarWeightedSquareSumMax(n - i, x + i, yOld + i, yNew + i, relTol, absTol + i);
+}
+
+static const VectorKernelTable AVX2_KERNELS =
+{
+	Avx2Scale, Avx2Axpy, Avx2LinearSum, Avx2LinearCombination, Avx2ScaleAddMulti,
+	Avx2WeightedSquareSum, Avx2WeightedSquareSumMax
+};
+
+//-------------------------------------------------------------------------
+//AVX-512 kernels (8 doubles per register; AVX512F only)
+//-------------------------------------------------------------------------
+
+TARGET_AVX512 static inline double Avx512HorizontalSum (__m512d v)
+{
+	double values[8];
+	_mm512_storeu_pd(values, v);
+
+	return ((values[0] + values[4]) + (values[2] + values[6])) + ((values[1] + values[5]) + (values[3] + values[7]));
+}
+
+//|v| (AVX512F has no and/andnot for doubles: clear the sign bits as integers)
+TARGET_AVX512 static inline __m512d Avx512Abs (__m512d v)
+{
+	return _mm512_castsi512_pd(_mm512_and_epi64(_mm512_castpd_si512(v), _mm512_set1_epi64(0x7FFFFFFFFFFFFFFFLL)));
+}
+
+TARGET_AVX512 static void Avx512Scale (size_t n, double c, const double * x, double * z)
+{
+	__m512d cv = _mm512_set1_pd(c);
+	size_t i = 0;
+
+	for (; i + 8 <= n; i += 8)
+		_mm512_storeu_pd(z + i, _mm512_mul_pd(cv, _mm512_loadu_pd(x + i)));
+
+	ScalarScale(n - i, c, x + i, z + i);
+}
+
+TARGET_AVX512 static void Avx512Axpy (size_t n, double a, const double * x, double * y)
+{
+	__m512d av = _mm512_set1_pd(a);
+	size_t i = 0;
+
+	for (; i + 8 <= n; i += 8)
+		_mm512_storeu_pd(y + i, _mm512_fmadd_pd(av, _mm512_loadu_pd(x + i), _mm512_loadu_pd(y + i)));
+
+	ScalarAxpy(n - i, a, x + i, y + i);
+}
+
+TARGET_AVX512 static void Avx512LinearSum (size_t n, double a, const double * x, double b, const double * y, double * z)
+{
+	__m512d av = _mm512_set1_pd(a), bv = _mm512_set1_pd(b);
+	size_t i = 0;
+
+	for (; i + 8 <= n; i += 8)
+		_mm512_storeu_pd(z + i, _mm512_fmadd_pd(av, _mm512_loadu_pd(x + i), _mm512_mul_pd(bv, _mm512_loadu_pd(y + i))));
+
+	ScalarLinearSum(n - i, a, x + i, b, y + i, z + i);
+}
+
+TARGET_AVX512 static void Avx512LinearCombination (size_t n, int numberOfVectors, const double * c, const double * const * X, double * z)
+{
+	size_t i = 0;
+
+	for (; i + 8 <= n; i += 8)
+	{
+		__m512d sum = _mm512_mul_pd(_mm512_set1_pd(c[0]), _mm512_loadu_pd(X[0] + i));
+		for (int k = 1; k < numberOfVectors; k++)
+			sum = _mm512_fmadd_pd(_mm512_set1_pd(c[k]), _mm512_loadu_pd(X[k] + i), sum);
+
+		_mm512_storeu_pd(z + i, sum);
+	}
+
+	for (; i < n; i++)
+	{
+		double sum = c[0] * X[0][i];
+		for (int k = 1; k < numberOfVectors; k++)
+			sum += c[k] * X[k][i];
+
+		z[i] = sum;
+	}
+}
+
+TARGET_AVX512 static void Avx512ScaleAddMulti (size_t n, int numberOfVectors, const double * a, const double * x, const double * const * Y, double * const * Z)
+{
+	size_t i = 0;
+
+	for (; i + 8 <= n; i += 8)
+	{
+		__m512d xv = _mm512_loadu_pd(x + i);
+		for (int k = 0; k < numberOfVectors; k++)
+			_mm512_storeu_pd(Z[k] + i, _mm512_fmadd_pd(_mm512_set1_pd(a[k]), xv, _mm512_loadu_pd(Y[k] + i)));
+	}
+
+	for (; i < n; i++)
+	{
+		double xi = x[i];
+		for (int k = 0; k < numberOfVectors; k++)
+			Z[k][i] = a[k] * xi + Y[k][i];
+	}
+}
+
+TARGET_AVX512 static double Avx512WeightedSquareSum (size_t n, const double * x, const double * y, double relTol, const double * absTol)
+{
+	__m512d relTolV = _mm512_set1_pd(relTol);
+	__m512d sum = _mm512_setzero_pd();
+	size_t i = 0;
+
+	for (; i + 8 <= n; i += 8)
+	{
+		__m512d weight = _mm512_fmadd_pd(relTolV, Avx512Abs(_mm512_loadu_pd(y + i)), _mm512_loadu_pd(absTol + i));
+		__m512d weightedValue = _mm512_div_pd(_mm512_loadu_pd(x + i), weight);
+		sum = _mm512_fmadd_pd(weightedValue, weightedValue, sum);
+	}
+
+	return Avx512HorizontalSum(sum) + ScalarWeightedSquareSum(n - i, x + i, y + i, relTol, absTol + i);
+}
+
+TARGET_AVX512 static double Avx512WeightedSquareSumMax (size_t n, const double * x, const double * yOld, const double * yNew, double relTol, const double * absTol)
+{
+	__m512d relTolV = _mm512_set1_pd(relTol);
+	__m512d sum = _mm512_setzero_pd();
+	size_t i = 0;
+
+	for (; i + 8 <= n; i += 8)
+	{
+		__m512d yOldAbs = Avx512Abs(_mm512_loadu_pd(yOld + i)), yNewAbs = Avx512Abs(_mm512_loadu_pd(yNew + i));
+		__m512d yMax = _mm512_mask_blend_pd(_mm512_cmp_pd_mask(yOldAbs, yNewAbs, _CMP_LT_OQ), yOldAbs, yNewAbs);
+		__m512d weightedValue = _mm512_div_pd(_mm512_loadu_pd(x + i), _mm512_fmadd_pd(relTolV, yMax, _mm512_loadu_pd(absTol + i)));
+		sum = _mm512_fmadd_pd(weightedValue, weightedValue, sum);
+	}
+
+	return Avx512HorizontalSum(sum) + ScalarWeightedSquareSumMax(n - i, x + i, yOld + i, yNew + i, relTol, absTol + i);
+}
+
+static const VectorKernelTable AVX512_KERNELS =
+{
+	Avx512Scale, Avx512Axpy, Avx512LinearSum, Avx512LinearCombination, Avx512ScaleAddMulti,
+	Avx512WeightedSquareSum, Avx512WeightedSquareSumMax
+};
+
+//-------------------------------------------------------------------------
+//CPU detection
+//-------------------------------------------------------------------------
+
+static void CpuId (unsigned int leaf, unsigned int subLeaf, unsigned int registers[4])
+{
+#ifdef _MSC_VER
+	int values[4];
+	__cpuidex(values, (int)leaf, (int)subLeaf);
+	for (int i = 0; i < 4; i++)
+		registers[i] = (unsigned int)values[i];
+#else
+	__cpuid_count(leaf, subLeaf, registers[0], registers[1], registers[2], registers[3]);
+#endif
+}
+
+//register state enabled by the operating system (XCR0)
+static unsigned long long EnabledRegisterState ()
+{
+#ifdef _MSC_VER
+	return _xgetbv(0);
+#else
+	unsigned int eax, edx;
+	__asm__ __volatile__ ("xgetbv" : "=a" (eax), "=d" (edx) : "c" (0));
+	return ((unsigned long long)edx << 32) | eax;
+#endif
+}
+
+static SimModelSolverVectorKernels::InstructionSet DetectInstructionSet ()
+{
+	unsigned int registers[4];
+
+	CpuId(0, 0, registers);
+	if (registers[0] < 7)
+		return SimModelSolverVectorKernels::INSTRUCTION_SET_SCALAR;
+
+	//ECX: FMA (12), OSXSAVE (27), AVX (28)
+	CpuId(1, 0, registers);
+	const unsigned int fmaOsxsaveAvx = (1u << 12) | (1u << 27) | (1u << 28);
+	if ((registers[2] & fmaOsxsaveAvx) != fmaOsxsaveAvx)
+		return SimModelSolverVectorKernels::INSTRUCTION_SET_SCALAR;
+
+	//XMM and YMM registers saved by the operating system
+	unsigned long long registerState = EnabledRegisterState();
+	if ((registerState & 0x6) != 0x6)
+		return SimModelSolverVectorKernels::INSTRUCTION_SET_SCALAR;
+
+	//EBX: AVX2 (5), AVX512F (16)
+	CpuId(7, 0, registers);
+	if ((registers[1] & (1u << 5)) == 0)
+		return SimModelSolverVectorKernels::INSTRUCTION_SET_SCALAR;
+
+	//opmask and ZMM registers saved by the operating system
+	if (((registers[1] & (1u << 16)) != 0) && ((registerState & 0xE6) == 0xE6))
+		return SimModelSolverVectorKernels::INSTRUCTION_SET_AVX512;
+
+	return SimModelSolverVectorKernels::INSTRUCTION_SET_AVX2;
+}
+
+#else
+
+static SimModelSolverVectorKernels::InstructionSet DetectInstructionSet ()
+{
+	return SimModelSolverVectorKernels::INSTRUCTION_SET_SCALAR;
+}
+
+#endif //SIMMODELSOLVER_X86_KERNELS
+
+//-------------------------------------------------------------------------
+//dispatch
+//-------------------------------------------------------------------------
+
+//instruction set in use (-1 = not selected yet)
+static std::atomic < int > activeInstructionSet(-1);
+
+static const VectorKernelTable & Kernels ()
+{
+	int instructionSet = activeInstructionSet.load(std::memory_order_relaxed);
+
+	if (instructionSet < 0)
+	{
+		instructionSet = SimModelSolverVectorKernels::GetSupportedInstructionSet();
+		activeInstructionSet.store(instructionSet, std::memory_order_relaxed);
+	}
+
+#ifdef SIMMODELSOLVER_X86_KERNELS
+	if (instructionSet == SimModelSolverVectorKernels::INSTRUCTION_SET_AVX512)
+		return AVX512_KERNELS;
+	if (instructionSet == SimModelSolverVectorKernels::INSTRUCTION_SET_AVX2)
+		return AVX2_KERNELS;
+#endif
+
+	return SCALAR_KERNELS;
+}
+
+SimModelSolverVectorKernels::InstructionSet SimModelSolverVectorKernels::GetSupportedInstructionSet ()
+{
+	static const InstructionSet supportedInstructionSet = DetectInstructionSet();
+
+	return supportedInstructionSet;
+}
+
+SimModelSolverVectorKernels::InstructionSet SimModelSolverVectorKernels::GetInstructionSet ()
+{
+	Kernels();
+
+	return (InstructionSet)activeInstructionSet.load(std::memory_order_relaxed);
+}
+
+void SimModelSolverVectorKernels::SetInstructionSet (InstructionSet instructionSet)
+{
+	const char * ERROR_SOURCE = "SimModelSolverVectorKernels::SetInstructionSet";
+
+	if ((instructionSet < INSTRUCTION_SET_SCALAR) || (instructionSet > GetSupportedInstructionSet()))
+		throw SimModelSolverErrorData(SimModelSolverErrorData::err_FAILURE, ERROR_SOURCE,
+		                              std::string("Instruction set not supported: ") + GetInstructionSetName(instructionSet));
+
+	activeInstructionSet.store(instructionSet, std::memory_order_relaxed);
+}
+
+const char * SimModelSolverVectorKernels::GetInstructionSetName (InstructionSet instructionSet)
+{
+	switch (instructionSet)
+	{
+		case INSTRUCTION_SET_SCALAR:
+			return "Scalar";
+		case INSTRUCTION_SET_AVX2:
+			return "AVX2";
+		case INSTRUCTION_SET_AVX512:
+			return "AVX-512";
+		default:
+			return "Unknown";
+	}
+}
+
+void SimModelSolverVectorKernels::Scale (size_t n, double c, const double * x, double * z)
+{
+	Kernels().Scale(n, c, x, z);
+}
+
+void SimModelSolverVectorKernels::Axpy (size_t n, double a, const double * x, double * y)
+{
+	Kernels().Axpy(n, a, x, y);
+}
+
+void SimModelSolverVectorKernels::LinearSum (size_t n, double a, const double * x, double b, const double * y, double * z)
+{
+	Kernels().LinearSum(n, a, x, b, y, z);
+}
+
+void SimModelSolverVectorKernels::LinearCombination (size_t n, int numberOfVectors, const double * c,
+	                                                 const double * const * X, double * z)
+{
+	if (numberOfVectors <= 0)
+	{
+		for (size_t i = 0; i < n; i++)
+			z[i] = 0.0;
+		return;
+	}
+
+	Kernels().LinearCombination(n, numberOfVectors, c, X, z);
+}
+
+void SimModelSolverVectorKernels::ScaleAddMulti (size_t n, int numberOfVectors, const double * a, const double * x,
+	                                             const double * const * Y, double * const * Z)
+{
+	if (numberOfVectors <= 0)
+		return;
+
+	Kernels().ScaleAddMulti(n, numberOfVectors, a, x, Y, Z);
+}
+
+double SimModelSolverVectorKernels::WeightedRmsNorm (size_t n, const double * x, const double * y,
+	                                                 double relTol, const double * absTol)
+{
+	if (n == 0)
+		return 0.0;
+
+	return sqrt(Kernels().WeightedSquareSum(n, x, y, relTol, absTol) / n);
+}
+
+double SimModelSolverVectorKernels::WeightedRmsNorm (size_t n, const double * x, const double * yOld, const double * yNew,
+	                                                 double relTol, const double * absTol)
+{
+	if (n == 0)
+		return 0.0;
+
+	return sqrt(Kernels().WeightedSquareSumMax(n, x, yOld, yNew, relTol, absTol) / n);
+}
+
+double SimModelSolverVectorKernels::WeightedRmsNormBlock (size_t n, int numberOfColumns, const double * X, const double * Y,
+	                                                      size_t columnStride, double relTol, const double * absTol)
+{
+	const VectorKernelTable & kernels = Kernels();
+	double maxNorm = 0.0;
+
+	for (int j = 0; (n > 0) && (j < numberOfColumns); j++)
+	{
+		double norm = sqrt(kernels.WeightedSquareSum(n, X + j * columnStride, Y + j * columnStride, relTol, absTol) / n);
+
+		//NaN is passed on
+		if (!(norm <= maxNorm))
+			maxNorm = norm;
+	}
+
+	return maxNorm;
+}
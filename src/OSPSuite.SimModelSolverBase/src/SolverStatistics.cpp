@@ -0,0 +1,60 @@
+#include "SimModelSolverBase/SolverStatistics.h"
+
+SolverStatistics::SolverStatistics ()
+{
+	Clear();
+}
+
+void SolverStatistics::Clear ()
+{
+	NumberOfSteps = 0;
+	NumberOfErrorTestFailures = 0;
+	NumberOfNonlinearIterations = 0;
+	NumberOfNonlinearConvergenceFailures = 0;
+	NumberOfLinearSolverSetups = 0;
+
+	NumberOfRhsEvaluations = 0;
+	NumberOfJacobianEvaluations = 0;
+	NumberOfSensitivityRhsEvaluations = 0;
+	NumberOfRootFunctionEvaluations = 0;
+
+	NumberOfAdjointRhsEvaluations = 0;
+	NumberOfAdjointQuadratureEvaluations = 0;
+
+	RhsTime = 0.0;
+	JacobianTime = 0.0;
+	SensitivityRhsTime = 0.0;
+	AdjointTime = 0.0;
+
+	LastStepSize = 0.0;
+	LastOrder = 0;
+}
+
+SolverStatistics SolverStatistics::Difference (const SolverStatistics & other) const
+{
+	SolverStatistics diff;
+
+	diff.NumberOfSteps = NumberOfSteps - other.NumberOfSteps;
+	diff.NumberOfErrorTestFailures = NumberOfErrorTestFailures - other.NumberOfErrorTestFailures;
+	diff.NumberOfNonlinearIterations = NumberOfNonlinearIterations - other.NumberOfNonlinearIterations;
+	diff.NumberOfNonlinearConvergenceFailures = NumberOfNonlinearConvergenceFailures - other.NumberOfNonlinearConvergenceFailures;
+	diff.NumberOfLinearSolverSetups = NumberOfLinearSolverSetups - other.NumberOfLinearSolverSetups;
+
+	diff.NumberOfRhsEvaluations = NumberOfRhsEvaluations - other.NumberOfRhsEvaluations;
+	diff.NumberOfJacobianEvaluations = NumberOfJacobianEvaluations - other.NumberOfJacobianEvaluations;
+	diff.NumberOfSensitivityRhsEvaluations = NumberOfSensitivityRhsEvaluations - other.NumberOfSensitivityRhsEvaluations;
+	diff.NumberOfRootFunctionEvaluations = NumberOfRootFunctionEvaluations - other.NumberOfRootFunctionEvaluations;
+
+	diff.NumberOfAdjointRhsEvaluations = NumberOfAdjointRhsEvaluations - other.NumberOfAdjointRhsEvaluations;
+	diff.NumberOfAdjointQuadratureEvaluations = NumberOfAdjointQuadratureEvaluations - other.NumberOfAdjointQuadratureEvaluations;
+
+	diff.RhsTime = RhsTime - other.RhsTime;
+	diff.JacobianTime = JacobianTime - other.JacobianTime;
+	diff.SensitivityRhsTime = SensitivityRhsTime - other.SensitivityRhsTime;
+	diff.AdjointTime = AdjointTime - other.AdjointTime;
+
+	diff.LastStepSize = LastStepSize;
+	diff.LastOrder = LastOrder;
+
+	return diff;
+}